@@ -0,0 +1,11 @@
+import esphome.codegen as cg
+from esphome.components import i2c
+
+CONF_BMI270_ID = "bmi270_id"
+
+bmi270_ns = cg.esphome_ns.namespace("bmi270")
+# Transport-independent driver; the I2C and SPI variants supply the bus hooks
+BMI270Component = bmi270_ns.class_("BMI270Component", cg.PollingComponent)
+BMI270I2CComponent = bmi270_ns.class_(
+    "BMI270I2CComponent", BMI270Component, i2c.I2CDevice
+)
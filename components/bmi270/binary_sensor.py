@@ -0,0 +1,94 @@
+import esphome.codegen as cg
+from esphome.components import binary_sensor
+import esphome.config_validation as cv
+from esphome.const import (
+    CONF_DURATION,
+    CONF_THRESHOLD,
+    DEVICE_CLASS_MOTION,
+)
+
+from . import BMI270Component, CONF_BMI270_ID
+
+CONF_ANY_MOTION = "any_motion"
+CONF_NO_MOTION = "no_motion"
+CONF_PAUSE_WHEN_STILL = "pause_when_still"
+CONF_STEP_DETECTOR = "step_detector"
+
+# Feature engine units: threshold 1 g / 2048 per LSB (11 bits), duration
+# 20 ms per LSB (13 bits)
+MOTION_THRESHOLD_LSB_PER_G = 2048
+MOTION_DURATION_MS_PER_LSB = 20
+# Defaults match the Bosch reference configuration
+ANY_MOTION_DEFAULTS = {CONF_THRESHOLD: 0.083, CONF_DURATION: cv.TimePeriod(milliseconds=100)}
+NO_MOTION_DEFAULTS = {CONF_THRESHOLD: 0.07, CONF_DURATION: cv.TimePeriod(milliseconds=100)}
+
+
+def motion_schema(defaults):
+    return binary_sensor.binary_sensor_schema(device_class=DEVICE_CLASS_MOTION).extend(
+        {
+            cv.Optional(CONF_THRESHOLD, default=defaults[CONF_THRESHOLD]): cv.float_range(
+                min=0.0, max=0x7FF / MOTION_THRESHOLD_LSB_PER_G
+            ),
+            cv.Optional(CONF_DURATION, default=defaults[CONF_DURATION]): cv.All(
+                cv.positive_time_period_milliseconds,
+                cv.Range(
+                    min=cv.TimePeriod(milliseconds=MOTION_DURATION_MS_PER_LSB),
+                    max=cv.TimePeriod(milliseconds=0x1FFF * MOTION_DURATION_MS_PER_LSB),
+                ),
+            ),
+        }
+    )
+
+
+def validate_pause_when_still(config):
+    if config[CONF_PAUSE_WHEN_STILL] and not (
+        CONF_ANY_MOTION in config or CONF_NO_MOTION in config
+    ):
+        raise cv.Invalid("pause_when_still requires any_motion or no_motion")
+    return config
+
+
+CONFIG_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.GenerateID(CONF_BMI270_ID): cv.use_id(BMI270Component),
+            cv.Optional(CONF_ANY_MOTION): motion_schema(ANY_MOTION_DEFAULTS),
+            cv.Optional(CONF_NO_MOTION): motion_schema(NO_MOTION_DEFAULTS),
+            cv.Optional(CONF_PAUSE_WHEN_STILL, default=False): cv.boolean,
+            cv.Optional(CONF_STEP_DETECTOR): binary_sensor.binary_sensor_schema(
+                icon="mdi:shoe-print"
+            ),
+        }
+    ),
+    cv.has_at_least_one_key(CONF_ANY_MOTION, CONF_NO_MOTION, CONF_STEP_DETECTOR),
+    validate_pause_when_still,
+)
+
+
+def motion_args(config):
+    threshold = round(config[CONF_THRESHOLD] * MOTION_THRESHOLD_LSB_PER_G)
+    duration = config[CONF_DURATION].total_milliseconds // MOTION_DURATION_MS_PER_LSB
+    return threshold, duration
+
+
+async def to_code(config):
+    hub = await cg.get_variable(config[CONF_BMI270_ID])
+
+    if CONF_ANY_MOTION in config or CONF_NO_MOTION in config:
+        # Both detectors always run: any-motion sets the moving state,
+        # no-motion clears it
+        any_config = config.get(CONF_ANY_MOTION, ANY_MOTION_DEFAULTS)
+        no_config = config.get(CONF_NO_MOTION, NO_MOTION_DEFAULTS)
+        cg.add(hub.set_any_motion_config(*motion_args(any_config)))
+        cg.add(hub.set_no_motion_config(*motion_args(no_config)))
+        cg.add(hub.set_pause_when_still(config[CONF_PAUSE_WHEN_STILL]))
+
+    if CONF_ANY_MOTION in config:
+        sens = await binary_sensor.new_binary_sensor(config[CONF_ANY_MOTION])
+        cg.add(hub.set_any_motion_binary_sensor(sens))
+    if CONF_NO_MOTION in config:
+        sens = await binary_sensor.new_binary_sensor(config[CONF_NO_MOTION])
+        cg.add(hub.set_no_motion_binary_sensor(sens))
+    if CONF_STEP_DETECTOR in config:
+        sens = await binary_sensor.new_binary_sensor(config[CONF_STEP_DETECTOR])
+        cg.add(hub.set_step_detector_binary_sensor(sens))
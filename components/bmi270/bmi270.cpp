@@ -1,382 +1,1804 @@
-#include "bmi270.h"
-#include "bmi270_config.h"
-#include "esphome/core/log.h"
-
-namespace esphome {
-namespace bmi270 {
-
-static const char *const TAG = "bmi270";
-
-// BMI270 Register addresses
-#define BMI2_CHIP_ID_ADDR 0x00
-#define BMI2_PWR_CONF_ADDR 0x7C
-#define BMI2_PWR_CTRL_ADDR 0x7D
-#define BMI2_INIT_CTRL_ADDR 0x59
-#define BMI2_INIT_ADDR_0 0x5B
-#define BMI2_INIT_ADDR_1 0x5C
-#define BMI2_INIT_DATA_ADDR 0x5E
-#define BMI2_ACC_CONF_ADDR 0x40
-#define BMI2_ACC_RANGE_ADDR 0x41
-#define BMI2_GYR_CONF_ADDR 0x42
-#define BMI2_GYR_RANGE_ADDR 0x43
-#define BMI2_ACC_DATA_ADDR 0x0C
-#define BMI2_GYR_DATA_ADDR 0x12
-#define BMI2_INTERNAL_STATUS_ADDR 0x21
-#define BMI2_STATUS_ADDR 0x03
-#define BMI2_NV_CONF_ADDR 0x70
-#define BMI2_GYR_OFF_COMP_3_ADDR 0x74
-#define BMI2_GYR_OFF_COMP_6_ADDR 0x77
-#define BMI2_OFFSET_ADDR 0x77
-
-#define BMI2_CHIP_ID 0x24
-#define BMI2_INIT_DATA_SIZE sizeof(bmi270_config_file)
-
-// BMI270 API function implementations
-int8_t bmi270_init(bmi2_dev *dev) {
-  uint8_t chip_id;
-  int8_t rslt = dev->read(BMI2_CHIP_ID_ADDR, &chip_id, 1, dev->intf_ptr);
-  if (rslt != BMI2_OK) return rslt;
-
-  if (chip_id != BMI2_CHIP_ID) return BMI2_E_COM_FAIL;
-
-  dev->chip_id = chip_id;
-
-  // Disable advanced power save mode (required for config upload)
-  uint8_t pwr_conf = 0x00;
-  rslt = dev->write(BMI2_PWR_CONF_ADDR, &pwr_conf, 1, dev->intf_ptr);
-  if (rslt != BMI2_OK) return rslt;
-  dev->delay_us(450, dev->intf_ptr);
-
-  // Disable config loading (INIT_CTRL = 0)
-  uint8_t init_ctrl = 0x00;
-  rslt = dev->write(BMI2_INIT_CTRL_ADDR, &init_ctrl, 1, dev->intf_ptr);
-  if (rslt != BMI2_OK) return rslt;
-
-  // Upload config file in chunks with proper addressing
-  // The BMI270 requires setting the word address before each chunk
-  const uint16_t chunk_size = 32;  // Bytes per chunk (must be even)
-  for (uint16_t index = 0; index < BMI2_INIT_DATA_SIZE; index += chunk_size) {
-    // Calculate word address (index / 2)
-    uint16_t word_addr = index / 2;
-    uint8_t addr_array[2];
-    addr_array[0] = (uint8_t)(word_addr & 0x0F);         // Lower 4 bits
-    addr_array[1] = (uint8_t)((word_addr >> 4) & 0xFF);  // Upper 8 bits
-    
-    // Write the address to INIT_ADDR registers
-    rslt = dev->write(BMI2_INIT_ADDR_0, addr_array, 2, dev->intf_ptr);
-    if (rslt != BMI2_OK) return rslt;
-    
-    // Calculate actual chunk length
-    uint16_t len = (BMI2_INIT_DATA_SIZE - index) > chunk_size ? chunk_size : (BMI2_INIT_DATA_SIZE - index);
-    
-    // Write config data chunk
-    rslt = dev->write(BMI2_INIT_DATA_ADDR, &bmi270_config_file[index], len, dev->intf_ptr);
-    if (rslt != BMI2_OK) return rslt;
-  }
-
-  // Enable config loading (INIT_CTRL = 1)
-  init_ctrl = 0x01;
-  rslt = dev->write(BMI2_INIT_CTRL_ADDR, &init_ctrl, 1, dev->intf_ptr);
-  if (rslt != BMI2_OK) return rslt;
-  
-  // Wait for initialization to complete (150ms as per datasheet)
-  dev->delay_us(150000, dev->intf_ptr);
-
-  // Check internal status to verify config load was successful
-  uint8_t internal_status = 0;
-  rslt = dev->read(BMI2_INTERNAL_STATUS_ADDR, &internal_status, 1, dev->intf_ptr);
-  if (rslt != BMI2_OK) return rslt;
-  
-  // Bit 0 should be 1 (INIT_OK) for successful initialization
-  if ((internal_status & 0x01) != 0x01) {
-    return BMI2_E_CONFIG_LOAD;
-  }
-
-  return BMI2_OK;
-}
-
-int8_t bmi270_sensor_enable(const uint8_t *sens_list, uint8_t n_sens, bmi2_dev *dev) {
-  // Enable accelerometer (0x04), gyroscope (0x02), and temperature (0x08)
-  uint8_t pwr_ctrl = 0x0E; // TEMP (0x08) + ACC (0x04) + GYR (0x02) = 0x0E
-  return dev->write(BMI2_PWR_CTRL_ADDR, &pwr_ctrl, 1, dev->intf_ptr);
-}
-
-int8_t bmi270_set_sensor_config(bmi2_sens_config *sens_cfg, uint8_t n_sens, bmi2_dev *dev) {
-  if (sens_cfg->type == BMI2_ACCEL) {
-    uint8_t acc_conf = sens_cfg->cfg.acc.odr | (sens_cfg->cfg.acc.bw << 4);
-    uint8_t acc_range = sens_cfg->cfg.acc.range;
-    int8_t rslt = dev->write(BMI2_ACC_CONF_ADDR, &acc_conf, 1, dev->intf_ptr);
-    if (rslt != BMI2_OK) return rslt;
-    return dev->write(BMI2_ACC_RANGE_ADDR, &acc_range, 1, dev->intf_ptr);
-  } else if (sens_cfg->type == BMI2_GYRO) {
-    uint8_t gyr_conf = sens_cfg->cfg.gyr.odr | (sens_cfg->cfg.gyr.bw << 4);
-    uint8_t gyr_range = sens_cfg->cfg.gyr.range;
-    int8_t rslt = dev->write(BMI2_GYR_CONF_ADDR, &gyr_conf, 1, dev->intf_ptr);
-    if (rslt != BMI2_OK) return rslt;
-    return dev->write(BMI2_GYR_RANGE_ADDR, &gyr_range, 1, dev->intf_ptr);
-  }
-  return BMI2_OK;
-}
-
-int8_t bmi2_get_sensor_data(bmi2_sensor_data *sensor_data, uint8_t n_sens, bmi2_dev *dev) {
-  uint8_t data[12];
-
-  // Read accelerometer data
-  int8_t rslt = dev->read(BMI2_ACC_DATA_ADDR, data, 6, dev->intf_ptr);
-  if (rslt != BMI2_OK) return rslt;
-
-  sensor_data[0].sens_data.acc.x = (int16_t)(data[0] | (data[1] << 8));
-  sensor_data[0].sens_data.acc.y = (int16_t)(data[2] | (data[3] << 8));
-  sensor_data[0].sens_data.acc.z = (int16_t)(data[4] | (data[5] << 8));
-
-  // Read gyroscope data
-  rslt = dev->read(BMI2_GYR_DATA_ADDR, data, 6, dev->intf_ptr);
-  if (rslt != BMI2_OK) return rslt;
-
-  sensor_data[1].sens_data.gyr.x = (int16_t)(data[0] | (data[1] << 8));
-  sensor_data[1].sens_data.gyr.y = (int16_t)(data[2] | (data[3] << 8));
-  sensor_data[1].sens_data.gyr.z = (int16_t)(data[4] | (data[5] << 8));
-
-  return BMI2_OK;
-}
-
-void BMI270Component::setup() {
-  ESP_LOGCONFIG(TAG, "Setting up BMI270...");
-
-  this->sensor_.intf_ptr = this;
-  this->sensor_.intf = BMI2_I2C_INTF;
-  this->sensor_.read = read_bytes;
-  this->sensor_.write = write_bytes;
-  this->sensor_.delay_us = delay_usec;
-
-  int8_t rslt;
-
-  // Initialize the BMI270
-  rslt = bmi270_init(&this->sensor_);
-  if (rslt != BMI2_OK) {
-    if (rslt == BMI2_E_CONFIG_LOAD) {
-      ESP_LOGE(TAG, "BMI270 config load failed");
-      uint8_t internal_status = 0;
-      this->read_register(BMI2_INTERNAL_STATUS_ADDR, &internal_status, 1);
-      char buf[64];
-      snprintf(buf, sizeof(buf), "Config load failed, INTERNAL_STATUS=0x%02X; ", internal_status);
-      this->failure_reason_ += buf;
-    } else {
-      ESP_LOGE(TAG, "BMI270 initialization failed: %d", rslt);
-      this->failure_reason_ += "Initialization failed; ";
-    }
-    this->mark_failed();
-    return;
-  }
-
-  ESP_LOGI(TAG, "BMI270 initialization succeeded");
-
-  // Enable accelerometer and gyroscope
-  uint8_t sens_list[2] = { BMI2_ACCEL, BMI2_GYRO };
-  rslt = bmi270_sensor_enable(sens_list, 2, &this->sensor_);
-  if (rslt != BMI2_OK) {
-    ESP_LOGE(TAG, "Failed to enable accelerometer and gyroscope: %d", rslt);
-    this->failure_reason_ += "Sensor enable failed; ";
-    this->mark_failed();
-    return;
-  }
-  
-  // Verify PWR_CTRL was written correctly
-  uint8_t pwr_ctrl_readback = 0;
-  uint8_t pwr_conf_readback = 0;
-  this->read_register(BMI2_PWR_CTRL_ADDR, &pwr_ctrl_readback, 1);
-  this->read_register(BMI2_PWR_CONF_ADDR, &pwr_conf_readback, 1);
-  
-  char buf[64];
-  snprintf(buf, sizeof(buf), "PWR_CTRL=0x%02X PWR_CONF=0x%02X; ", pwr_ctrl_readback, pwr_conf_readback);
-  this->failure_reason_ += buf;
-
-  // Configure accelerometer
-  this->accel_cfg_.type = BMI2_ACCEL;
-  this->accel_cfg_.cfg.acc.odr = BMI2_ACC_ODR_100HZ;
-  this->accel_cfg_.cfg.acc.range = BMI2_ACC_RANGE_2G;
-  this->accel_cfg_.cfg.acc.bw = BMI2_ACC_NORMAL_AVG4;
-  this->accel_cfg_.cfg.acc.perf_mode = BMI2_PERF_OPT_MODE;
-  rslt = bmi270_set_sensor_config(&this->accel_cfg_, 1, &this->sensor_);
-  if (rslt != BMI2_OK) {
-    ESP_LOGE(TAG, "Failed to configure accelerometer: %d", rslt);
-    this->failure_reason_ += "Accelerometer config failed; ";
-    this->mark_failed();
-    return;
-  }
-  
-  // Read back accelerometer config
-  uint8_t acc_conf_readback = 0;
-  uint8_t acc_range_readback = 0;
-  this->read_register(BMI2_ACC_CONF_ADDR, &acc_conf_readback, 1);
-  this->read_register(BMI2_ACC_RANGE_ADDR, &acc_range_readback, 1);
-  
-  snprintf(buf, sizeof(buf), "ACC_CONF=0x%02X ACC_RANGE=0x%02X; ", acc_conf_readback, acc_range_readback);
-  this->failure_reason_ += buf;
-
-  // Configure gyroscope
-  this->gyro_cfg_.type = BMI2_GYRO;
-  this->gyro_cfg_.cfg.gyr.odr = BMI2_GYR_ODR_100HZ;
-  this->gyro_cfg_.cfg.gyr.range = BMI2_GYR_RANGE_2000;
-  this->gyro_cfg_.cfg.gyr.bw = BMI2_GYR_NORMAL_MODE;
-  this->gyro_cfg_.cfg.gyr.noise_perf = BMI2_POWER_OPT_MODE;
-  this->gyro_cfg_.cfg.gyr.filter_perf = BMI2_PERF_OPT_MODE;
-  rslt = bmi270_set_sensor_config(&this->gyro_cfg_, 1, &this->sensor_);
-  if (rslt != BMI2_OK) {
-    ESP_LOGE(TAG, "Failed to configure gyroscope: %d", rslt);
-    this->failure_reason_ += "Gyroscope config failed; ";
-    this->mark_failed();
-    return;
-  }
-  
-  // Read back gyroscope config
-  uint8_t gyr_conf_readback = 0;
-  uint8_t gyr_range_readback = 0;
-  this->read_register(BMI2_GYR_CONF_ADDR, &gyr_conf_readback, 1);
-  this->read_register(BMI2_GYR_RANGE_ADDR, &gyr_range_readback, 1);
-  
-  snprintf(buf, sizeof(buf), "GYR_CONF=0x%02X GYR_RANGE=0x%02X; ", gyr_conf_readback, gyr_range_readback);
-  this->failure_reason_ += buf;
-
-  // Enable gyroscope offset compensation
-  // NV_CONF register (0x70): bit 6 = gyr_off_en
-  uint8_t nv_conf = 0;
-  this->read_register(BMI2_NV_CONF_ADDR, &nv_conf, 1);
-  nv_conf |= 0x40;  // Set bit 6 to enable gyro offset compensation
-  this->write_register(BMI2_NV_CONF_ADDR, &nv_conf, 1);
-  ESP_LOGI(TAG, "Enabled gyroscope offset compensation (NV_CONF=0x%02X)", nv_conf);
-
-  // Perform software gyro bias calibration
-  // Wait for sensor to stabilize, then take average readings
-  ESP_LOGI(TAG, "Calibrating gyroscope bias (keep device still)...");
-  delay(10);  // Wait for sensor to stabilize
-  
-  int32_t gyro_bias_x = 0, gyro_bias_y = 0, gyro_bias_z = 0;
-  const int num_samples = 32;
-  
-  for (int i = 0; i < num_samples; i++) {
-    uint8_t gyro_data[6];
-    this->read_register(BMI2_GYR_DATA_ADDR, gyro_data, 6);
-    int16_t gx = (int16_t)((gyro_data[1] << 8) | gyro_data[0]);
-    int16_t gy = (int16_t)((gyro_data[3] << 8) | gyro_data[2]);
-    int16_t gz = (int16_t)((gyro_data[5] << 8) | gyro_data[4]);
-    gyro_bias_x += gx;
-    gyro_bias_y += gy;
-    gyro_bias_z += gz;
-    delay(10);  // 100Hz sample rate
-  }
-  
-  this->gyro_bias_x_ = gyro_bias_x / num_samples;
-  this->gyro_bias_y_ = gyro_bias_y / num_samples;
-  this->gyro_bias_z_ = gyro_bias_z / num_samples;
-  
-  ESP_LOGI(TAG, "Gyro bias calibration complete: X=%d Y=%d Z=%d LSB", 
-           this->gyro_bias_x_, this->gyro_bias_y_, this->gyro_bias_z_);
-
-  this->is_initialized_ = true;
-
-  // Verify sensors are actually active by checking status register
-  uint8_t status = 0;
-  i2c::ErrorCode err = this->read_register(0x03, &status, 1);  // Read STATUS_ADDR (0x03)
-  
-  snprintf(buf, sizeof(buf), "STATUS=0x%02X (i2c_err=%d) ACC_DRDY=%d GYR_DRDY=%d", 
-           status, err, (status >> 7) & 1, (status >> 6) & 1);
-  this->failure_reason_ += buf;
-  
-  if (err == i2c::ERROR_OK && (status & 0xC0)) {
-    this->sensors_active_ = true;
-  }
-}
-
-void BMI270Component::update() {
-  if (!this->is_initialized_)
-    return;
-
-  // Check status register to see if data is ready
-  uint8_t status = 0;
-  i2c::ErrorCode err = this->read_register(0x03, &status, 1);
-  
-  struct bmi2_sensor_data sensor_data[2] = {};
-  sensor_data[0].type = BMI2_ACCEL;
-  sensor_data[1].type = BMI2_GYRO;
-
-  int8_t rslt = bmi2_get_sensor_data(sensor_data, 2, &this->sensor_);
-  if (rslt != BMI2_OK) {
-    ESP_LOGW(TAG, "Failed to read sensor data: %d", rslt);
-    return;
-  }
-
-  // Log raw sensor values and status for debugging
-  ESP_LOGD(TAG, "Status=0x%02X (i2c_err=%d) | Accel: X=%d Y=%d Z=%d | Gyro: X=%d Y=%d Z=%d",
-           status, err,
-           sensor_data[0].sens_data.acc.x, sensor_data[0].sens_data.acc.y, sensor_data[0].sens_data.acc.z,
-           sensor_data[1].sens_data.gyr.x, sensor_data[1].sens_data.gyr.y, sensor_data[1].sens_data.gyr.z);
-
-  // Accelerometer: At ±2g range, sensitivity is 16384 LSB/g
-  // Convert to SI units: m/s² (multiply g by 9.80665)
-  constexpr float ACCEL_SCALE = 9.80665f / 16384.0f;  // LSB to m/s²
-  if (this->accel_x_sensor_ != nullptr)
-    this->accel_x_sensor_->publish_state(sensor_data[0].sens_data.acc.x * ACCEL_SCALE);
-  if (this->accel_y_sensor_ != nullptr)
-    this->accel_y_sensor_->publish_state(sensor_data[0].sens_data.acc.y * ACCEL_SCALE);
-  if (this->accel_z_sensor_ != nullptr)
-    this->accel_z_sensor_->publish_state(sensor_data[0].sens_data.acc.z * ACCEL_SCALE);
-
-  // Gyroscope: At ±2000°/s range, sensitivity is 16.4 LSB/°/s
-  // Output in °/s (degrees per second), with bias correction
-  constexpr float GYRO_SCALE = 1.0f / 16.4f;  // LSB to °/s
-  if (this->gyro_x_sensor_ != nullptr)
-    this->gyro_x_sensor_->publish_state((sensor_data[1].sens_data.gyr.x - this->gyro_bias_x_) * GYRO_SCALE);
-  if (this->gyro_y_sensor_ != nullptr)
-    this->gyro_y_sensor_->publish_state((sensor_data[1].sens_data.gyr.y - this->gyro_bias_y_) * GYRO_SCALE);
-  if (this->gyro_z_sensor_ != nullptr)
-    this->gyro_z_sensor_->publish_state((sensor_data[1].sens_data.gyr.z - this->gyro_bias_z_) * GYRO_SCALE);
-
-  // Temperature: Registers 0x22 (LSB) and 0x23 (MSB)
-  // Resolution: 1/512 °C/LSB, with 0x0000 = 23°C
-  if (this->temperature_sensor_ != nullptr) {
-    uint8_t temp_data[2];
-    if (this->read_register(0x22, temp_data, 2) == i2c::ERROR_OK) {
-      int16_t temp_raw = (int16_t)((temp_data[1] << 8) | temp_data[0]);
-      float temperature = (temp_raw / 512.0f) + 23.0f;
-      this->temperature_sensor_->publish_state(temperature);
-    }
-  }
-}
-
-void BMI270Component::dump_config() {
-  ESP_LOGCONFIG(TAG, "BMI270:");
-  LOG_I2C_DEVICE(this);
-  if (this->is_failed()) {
-    ESP_LOGE(TAG, "  Initialization failed: %s", this->failure_reason_.c_str());
-  }
-  ESP_LOGCONFIG(TAG, "  Sensors active: %s", this->sensors_active_ ? "Yes" : "No");
-  ESP_LOGCONFIG(TAG, "  Initialized: %s", this->is_initialized_ ? "Yes" : "No");
-}
-
-float BMI270Component::get_setup_priority() const {
-  return setup_priority::DATA;
-}
-
-int8_t BMI270Component::read_bytes(uint8_t reg_addr, uint8_t *data, uint32_t len, void *intf_ptr) {
-  auto *component = reinterpret_cast<BMI270Component *>(intf_ptr);
-  if (component->read_register(reg_addr, data, len) != i2c::ERROR_OK) {
-    return BMI2_E_COM_FAIL;
-  }
-  return BMI2_OK;
-}
-
-int8_t BMI270Component::write_bytes(uint8_t reg_addr, const uint8_t *data, uint32_t len, void *intf_ptr) {
-  auto *component = reinterpret_cast<BMI270Component *>(intf_ptr);
-  if (component->write_register(reg_addr, data, len) != i2c::ERROR_OK) {
-    return BMI2_E_COM_FAIL;
-  }
-  return BMI2_OK;
-}
-
-void BMI270Component::delay_usec(uint32_t period, void *) {
-  delay_microseconds_safe(period);
-}
-
-}  // namespace bmi270
-}  // namespace esphome
+#include "bmi270.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace esphome {
+namespace bmi270 {
+
+static const char *const TAG = "bmi270";
+
+// The temperature register only changes slowly, so it is sampled less often
+// than the motion data
+static const uint32_t TEMPERATURE_INTERVAL_MS = 1000;
+// Every gated poll moves the publish counters, so they are reported on
+// their own, much slower interval
+static const uint32_t COUNTERS_INTERVAL_MS = 60000;
+// Home Assistant drops text states longer than this, so vector records are
+// split across publishes at this length; BASE64 fits this many raw bytes
+static const uint16_t VECTOR_MAX_STATE_LEN = 255;
+static const uint16_t VECTOR_MAX_RAW_LEN = VECTOR_MAX_STATE_LEN / 4 * 3;
+
+static const float SENSORTIME_TICK_S = 1.0f / 25600.0f;
+static const float DEG_TO_RAD_F = 0.01745329252f;
+static const float RAD_TO_DEG_F = 57.29577951f;
+// Larger sensortime gaps than this mean samples were lost; fusion then
+// integrates over one nominal ODR period instead
+static const float FUSION_MAX_DT_S = 0.1f;
+
+// Setup runs as a state machine from loop(); each step may block at most
+// this long before yielding back to the other components
+static const uint32_t SETUP_STEP_BUDGET_MS = 20;
+// Smallest chunk the adaptive upload backs off to (must be even)
+static const uint16_t CONFIG_MIN_CHUNK_SIZE = 32;
+// INIT_OK typically rises ~20 ms after INIT_CTRL=1; give up after 150 ms
+static const uint32_t INIT_FIRST_POLL_MS = 20;
+// Recovery: consecutive failed reads before re-initializing, how often the
+// chip is checked for a reset, and the retry backoff range
+static const uint8_t HEALTH_MAX_CONSECUTIVE_ERRORS = 5;
+static const uint32_t HEALTH_CHECK_INTERVAL_MS = 10000;
+static const uint32_t RECOVERY_MIN_BACKOFF_MS = 100;
+static const uint32_t RECOVERY_MAX_BACKOFF_MS = 30000;
+// A sync_with follower polls for its predecessor's upload to finish
+static const uint32_t SYNC_SETUP_WAIT_MS = 20;
+static const uint32_t INIT_POLL_INTERVAL_MS = 10;
+static const uint8_t INIT_MAX_POLLS = 14;
+// Start-up times when sensors are powered around a read
+static const uint32_t ACCEL_WAKE_MS = 2;
+static const uint32_t GYRO_WAKE_MS = 45;
+static const uint32_t GYRO_FAST_START_WAKE_MS = 2;
+// Fast offset compensation: average this many samples, one per ODR period.
+// A larger peak-to-peak spread means the device moved, and FOC is retried.
+static const uint8_t FOC_SAMPLES = 64;
+static const float FOC_MAX_GYRO_SPREAD_DPS = 2.0f;
+static const float FOC_MAX_ACCEL_SPREAD_G = 0.05f;
+static const uint8_t FOC_MAX_ATTEMPTS = 5;
+static const uint32_t FOC_RETRY_MS = 1000;
+// Offset register resolution
+static const float GYRO_OFFSET_DPS_PER_LSB = 0.061f;
+static const float ACCEL_OFFSET_LSB_PER_G = 256.0f;
+// CRT runs in the feature engine and takes up to about a second
+static const uint32_t CRT_POLL_INTERVAL_MS = 50;
+static const uint16_t CRT_MAX_POLLS = 40;
+
+// Bias model: stillness limits and how often a changed table is written
+static const float BIAS_MAX_GYRO_STD_DPS = 0.3f;
+static const float BIAS_MAX_ACCEL_DEV_G = 0.05f;
+static const uint32_t BIAS_SAVE_INTERVAL_MS = 30 * 60 * 1000;
+
+static inline uint32_t odr_period_ms(uint8_t odr) { return (FifoParser::odr_to_ticks(odr) * 10 + 255) / 256; }
+// Whole samples at an ODR, at least one
+static inline uint16_t ms_to_samples(uint32_t ms, uint8_t odr) {
+  uint32_t samples = (ms * 128 + FifoParser::odr_to_ticks(odr) * 5 / 2) / (FifoParser::odr_to_ticks(odr) * 5);
+  return samples < 1 ? 1 : (samples > UINT16_MAX ? UINT16_MAX : samples);
+}
+
+void BMI270Component::setup() {
+  ESP_LOGCONFIG(TAG, "Setting up BMI270...");
+
+  this->sensor_.intf_ptr = this;
+  this->sensor_.intf = this->bus_interface_();
+  this->sensor_.read = read_bytes;
+  this->sensor_.write = write_bytes;
+  this->sensor_.delay_us = delay_usec;
+
+  this->calibration_pref_ =
+      global_preferences->make_preference<BMI270Calibration>(fnv1_hash("bmi270_calibration") ^ this->bus_preference_key_(), true);
+  if (this->bias_model_enabled_) {
+    this->bias_pref_ =
+        global_preferences->make_preference<BiasTable>(fnv1_hash("bmi270_bias") ^ this->bus_preference_key_(), true);
+    BiasTable table;
+    if (this->bias_pref_.load(&table)) {
+      this->bias_model_.set_table(table);
+      ESP_LOGD(TAG, "Loaded gyro bias table, %u bins learned", this->bias_model_.get_learned_bins());
+    }
+    const int32_t acc_lsb_per_g = accel_lsb_per_g(this->accel_range_);
+    this->bias_model_.set_limits(BIAS_MAX_GYRO_STD_DPS / this->gyro_scale_, acc_lsb_per_g,
+                                 BIAS_MAX_ACCEL_DEV_G * acc_lsb_per_g);
+  }
+
+  if (this->tap_enabled_) {
+    float threshold = this->tap_threshold_g_ * accel_lsb_per_g(this->accel_range_);
+    this->tap_detector_.configure(threshold > UINT16_MAX ? UINT16_MAX : (uint16_t) threshold,
+                                  ms_to_samples(this->tap_duration_ms_, this->accel_odr_),
+                                  ms_to_samples(this->tap_quiet_ms_, this->accel_odr_),
+                                  this->double_tap_enabled_
+                                      ? ms_to_samples(this->double_tap_window_ms_, this->accel_odr_)
+                                      : 0);
+  }
+
+  // The rest of the bring-up runs from loop() so the other components do
+  // not wait behind the config upload and calibration
+  this->setup_start_ms_ = millis();
+  this->setup_state_ = SETUP_STATE_PREPARE;
+  this->run_setup_step_();
+}
+
+void BMI270Component::setup_wait_(uint32_t ms) {
+  this->setup_waiting_ = true;
+  this->set_timeout("setup", ms, [this]() { this->setup_waiting_ = false; });
+}
+
+void BMI270Component::fail_setup_(const char *step, int8_t error) {
+  this->diagnostics_.failed_step = step;
+  this->diagnostics_.error = error;
+  this->diagnostics_.setup_ms = millis() - this->setup_start_ms_;
+  this->snapshot_registers_();
+  this->publish_diagnostics_();
+  this->status_set_error();
+  this->start_recovery_(step);
+}
+
+void BMI270Component::finish_setup_() {
+  this->setup_state_ = SETUP_STATE_READY;
+  this->setup_complete_ = true;
+  this->diagnostics_.setup_ms = millis() - this->setup_start_ms_;
+  this->diagnostics_.failed_step = nullptr;
+  this->diagnostics_.error = BMI2_OK;
+  if (this->recovering_) {
+    ESP_LOGI(TAG, "BMI270 recovered after %u ms", (unsigned) this->diagnostics_.setup_ms);
+    this->recovering_ = false;
+  } else {
+    ESP_LOGI(TAG, "BMI270 ready after %u ms", (unsigned) this->diagnostics_.setup_ms);
+  }
+  this->recovery_backoff_ms_ = 0;
+  this->consecutive_errors_ = 0;
+  this->last_health_check_ms_ = millis();
+  this->status_clear_error();
+  this->status_clear_warning();
+  this->publish_diagnostics_();
+}
+
+void BMI270Component::start_recovery_(const char *reason) {
+  this->is_initialized_ = false;
+  this->cancel_timeout("wake");
+  this->waking_ = false;
+  // setup_interrupts_() attaches the handlers again
+  if (this->data_int_pin_ != nullptr)
+    this->data_int_pin_->detach_interrupt();
+  if (this->feature_int_pin_ != nullptr && this->feature_int_pin_ != this->data_int_pin_)
+    this->feature_int_pin_->detach_interrupt();
+  this->data_int_pin_ = nullptr;
+  this->feature_int_pin_ = nullptr;
+  this->data_irq_ = false;
+  this->feature_irq_ = false;
+
+  this->recovery_backoff_ms_ = this->recovery_backoff_ms_ == 0 ? RECOVERY_MIN_BACKOFF_MS
+                                                               : this->recovery_backoff_ms_ * 2;
+  if (this->recovery_backoff_ms_ > RECOVERY_MAX_BACKOFF_MS)
+    this->recovery_backoff_ms_ = RECOVERY_MAX_BACKOFF_MS;
+  ESP_LOGW(TAG, "Re-initializing after %s in %u ms", reason, (unsigned) this->recovery_backoff_ms_);
+  this->recovering_ = true;
+  this->recoveries_++;
+  this->status_set_warning();
+  this->setup_state_ = SETUP_STATE_RECOVER;
+  this->setup_wait_(this->recovery_backoff_ms_);
+}
+
+void BMI270Component::record_read_result_(int8_t rslt) {
+  if (rslt == BMI2_OK) {
+    this->consecutive_errors_ = 0;
+    return;
+  }
+  this->read_errors_++;
+  if (++this->consecutive_errors_ >= HEALTH_MAX_CONSECUTIVE_ERRORS)
+    this->start_recovery_("repeated read errors");
+}
+
+void BMI270Component::check_health_() {
+  uint32_t now = millis();
+  if (now - this->last_health_check_ms_ < HEALTH_CHECK_INTERVAL_MS)
+    return;
+  this->last_health_check_ms_ = now;
+  // A brown-out resets the chip, which drops the loaded config and INIT_OK
+  uint8_t internal_status = 0;
+  int8_t rslt = bmi270_get_init_status(&internal_status, &this->sensor_);
+  this->record_read_result_(rslt);
+  if (rslt == BMI2_OK && (internal_status & BMI2_INIT_OK) != BMI2_INIT_OK)
+    this->start_recovery_("sensor reset");
+}
+
+void BMI270Component::snapshot_registers_() {
+  // Four bursts, only on the failure path
+  BMI270Diagnostics &diag = this->diagnostics_;
+  uint8_t conf[4], pwr[2];
+  diag.snapshot_valid = bmi2_get_regs(BMI2_STATUS_ADDR, &diag.status, 1, &this->sensor_) == BMI2_OK &&
+                        bmi2_get_regs(BMI2_INTERNAL_STATUS_ADDR, &diag.internal_status, 1, &this->sensor_) == BMI2_OK &&
+                        bmi2_get_regs(BMI2_ACC_CONF_ADDR, conf, 4, &this->sensor_) == BMI2_OK &&
+                        bmi2_get_regs(BMI2_PWR_CONF_ADDR, pwr, 2, &this->sensor_) == BMI2_OK;
+  if (!diag.snapshot_valid)
+    return;
+  diag.acc_conf = conf[0];
+  diag.acc_range = conf[1];
+  diag.gyr_conf = conf[2];
+  diag.gyr_range = conf[3];
+  diag.pwr_conf = pwr[0];
+  diag.pwr_ctrl = pwr[1];
+}
+
+void BMI270Component::publish_diagnostics_() {
+  if (this->setup_time_sensor_ != nullptr)
+    this->setup_time_sensor_->publish_state(this->diagnostics_.setup_ms);
+  if (this->setup_error_sensor_ != nullptr)
+    this->setup_error_sensor_->publish_state(this->diagnostics_.error);
+  if (this->recoveries_sensor_ != nullptr)
+    this->recoveries_sensor_->publish_state(this->recoveries_);
+}
+
+void BMI270Component::run_setup_step_() {
+  int8_t rslt;
+
+  switch (this->setup_state_) {
+    case SETUP_STATE_RECOVER: {
+      this->sensor_clock_.reset();
+      this->fusion_sensortime_ = 0;
+      this->has_sample_ = false;
+      this->tap_detector_.reset();
+      this->setup_start_ms_ = millis();
+      // The chip ID read also puts a reset chip back into SPI mode
+      uint8_t chip_id = 0;
+      rslt = bmi2_get_regs(BMI2_CHIP_ID_ADDR, &chip_id, 1, &this->sensor_);
+      if (rslt != BMI2_OK || chip_id != BMI2_CHIP_ID) {
+        this->start_recovery_("no response");
+        return;
+      }
+      // With INIT_OK still set the config blob survived, and only the
+      // registers need to be written again
+      uint8_t internal_status = 0;
+      rslt = bmi270_get_init_status(&internal_status, &this->sensor_);
+      if (rslt == BMI2_OK && (internal_status & BMI2_INIT_OK) == BMI2_INIT_OK) {
+        this->setup_state_ = SETUP_STATE_CONFIGURE;
+      } else {
+        this->setup_state_ = SETUP_STATE_PREPARE;
+      }
+      break;
+    }
+
+    case SETUP_STATE_PREPARE:
+      // Instances in a sync_with group take turns uploading instead of
+      // interleaving their bursts on the bus
+      if (this->sync_prev_ != nullptr && this->sync_prev_->setup_state_ < SETUP_STATE_WAIT_INIT) {
+        this->setup_wait_(SYNC_SETUP_WAIT_MS);
+        return;
+      }
+      rslt = bmi270_prepare_config_load(&this->sensor_);
+      if (rslt != BMI2_OK) {
+        ESP_LOGE(TAG, "BMI270 initialization failed: %d", rslt);
+        this->fail_setup_("chip ID check", rslt);
+        return;
+      }
+      this->upload_index_ = 0;
+      this->setup_state_ = SETUP_STATE_UPLOAD;
+      break;
+
+    case SETUP_STATE_UPLOAD: {
+      if (this->upload_index_ == 0) {
+        this->upload_start_ms_ = millis();
+        this->upload_start_transactions_ = this->bus_transactions_;
+        this->upload_chunk_size_ = this->config_burst_size_;
+      }
+      const uint16_t config_size = bmi270_get_config_size();
+      uint32_t start = millis();
+      while (this->upload_index_ < config_size) {
+        uint16_t remaining = config_size - this->upload_index_;
+        uint16_t len = remaining > this->upload_chunk_size_ ? this->upload_chunk_size_ : remaining;
+        rslt = bmi270_write_config_chunk(this->upload_index_, len, &this->sensor_);
+        if (rslt != BMI2_OK) {
+          // Large bursts can exceed the I2C driver's buffer; halve the chunk
+          // and rewrite the same word address
+          if (this->upload_chunk_size_ > CONFIG_MIN_CHUNK_SIZE) {
+            this->upload_chunk_size_ = (this->upload_chunk_size_ / 2) & ~1u;
+            if (this->upload_chunk_size_ < CONFIG_MIN_CHUNK_SIZE)
+              this->upload_chunk_size_ = CONFIG_MIN_CHUNK_SIZE;
+            this->upload_retries_++;
+            ESP_LOGD(TAG, "Config burst failed at offset %u, retrying with %u byte chunks", this->upload_index_,
+                     this->upload_chunk_size_);
+            continue;
+          }
+          ESP_LOGE(TAG, "BMI270 config upload failed at offset %u: %d", this->upload_index_, rslt);
+          this->fail_setup_("config upload", rslt);
+          return;
+        }
+        this->upload_index_ += len;
+        if (millis() - start >= SETUP_STEP_BUDGET_MS)
+          return;
+      }
+
+      this->upload_time_ms_ = millis() - this->upload_start_ms_;
+      this->upload_transactions_ = this->bus_transactions_ - this->upload_start_transactions_;
+      ESP_LOGD(TAG, "Config upload: %u bytes in %u ms, %u transactions, %u byte chunks",
+               (unsigned) config_size, (unsigned) this->upload_time_ms_,
+               (unsigned) this->upload_transactions_, this->upload_chunk_size_);
+
+      rslt = bmi270_start_config_load(&this->sensor_);
+      if (rslt != BMI2_OK) {
+        ESP_LOGE(TAG, "BMI270 initialization failed: %d", rslt);
+        this->fail_setup_("config load start", rslt);
+        return;
+      }
+      this->init_polls_ = 0;
+      this->setup_state_ = SETUP_STATE_WAIT_INIT;
+      this->setup_wait_(INIT_FIRST_POLL_MS);
+      break;
+    }
+
+    case SETUP_STATE_WAIT_INIT: {
+      // Check internal status to verify config load was successful
+      uint8_t internal_status = 0;
+      rslt = bmi270_get_init_status(&internal_status, &this->sensor_);
+      if (rslt != BMI2_OK) {
+        ESP_LOGE(TAG, "BMI270 initialization failed: %d", rslt);
+        this->fail_setup_("INIT_OK poll", rslt);
+        return;
+      }
+      if ((internal_status & BMI2_INIT_OK) != BMI2_INIT_OK) {
+        if (++this->init_polls_ < INIT_MAX_POLLS) {
+          this->setup_wait_(INIT_POLL_INTERVAL_MS);
+          return;
+        }
+        ESP_LOGE(TAG, "BMI270 config load failed, INTERNAL_STATUS=0x%02X", internal_status);
+        this->fail_setup_("config load", BMI2_E_CONFIG_LOAD);
+        return;
+      }
+      this->diagnostics_.init_ms = millis() - this->setup_start_ms_;
+      ESP_LOGI(TAG, "BMI270 initialization succeeded after %u ms", (unsigned) this->diagnostics_.init_ms);
+      this->setup_state_ = SETUP_STATE_CONFIGURE;
+      break;
+    }
+
+    case SETUP_STATE_CONFIGURE: {
+      if (!this->configure_sensors_())
+        return;
+      if (this->setup_complete_) {
+        // Offsets from the first bring-up are still in RAM; no FOC here
+        if (!this->apply_offsets_() || !this->start_acquisition_())
+          return;
+        this->finish_setup_();
+        break;
+      }
+      // Offsets from an earlier FOC are reloaded instead of recalibrating
+      BMI270Calibration stored{};
+      if (this->calibration_pref_.load(&stored) && stored.gyr_valid &&
+          (stored.acc_valid || !this->accel_calibration_)) {
+        this->calibration_ = stored;
+        if (!this->apply_offsets_())
+          return;
+        ESP_LOGI(TAG, "Loaded stored offsets");
+        if (!this->start_acquisition_())
+          return;
+        this->finish_setup_();
+        break;
+      }
+      this->calibration_attempts_ = 0;
+      this->start_calibration_();
+      break;
+    }
+
+    case SETUP_STATE_CRT: {
+      bool running = true;
+      uint8_t status = 0;
+      rslt = bmi2_get_crt_status(&running, &status, &this->sensor_);
+      if (rslt == BMI2_OK && running && ++this->crt_polls_ < CRT_MAX_POLLS) {
+        this->setup_wait_(CRT_POLL_INTERVAL_MS);
+        return;
+      }
+      if (rslt != BMI2_OK || running) {
+        ESP_LOGW(TAG, "Gyro CRT did not complete");
+      } else if (status != 0) {
+        ESP_LOGW(TAG, "Gyro CRT failed, status %u", status);
+      } else {
+        ESP_LOGI(TAG, "Gyro CRT complete after %u ms", (unsigned) (this->crt_polls_ * CRT_POLL_INTERVAL_MS));
+        // The new gain trims only apply with gyr_gain_en set
+        rslt = bmi2_set_gyro_gain_enable(true, &this->sensor_);
+        if (rslt != BMI2_OK)
+          ESP_LOGW(TAG, "Failed to enable the CRT gain: %d", rslt);
+      }
+      // Gyro back on for FOC
+      bmi2_set_pwr_ctrl(BMI2_PWR_CTRL_ACC_EN | BMI2_PWR_CTRL_GYR_EN | BMI2_PWR_CTRL_TEMP_EN, &this->sensor_);
+      this->calibration_count_ = 0;
+      this->setup_state_ = SETUP_STATE_CALIBRATE;
+      this->setup_wait_(GYRO_WAKE_MS);
+      break;
+    }
+
+    case SETUP_STATE_CALIBRATE: {
+      bmi2_sensor_data data[2];
+      if (bmi2_get_sensor_data(data, 2, &this->sensor_) == BMI2_OK) {
+        const int16_t values[6] = {data[0].sens_data.acc.x, data[0].sens_data.acc.y, data[0].sens_data.acc.z,
+                                   data[1].sens_data.gyr.x, data[1].sens_data.gyr.y, data[1].sens_data.gyr.z};
+        for (uint8_t i = 0; i < 6; i++) {
+          if (this->calibration_count_ == 0) {
+            this->calibration_sum_[i] = 0;
+            this->calibration_min_[i] = this->calibration_max_[i] = values[i];
+          }
+          this->calibration_sum_[i] += values[i];
+          if (values[i] < this->calibration_min_[i])
+            this->calibration_min_[i] = values[i];
+          if (values[i] > this->calibration_max_[i])
+            this->calibration_max_[i] = values[i];
+        }
+        this->calibration_count_++;
+      }
+      if (this->calibration_count_ < FOC_SAMPLES) {
+        uint32_t acc_period = odr_period_ms(this->accel_odr_), gyr_period = odr_period_ms(this->gyro_odr_);
+        this->setup_wait_(acc_period > gyr_period ? acc_period : gyr_period);
+        return;
+      }
+
+      if (!this->finish_calibration_()) {
+        if (++this->calibration_attempts_ < FOC_MAX_ATTEMPTS) {
+          this->calibration_count_ = 0;
+          this->setup_wait_(FOC_RETRY_MS);
+          return;
+        }
+        ESP_LOGW(TAG, "Device kept moving, continuing without offset compensation");
+      }
+
+      if (this->recalibrating_) {
+        this->recalibrating_ = false;
+        if (this->fifo_mode_ != FIFO_MODE_DISABLED)
+          bmi2_flush_fifo(&this->sensor_);
+        this->fusion_.reset();
+        this->fusion_sensortime_ = 0;
+        if (this->apply_power_save_mode() != BMI2_OK)
+          ESP_LOGW(TAG, "Failed to restore power save mode");
+        this->is_initialized_ = true;
+        this->setup_state_ = SETUP_STATE_READY;
+        break;
+      }
+      if (!this->start_acquisition_())
+        return;
+      this->finish_setup_();
+      break;
+    }
+
+    default:
+      break;
+  }
+}
+
+bool BMI270Component::configure_sensors_() {
+  // Enable accelerometer and gyroscope
+  uint8_t sens_list[2] = { BMI2_ACCEL, BMI2_GYRO };
+  int8_t rslt = bmi270_sensor_enable(sens_list, 2, &this->sensor_);
+  if (rslt != BMI2_OK) {
+    ESP_LOGE(TAG, "Failed to enable accelerometer and gyroscope: %d", rslt);
+    this->fail_setup_("sensor enable", rslt);
+    return false;
+  }
+
+  // Configure accelerometer
+  this->accel_cfg_.type = BMI2_ACCEL;
+  this->accel_cfg_.cfg.acc.odr = this->accel_odr_;
+  this->accel_cfg_.cfg.acc.range = this->accel_range_;
+  if (this->power_save_mode_ == POWER_SAVE_MODE_NORMAL) {
+    this->accel_cfg_.cfg.acc.bw = this->accel_bandwidth_;
+    this->accel_cfg_.cfg.acc.perf_mode = this->performance_mode_ ? BMI2_PERF_OPT_MODE : BMI2_POWER_OPT_MODE;
+  } else {
+    // Low-power accel: bwp selects the number of averaged samples
+    this->accel_cfg_.cfg.acc.bw = this->accel_averaging_;
+    this->accel_cfg_.cfg.acc.perf_mode = BMI2_POWER_OPT_MODE;
+  }
+  rslt = bmi270_set_sensor_config(&this->accel_cfg_, 1, &this->sensor_);
+  if (rslt != BMI2_OK) {
+    ESP_LOGE(TAG, "Failed to configure accelerometer: %d", rslt);
+    this->fail_setup_("accel config", rslt);
+    return false;
+  }
+
+  // Configure gyroscope
+  this->gyro_cfg_.type = BMI2_GYRO;
+  this->gyro_cfg_.cfg.gyr.odr = this->gyro_odr_;
+  this->gyro_cfg_.cfg.gyr.range = this->gyro_range_;
+  this->gyro_cfg_.cfg.gyr.bw = this->gyro_bandwidth_;
+  this->gyro_cfg_.cfg.gyr.noise_perf = this->performance_mode_ ? BMI2_PERF_OPT_MODE : BMI2_POWER_OPT_MODE;
+  this->gyro_cfg_.cfg.gyr.filter_perf = this->performance_mode_ ? BMI2_PERF_OPT_MODE : BMI2_POWER_OPT_MODE;
+  rslt = bmi270_set_sensor_config(&this->gyro_cfg_, 1, &this->sensor_);
+  if (rslt != BMI2_OK) {
+    ESP_LOGE(TAG, "Failed to configure gyroscope: %d", rslt);
+    this->fail_setup_("gyro config", rslt);
+    return false;
+  }
+
+  return true;
+}
+
+void BMI270Component::start_calibration_() {
+  ESP_LOGI(TAG, "Calibrating offsets (keep device still%s)...", this->accel_calibration_ ? ", flat, +Z up" : "");
+  // Measure without the previous compensation
+  this->calibration_ = {};
+  bmi2_set_offsets(&this->calibration_.offsets, false, false, &this->sensor_);
+  this->calibration_count_ = 0;
+
+  if (this->gyro_crt_) {
+    bmi2_set_pwr_ctrl(BMI2_PWR_CTRL_ACC_EN | BMI2_PWR_CTRL_TEMP_EN, &this->sensor_);
+    if (bmi2_start_crt(&this->sensor_) == BMI2_OK) {
+      this->crt_polls_ = 0;
+      this->setup_state_ = SETUP_STATE_CRT;
+      this->setup_wait_(CRT_POLL_INTERVAL_MS);
+      return;
+    }
+    ESP_LOGW(TAG, "Failed to start gyro CRT");
+    bmi2_set_pwr_ctrl(BMI2_PWR_CTRL_ACC_EN | BMI2_PWR_CTRL_GYR_EN | BMI2_PWR_CTRL_TEMP_EN, &this->sensor_);
+  }
+  this->setup_state_ = SETUP_STATE_CALIBRATE;
+  this->setup_wait_(GYRO_WAKE_MS);
+}
+
+bool BMI270Component::finish_calibration_() {
+  const int32_t acc_lsb_per_g = accel_lsb_per_g(this->accel_range_);
+  const float gyro_max_spread = FOC_MAX_GYRO_SPREAD_DPS / this->gyro_scale_;
+  const float acc_max_spread = FOC_MAX_ACCEL_SPREAD_G * acc_lsb_per_g;
+  for (uint8_t i = 0; i < 6; i++) {
+    bool gyro = i >= 3;
+    if (!gyro && !this->accel_calibration_)
+      continue;
+    int32_t spread = this->calibration_max_[i] - this->calibration_min_[i];
+    if (spread > (gyro ? gyro_max_spread : acc_max_spread)) {
+      ESP_LOGW(TAG, "Device moved during calibration (%s axis %u spread %d LSB), retrying", gyro ? "gyro" : "accel",
+               i % 3, (int) spread);
+      return false;
+    }
+  }
+
+  BMI270Calibration &cal = this->calibration_;
+  for (uint8_t i = 0; i < 3; i++) {
+    float gyro_dps = (float) this->calibration_sum_[3 + i] / FOC_SAMPLES * this->gyro_scale_;
+    cal.offsets.gyr[i] = clamp<int32_t>(lroundf(-gyro_dps / GYRO_OFFSET_DPS_PER_LSB), -512, 511);
+    if (this->accel_calibration_) {
+      // Device lies flat: expect 0 g on X/Y and +1 g on Z
+      float expected = i == 2 ? acc_lsb_per_g : 0.0f;
+      float error_g = ((float) this->calibration_sum_[i] / FOC_SAMPLES - expected) / acc_lsb_per_g;
+      cal.offsets.acc[i] = clamp<int32_t>(lroundf(-error_g * ACCEL_OFFSET_LSB_PER_G), -128, 127);
+    }
+  }
+  cal.gyr_valid = true;
+  cal.acc_valid = this->accel_calibration_;
+  ESP_LOGI(TAG, "Offsets: accel %d %d %d, gyro %d %d %d LSB", cal.offsets.acc[0], cal.offsets.acc[1],
+           cal.offsets.acc[2], cal.offsets.gyr[0], cal.offsets.gyr[1], cal.offsets.gyr[2]);
+
+  if (!this->apply_offsets_())
+    return true;
+  // The chip now compensates in hardware; residuals learned against the
+  // old offsets no longer apply
+  this->gyro_bias_x_ = this->gyro_bias_y_ = this->gyro_bias_z_ = 0;
+  if (this->bias_model_enabled_) {
+    this->bias_model_.reset();
+    this->save_bias_model_();
+  }
+  if (!this->calibration_pref_.save(&cal))
+    ESP_LOGW(TAG, "Failed to store offsets");
+  return true;
+}
+
+bool BMI270Component::apply_offsets_() {
+  int8_t rslt = bmi2_set_offsets(&this->calibration_.offsets, this->calibration_.acc_valid,
+                                 this->calibration_.gyr_valid, &this->sensor_);
+  if (rslt != BMI2_OK) {
+    ESP_LOGW(TAG, "Failed to write offsets: %d", rslt);
+    return false;
+  }
+  return true;
+}
+
+void BMI270Component::recalibrate() {
+  if (this->setup_state_ != SETUP_STATE_READY) {
+    ESP_LOGW(TAG, "Cannot recalibrate before setup has finished");
+    return;
+  }
+  this->is_initialized_ = false;
+  this->cancel_timeout("wake");
+  this->waking_ = false;
+  // Everything on and no advanced power save while sampling
+  bmi2_set_pwr_conf(0x00, &this->sensor_);
+  bmi2_set_pwr_ctrl(BMI2_PWR_CTRL_ACC_EN | BMI2_PWR_CTRL_GYR_EN | BMI2_PWR_CTRL_TEMP_EN, &this->sensor_);
+  this->recalibrating_ = true;
+  this->calibration_attempts_ = 0;
+  this->start_calibration_();
+}
+
+uint16_t BMI270Component::fifo_watermark_bytes_() const {
+  // Every frame carries accel and gyro, plus a header in header mode
+  uint32_t bytes = this->fifo_watermark_ * (BMI2_FIFO_ACC_LENGTH + BMI2_FIFO_GYR_LENGTH);
+  if (this->fifo_mode_ == FIFO_MODE_HEADER) {
+    bytes += this->fifo_watermark_;
+    // Magnetometer data only goes into the frames at the aux ODR
+    if (this->mag_enabled_) {
+      uint32_t acc_ticks = FifoParser::odr_to_ticks(this->accel_cfg_.cfg.acc.odr);
+      uint32_t aux_ticks = FifoParser::odr_to_ticks(this->mag_odr_);
+      uint32_t aux_frames = (this->fifo_watermark_ * acc_ticks + aux_ticks - 1) / aux_ticks;
+      if (aux_frames > this->fifo_watermark_)
+        aux_frames = this->fifo_watermark_;
+      bytes += aux_frames * BMI2_FIFO_AUX_LENGTH;
+    }
+  }
+  // Leave room for one more full frame before the FIFO overflows
+  const uint32_t max_bytes =
+      BMI2_FIFO_SIZE - (1 + BMI2_FIFO_AUX_LENGTH + BMI2_FIFO_GYR_LENGTH + BMI2_FIFO_ACC_LENGTH);
+  return bytes < max_bytes ? bytes : max_bytes;
+}
+
+bool BMI270Component::start_acquisition_() {
+  int8_t rslt;
+  if (this->mag_enabled_) {
+    rslt = this->configure_magnetometer_();
+    if (rslt != BMI2_OK) {
+      // The IMU is still useful without its magnetometer
+      ESP_LOGE(TAG, "Failed to configure BMM150 on the aux interface: %d", rslt);
+      this->mag_enabled_ = false;
+    }
+  }
+
+  if (this->fifo_mode_ != FIFO_MODE_DISABLED) {
+    this->fifo_parser_.set_mode(this->fifo_mode_);
+    rslt = bmi2_set_fifo_config(this->fifo_mode_, this->mag_enabled_, &this->sensor_);
+    if (rslt == BMI2_OK)
+      rslt = bmi2_set_fifo_watermark(this->fifo_watermark_bytes_(), &this->sensor_);
+    if (rslt == BMI2_OK)
+      rslt = bmi2_flush_fifo(&this->sensor_);
+    if (rslt != BMI2_OK) {
+      ESP_LOGE(TAG, "Failed to configure FIFO: %d", rslt);
+      this->fail_setup_("FIFO config", rslt);
+      return false;
+    }
+  }
+
+  if (this->features_enabled_()) {
+    rslt = this->configure_features_();
+    if (rslt != BMI2_OK) {
+      ESP_LOGE(TAG, "Failed to configure feature engine: %d", rslt);
+      this->fail_setup_("feature config", rslt);
+      return false;
+    }
+  }
+
+  rslt = this->setup_interrupts_();
+  if (rslt != BMI2_OK) {
+    ESP_LOGE(TAG, "Failed to configure interrupts: %d", rslt);
+    this->fail_setup_("interrupt config", rslt);
+    return false;
+  }
+
+  rslt = this->apply_power_save_mode();
+  if (rslt != BMI2_OK) {
+    ESP_LOGE(TAG, "Failed to apply power save mode: %d", rslt);
+    this->fail_setup_("power mode config", rslt);
+    return false;
+  }
+
+  this->is_initialized_ = true;
+  return true;
+}
+
+int8_t BMI270Component::configure_magnetometer_() {
+  bmi2_dev *dev = &this->sensor_;
+  int8_t rslt = bmi2_set_pwr_ctrl(BMI2_PWR_CTRL_AUX_EN | BMI2_PWR_CTRL_ACC_EN | BMI2_PWR_CTRL_GYR_EN |
+                                      BMI2_PWR_CTRL_TEMP_EN, dev);
+  if (rslt != BMI2_OK) return rslt;
+  rslt = bmi2_set_aux_if(this->mag_address_, true, dev);
+  if (rslt != BMI2_OK) return rslt;
+
+  // Suspend to sleep, then check the chip before reading its trim data
+  rslt = bmi2_write_aux_man(BMM150_POWER_CTRL_ADDR, BMM150_POWER_ON, dev);
+  if (rslt != BMI2_OK) return rslt;
+  dev->delay_us(BMM150_STARTUP_US, dev->intf_ptr);
+  uint8_t chip_id = 0;
+  rslt = bmi2_read_aux_man(BMM150_CHIP_ID_ADDR, &chip_id, 1, dev);
+  if (rslt != BMI2_OK) return rslt;
+  if (chip_id != BMM150_CHIP_ID) {
+    ESP_LOGE(TAG, "Unexpected aux chip ID 0x%02X (expected BMM150 0x%02X)", chip_id, BMM150_CHIP_ID);
+    return BMI2_E_COM_FAIL;
+  }
+
+  uint8_t x1y1[2], z4x2y2[4], z2xy1[10];
+  rslt = bmi2_read_aux_man(BMM150_DIG_X1_ADDR, x1y1, sizeof(x1y1), dev);
+  if (rslt == BMI2_OK)
+    rslt = bmi2_read_aux_man(BMM150_DIG_Z4_ADDR, z4x2y2, sizeof(z4x2y2), dev);
+  if (rslt == BMI2_OK)
+    rslt = bmi2_read_aux_man(BMM150_DIG_Z2_ADDR, z2xy1, sizeof(z2xy1), dev);
+  if (rslt != BMI2_OK) return rslt;
+  this->mag_trim_ = bmm150_parse_trim(x1y1, z4x2y2, z2xy1);
+
+  // Regular preset in normal mode, a little faster than the aux ODR so
+  // every aux read sees a fresh sample
+  rslt = bmi2_write_aux_man(BMM150_REP_XY_ADDR, BMM150_REP_XY_REGULAR, dev);
+  if (rslt == BMI2_OK)
+    rslt = bmi2_write_aux_man(BMM150_REP_Z_ADDR, BMM150_REP_Z_REGULAR, dev);
+  if (rslt == BMI2_OK) {
+    uint8_t rate = this->mag_odr_ > BMI2_AUX_ODR_12_5HZ ? BMM150_DATA_RATE_30HZ : BMM150_DATA_RATE_15HZ;
+    rslt = bmi2_write_aux_man(BMM150_OP_MODE_ADDR, rate | BMM150_OP_MODE_NORMAL, dev);
+  }
+  if (rslt != BMI2_OK) return rslt;
+  return bmi2_set_aux_data_mode(this->mag_odr_, BMM150_DATA_ADDR, dev);
+}
+
+void BMI270Component::update_magnetometer_(const uint8_t *aux) {
+  float raw[3];
+  if (!bmm150_compensate(this->mag_trim_, aux, raw))
+    return;
+  // Map BMM150 axes onto the BMI270 frame: +/-(axis index + 1)
+  for (uint8_t i = 0; i < 3; i++) {
+    int8_t axis = this->mag_axes_[i];
+    this->mag_ut_[i] = axis > 0 ? raw[axis - 1] : -raw[-axis - 1];
+  }
+  this->has_mag_ = true;
+}
+
+void BMI270Component::publish_magnetometer_(const ImuSample &sample) {
+  if (!this->has_mag_)
+    return;
+  if (this->mag_x_sensor_ != nullptr)
+    this->mag_x_sensor_->publish_state(this->mag_ut_[0]);
+  if (this->mag_y_sensor_ != nullptr)
+    this->mag_y_sensor_->publish_state(this->mag_ut_[1]);
+  if (this->mag_z_sensor_ != nullptr)
+    this->mag_z_sensor_->publish_state(this->mag_ut_[2]);
+  if (this->heading_sensor_ == nullptr)
+    return;
+
+  // Compass heading is clockwise from magnetic north, the fusion yaw
+  // counterclockwise about +Z
+  float yaw;
+  if (this->fusion_enabled_ && this->fusion_.is_initialized()) {
+    float roll, pitch;
+    this->fusion_.get_euler(&roll, &pitch, &yaw);
+  } else {
+    yaw = tilt_compensated_yaw(sample.acc[0], sample.acc[1], sample.acc[2], this->mag_ut_[0], this->mag_ut_[1],
+                               this->mag_ut_[2]) *
+          RAD_TO_DEG_F;
+  }
+  float heading = -yaw;
+  if (heading < 0.0f)
+    heading += 360.0f;
+  this->heading_sensor_->publish_state(heading);
+}
+
+int8_t BMI270Component::configure_features_() {
+  int8_t rslt;
+  if (this->motion_enabled_) {
+    rslt = bmi2_set_motion_config(BMI2_ANY_MOT_PAGE, BMI2_ANY_MOT_OFFSET, &this->any_motion_cfg_, &this->sensor_);
+    if (rslt != BMI2_OK) return rslt;
+    rslt = bmi2_set_motion_config(BMI2_NO_MOT_PAGE, BMI2_NO_MOT_OFFSET, &this->no_motion_cfg_, &this->sensor_);
+    if (rslt != BMI2_OK) return rslt;
+  }
+  if (this->steps_enabled_()) {
+    rslt = bmi2_set_step_config(&this->step_cfg_, &this->sensor_);
+    if (rslt != BMI2_OK) return rslt;
+  }
+  return BMI2_OK;
+}
+
+int8_t BMI270Component::setup_interrupts_() {
+  const uint8_t io_ctrl = BMI2_INT_IO_OUTPUT_EN | BMI2_INT_IO_ACTIVE_HIGH;
+  int8_t rslt;
+
+  if (this->features_enabled_()) {
+    this->feature_int_pin_ = this->int2_pin_ != nullptr ? this->int2_pin_ : this->int1_pin_;
+    if (this->feature_int_pin_ != nullptr) {
+      uint8_t int_pin = this->feature_int_pin_ == this->int1_pin_ ? BMI2_INT1 : BMI2_INT2;
+      uint8_t feat_map = 0;
+      if (this->motion_enabled_)
+        feat_map |= BMI2_ANY_MOT_INT | BMI2_NO_MOT_INT;
+      if (this->step_cfg_.counter || this->step_cfg_.detector)
+        feat_map |= BMI2_STEP_CNT_INT;
+      if (this->step_cfg_.activity)
+        feat_map |= BMI2_STEP_ACT_INT;
+      rslt = bmi2_set_int_pin_config(int_pin, io_ctrl, &this->sensor_);
+      if (rslt != BMI2_OK) return rslt;
+      rslt = bmi2_map_feat_int(int_pin, feat_map, &this->sensor_);
+      if (rslt != BMI2_OK) return rslt;
+    }
+  }
+
+  // In the power save profiles the sensors are powered per read, so
+  // data-ready would not mean "new data since the last poll"
+  bool polled = this->fifo_mode_ == FIFO_MODE_DISABLED;
+  if (polled && this->power_save_mode_ != POWER_SAVE_MODE_NORMAL)
+    return this->attach_feature_interrupt_();
+  this->data_int_pin_ = this->int1_pin_ != nullptr ? this->int1_pin_ : this->int2_pin_;
+  // A sync_with follower is read on the leader's schedule
+  if (this->sync_leader_ != nullptr)
+    this->data_int_pin_ = nullptr;
+  // A data-ready pulse per sample would bury the motion events on a shared line
+  if (polled && this->data_int_pin_ == this->feature_int_pin_)
+    this->data_int_pin_ = nullptr;
+  if (this->data_int_pin_ == nullptr)
+    return this->attach_feature_interrupt_();
+
+  uint8_t int_pin = this->data_int_pin_ == this->int1_pin_ ? BMI2_INT1 : BMI2_INT2;
+  rslt = bmi2_set_int_pin_config(int_pin, io_ctrl, &this->sensor_);
+  if (rslt != BMI2_OK) return rslt;
+
+  uint8_t int_map = this->fifo_mode_ != FIFO_MODE_DISABLED ? (BMI2_FWM_INT | BMI2_FFULL_INT) : BMI2_DRDY_INT;
+  if (int_pin == BMI2_INT2)
+    int_map <<= 4;
+  rslt = bmi2_map_data_int(int_map, &this->sensor_);
+  if (rslt != BMI2_OK) return rslt;
+
+  this->data_int_pin_->setup();
+  this->data_int_pin_->attach_interrupt(BMI270Component::gpio_intr, this, gpio::INTERRUPT_RISING_EDGE);
+  return this->attach_feature_interrupt_();
+}
+
+int8_t BMI270Component::attach_feature_interrupt_() {
+  // A line shared with the FIFO interrupt is serviced by gpio_intr
+  if (this->feature_int_pin_ == nullptr || this->feature_int_pin_ == this->data_int_pin_)
+    return BMI2_OK;
+  this->feature_int_pin_->setup();
+  this->feature_int_pin_->attach_interrupt(BMI270Component::feature_intr, this, gpio::INTERRUPT_RISING_EDGE);
+  return BMI2_OK;
+}
+
+void IRAM_ATTR BMI270Component::gpio_intr(BMI270Component *arg) {
+  arg->data_irq_ = true;
+  if (arg->feature_int_pin_ == arg->data_int_pin_)
+    BMI270Component::feature_intr(arg);
+}
+
+void IRAM_ATTR BMI270Component::feature_intr(BMI270Component *arg) {
+  if (!arg->feature_irq_)
+    arg->feature_irq_us_ = micros();
+  arg->feature_irq_ = true;
+}
+
+void BMI270Component::handle_feature_status_() {
+  // INT_STATUS_0 clears on read, so all feature events are taken from one read
+  uint8_t int_status = 0;
+  if (bmi2_get_int_status(&int_status, &this->sensor_) != BMI2_OK)
+    return;
+  if (int_status & (BMI2_ANY_MOT_INT | BMI2_NO_MOT_INT))
+    this->handle_motion_(int_status);
+  if (int_status & (BMI2_STEP_CNT_INT | BMI2_STEP_ACT_INT))
+    this->read_step_output_((int_status & BMI2_STEP_CNT_INT) != 0);
+}
+
+void BMI270Component::read_step_output_(bool step_event) {
+  uint32_t step_count;
+  uint8_t activity;
+  if (bmi2_get_step_output(&step_count, &activity, &this->sensor_) != BMI2_OK)
+    return;
+
+#ifdef USE_BINARY_SENSOR
+  // A detector event is a single step; pulse the sensor
+  if (step_event && this->step_detector_binary_sensor_ != nullptr) {
+    this->step_detector_binary_sensor_->publish_state(true);
+    this->step_detector_binary_sensor_->publish_state(false);
+  }
+#endif
+  if (step_count != this->step_count_) {
+    this->step_count_ = step_count;
+    if (this->step_count_sensor_ != nullptr)
+      this->step_count_sensor_->publish_state(step_count);
+  }
+  if (activity != this->step_activity_) {
+    this->step_activity_ = activity;
+#ifdef USE_TEXT_SENSOR
+    static const char *const ACTIVITY_NAMES[] = {"Still", "Walking", "Running", "Unknown"};
+    if (this->activity_text_sensor_ != nullptr)
+      this->activity_text_sensor_->publish_state(ACTIVITY_NAMES[activity]);
+#endif
+  }
+}
+
+void BMI270Component::handle_motion_(uint8_t int_status) {
+  // Both can be pending after a missed poll; the newer one is unknown, so
+  // any-motion wins and the detector re-reports stillness later
+  bool moving = (int_status & BMI2_ANY_MOT_INT) != 0;
+  if (moving == !this->still_ && this->motion_events_ != 0)
+    return;
+  this->still_ = !moving;
+  if (!moving && this->orientation_enabled_)
+    this->settle_screen_orientation_();
+#ifdef USE_BINARY_SENSOR
+  if (this->any_motion_binary_sensor_ != nullptr)
+    this->any_motion_binary_sensor_->publish_state(moving);
+  if (this->no_motion_binary_sensor_ != nullptr)
+    this->no_motion_binary_sensor_->publish_state(!moving);
+#endif
+  this->motion_events_++;
+
+  if (this->feature_int_pin_ != nullptr) {
+    this->motion_latency_us_ = micros() - this->feature_irq_us_;
+    if (this->motion_latency_us_ > this->motion_latency_max_us_)
+      this->motion_latency_max_us_ = this->motion_latency_us_;
+    ESP_LOGD(TAG, "%s, %u us from interrupt", moving ? "Motion" : "No motion", (unsigned) this->motion_latency_us_);
+  } else {
+    ESP_LOGD(TAG, "%s", moving ? "Motion" : "No motion");
+  }
+}
+
+void BMI270Component::loop() {
+  if (this->setup_state_ != SETUP_STATE_READY) {
+    if (!this->setup_waiting_)
+      this->run_setup_step_();
+    return;
+  }
+
+  if (!this->is_initialized_)
+    return;
+  if (this->feature_irq_) {
+    this->feature_irq_ = false;
+    this->handle_feature_status_();
+  }
+
+  // With a watermark interrupt the FIFO is drained as soon as it fills, and
+  // update() only publishes the newest sample
+  if (this->fifo_mode_ == FIFO_MODE_DISABLED || !this->data_irq_)
+    return;
+  this->data_irq_ = false;
+  this->read_fifo_batch_();
+  this->read_followers_();
+  // A failed read can start a recovery, which detaches the pin
+  if (!this->is_initialized_)
+    return;
+  // Frames that arrived during the burst can keep the line above the
+  // watermark, in which case no new rising edge follows
+  if (this->data_int_pin_->digital_read())
+    this->data_irq_ = true;
+}
+
+uint8_t BMI270Component::idle_pwr_ctrl_() const {
+  // The aux interface keeps sampling the magnetometer in every profile
+  uint8_t aux = this->mag_enabled_ ? BMI2_PWR_CTRL_AUX_EN : 0x00;
+  switch (this->power_save_mode_) {
+    case POWER_SAVE_MODE_LOW_POWER:
+    case POWER_SAVE_MODE_GYRO_FAST_START:
+      return aux | BMI2_PWR_CTRL_ACC_EN | BMI2_PWR_CTRL_TEMP_EN;
+    case POWER_SAVE_MODE_SUSPEND:
+      // The feature engine runs on accel data
+      return aux | (this->features_enabled_() ? BMI2_PWR_CTRL_ACC_EN : 0x00);
+    default:
+      return aux | BMI2_PWR_CTRL_ACC_EN | BMI2_PWR_CTRL_GYR_EN | BMI2_PWR_CTRL_TEMP_EN;
+  }
+}
+
+uint8_t BMI270Component::read_pwr_ctrl_() const {
+  uint8_t pwr_ctrl = BMI2_PWR_CTRL_ACC_EN | BMI2_PWR_CTRL_TEMP_EN;
+  if (this->gyro_needed_)
+    pwr_ctrl |= BMI2_PWR_CTRL_GYR_EN;
+  if (this->mag_enabled_)
+    pwr_ctrl |= BMI2_PWR_CTRL_AUX_EN;
+  return pwr_ctrl;
+}
+
+int8_t BMI270Component::apply_power_save_mode() {
+  this->gyro_needed_ = this->gyro_x_sensor_ != nullptr || this->gyro_y_sensor_ != nullptr ||
+                       this->gyro_z_sensor_ != nullptr || this->fusion_enabled_;
+
+  uint8_t pwr_conf = 0x00;
+  if (this->power_save_mode_ != POWER_SAVE_MODE_NORMAL)
+    pwr_conf |= BMI2_PWR_CONF_ADV_POWER_SAVE;
+  if (this->power_save_mode_ == POWER_SAVE_MODE_GYRO_FAST_START)
+    pwr_conf |= BMI2_PWR_CONF_FUP_EN;
+
+  // PWR_CONF goes last: once advanced power save is on, writes are throttled
+  int8_t rslt = bmi2_set_pwr_ctrl(this->idle_pwr_ctrl_(), &this->sensor_);
+  if (rslt != BMI2_OK) return rslt;
+  return bmi2_set_pwr_conf(pwr_conf, &this->sensor_);
+}
+
+void BMI270Component::update() {
+  if (!this->is_initialized_ || this->waking_)
+    return;
+  this->check_health_();
+  if (!this->is_initialized_)
+    return;
+
+  // Without a dedicated line the status is polled; a FIFO watermark level
+  // on a shared line can hide the motion pulse edge
+  if (this->features_enabled_() &&
+      (this->feature_int_pin_ == nullptr || this->feature_int_pin_ == this->data_int_pin_))
+    this->handle_feature_status_();
+  // The step counter interrupts every 20 steps; catch up in between
+  if (this->step_cfg_.counter)
+    this->read_step_output_(false);
+  // Nothing changes while the device lies still; wait for the next
+  // any-motion event
+  if (this->pause_when_still_ && this->still_)
+    return;
+  // Followers are read and published by their leader
+  if (this->sync_leader_ != nullptr)
+    return;
+
+  if (this->fifo_mode_ != FIFO_MODE_DISABLED) {
+    if (this->data_int_pin_ == nullptr) {
+      if (!this->read_fifo_batch_())
+        return;
+      this->read_followers_();
+    }
+    if (this->has_sample_)
+      this->publish_latest_();
+    this->publish_followers_();
+    return;
+  }
+
+  if (this->data_int_pin_ != nullptr) {
+    // Data-ready has not fired since the last read, nothing new to fetch
+    if (!this->data_irq_)
+      return;
+    this->data_irq_ = false;
+  }
+
+  uint8_t pwr_ctrl = this->read_pwr_ctrl_();
+  uint8_t idle_pwr_ctrl = this->idle_pwr_ctrl_();
+  if ((pwr_ctrl & ~idle_pwr_ctrl) == 0) {
+    this->read_and_publish_();
+    return;
+  }
+
+  // Power up what the read needs, wait for the first sample, then drop back
+  // to the idle profile
+  if (bmi2_set_pwr_ctrl(pwr_ctrl, &this->sensor_) != BMI2_OK) {
+    ESP_LOGW(TAG, "Failed to wake sensors");
+    return;
+  }
+  uint32_t wake_ms = ACCEL_WAKE_MS;
+  if ((pwr_ctrl & ~idle_pwr_ctrl) & BMI2_PWR_CTRL_GYR_EN) {
+    wake_ms = this->power_save_mode_ == POWER_SAVE_MODE_GYRO_FAST_START ? GYRO_FAST_START_WAKE_MS : GYRO_WAKE_MS;
+  }
+  // Plus one output period so a fresh sample is in the data registers
+  wake_ms += odr_period_ms(this->accel_odr_);
+  this->waking_ = true;
+  this->set_timeout("wake", wake_ms, [this, idle_pwr_ctrl]() {
+    this->read_and_publish_();
+    if (bmi2_set_pwr_ctrl(idle_pwr_ctrl, &this->sensor_) != BMI2_OK)
+      ESP_LOGW(TAG, "Failed to return sensors to power save");
+    this->waking_ = false;
+  });
+}
+
+void BMI270Component::read_and_publish_() {
+  bool fresh = this->read_sample_();
+  this->read_followers_();
+  if (fresh)
+    this->publish_latest_();
+  this->publish_followers_();
+}
+
+bool BMI270Component::read_sample_() {
+  uint32_t transactions = this->bus_transactions_;
+  bmi2_burst_data burst{};
+  int8_t rslt = bmi2_get_burst_data(&burst, &this->sensor_);
+  // Sensortime is latched when its LSB is read, right at the end of the burst
+  uint32_t read_us = micros();
+  this->record_read_result_(rslt);
+  if (rslt != BMI2_OK) {
+    ESP_LOGW(TAG, "Failed to read sensor data: %d", rslt);
+    return false;
+  }
+  if ((burst.status & (BMI2_DRDY_ACC | BMI2_DRDY_GYR)) == 0) {
+    ESP_LOGV(TAG, "No new data (STATUS=0x%02X)", burst.status);
+    return false;
+  }
+
+  ESP_LOGD(TAG, "Status=0x%02X | Accel: X=%d Y=%d Z=%d | Gyro: X=%d Y=%d Z=%d", burst.status, burst.acc.x,
+           burst.acc.y, burst.acc.z, burst.gyr.x, burst.gyr.y, burst.gyr.z);
+
+  ImuSample sample{};
+  sample.acc[0] = burst.acc.x;
+  sample.acc[1] = burst.acc.y;
+  sample.acc[2] = burst.acc.z;
+  sample.gyr[0] = burst.gyr.x;
+  sample.gyr[1] = burst.gyr.y;
+  sample.gyr[2] = burst.gyr.z;
+  sample.sensortime = burst.sensortime;
+  this->stamp_samples_(&sample, 1, read_us, true);
+  // The aux data registers are refreshed by the chip at the aux ODR
+  if (this->mag_enabled_ && (burst.status & BMI2_DRDY_AUX))
+    this->update_magnetometer_(burst.aux);
+  this->last_sample_ = sample;
+  this->has_sample_ = true;
+  this->process_samples_(&sample, 1);
+  ESP_LOGV(TAG, "Sample cost %u bus transactions", (unsigned) (this->bus_transactions_ - transactions));
+  return true;
+}
+
+void BMI270Component::publish_latest_() {
+  this->publish_sample_(this->last_sample_);
+  this->publish_orientation_();
+  this->publish_temperature_();
+#ifdef USE_BMI270_SPECTRUM
+  this->publish_spectrum_();
+#endif
+}
+
+void BMI270Component::read_followers_() {
+  // Back to back with the leader's own read, so every read in the group
+  // sees the same moment; the publishing happens afterwards
+  uint32_t period_us = FifoParser::odr_to_ticks(this->accel_cfg_.cfg.acc.odr) * 625 / 16;
+  for (BMI270Component *follower = this->sync_next_; follower != nullptr; follower = follower->sync_next_) {
+    if (!follower->is_initialized_ || follower->waking_)
+      continue;
+    bool fresh = follower->fifo_mode_ != FIFO_MODE_DISABLED
+                     ? follower->read_fifo_batch_() && follower->fifo_sample_count_ != 0
+                     : follower->read_sample_();
+    if (!fresh)
+      continue;
+    follower->sync_pending_ = true;
+    if (!this->has_sample_)
+      continue;
+    // Sampling instants of the two free-running ODR clocks, on the local clock
+    follower->sync_skew_us_ = sample_phase_offset_us(this->last_sample_.timestamp_us,
+                                                     follower->last_sample_.timestamp_us, period_us);
+    uint32_t abs_skew = follower->sync_skew_us_ < 0 ? -follower->sync_skew_us_ : follower->sync_skew_us_;
+    if (abs_skew > follower->sync_max_skew_us_)
+      follower->sync_max_skew_us_ = abs_skew;
+  }
+}
+
+void BMI270Component::publish_followers_() {
+  for (BMI270Component *follower = this->sync_next_; follower != nullptr; follower = follower->sync_next_) {
+    if (!follower->sync_pending_)
+      continue;
+    follower->sync_pending_ = false;
+    follower->publish_latest_();
+  }
+}
+
+bool BMI270Component::read_fifo_batch_() {
+  uint16_t fifo_length = 0;
+  int8_t rslt = bmi2_get_fifo_length(&fifo_length, &this->sensor_);
+  this->record_read_result_(rslt);
+  if (rslt != BMI2_OK) {
+    ESP_LOGW(TAG, "Failed to read FIFO length: %d", rslt);
+    return false;
+  }
+  if (fifo_length == 0) {
+    this->fifo_sample_count_ = 0;
+    return true;
+  }
+
+  // Read past the last frame so the chip appends the sensortime frame
+  uint16_t read_len = fifo_length;
+  if (this->fifo_mode_ == FIFO_MODE_HEADER)
+    read_len += 1 + BMI2_FIFO_SENS_TIME_LENGTH;
+  if (read_len > BMI2_FIFO_BUFFER_SIZE)
+    read_len = BMI2_FIFO_BUFFER_SIZE;
+
+  rslt = bmi2_read_fifo_data(this->fifo_buffer_, read_len, &this->sensor_);
+  // The sensortime frame is generated when the read reaches it, at the end
+  uint32_t read_us = micros();
+  this->record_read_result_(rslt);
+  if (rslt != BMI2_OK) {
+    ESP_LOGW(TAG, "Failed to read FIFO data: %d", rslt);
+    return false;
+  }
+
+  uint16_t n = this->fifo_parser_.parse(this->fifo_buffer_, read_len, this->fifo_samples_, BMI2_FIFO_MAX_SAMPLES);
+  if (this->fifo_parser_.has_sensortime()) {
+    FifoParser::assign_sensortime(this->fifo_samples_, n, this->fifo_parser_.get_sensortime(),
+                                  FifoParser::odr_to_ticks(this->accel_cfg_.cfg.acc.odr));
+  }
+  if (this->fifo_parser_.get_skipped_frames() != 0)
+    ESP_LOGW(TAG, "FIFO overflow, %u frames lost", this->fifo_parser_.get_skipped_frames());
+
+  ESP_LOGV(TAG, "FIFO: %u bytes, %u samples", read_len, n);
+  this->fifo_sample_count_ = n;
+  if (n == 0)
+    return true;
+  this->stamp_samples_(this->fifo_samples_, n, read_us, this->fifo_parser_.has_sensortime());
+  if (this->mag_enabled_ && this->fifo_parser_.has_aux())
+    this->update_magnetometer_(this->fifo_parser_.get_aux());
+
+  this->process_samples_(this->fifo_samples_, n);
+
+  this->last_sample_ = this->fifo_samples_[n - 1];
+  this->has_sample_ = true;
+  return true;
+}
+
+void BMI270Component::stamp_samples_(ImuSample *samples, uint16_t n, uint32_t read_us, bool has_sensortime) {
+  if (has_sensortime) {
+    // The newest sample carries the sensortime of the read. The chip
+    // samples on the ODR grid of that counter, so each sample dates from
+    // the last grid point at or before its read-time value
+    this->sensor_clock_.observe(samples[n - 1].sensortime, read_us);
+    const uint32_t grid_mask = ~(FifoParser::odr_to_ticks(this->accel_cfg_.cfg.acc.odr) - 1);
+    for (uint16_t i = 0; i < n; i++) {
+      samples[i].sensortime &= grid_mask;
+      samples[i].timestamp_us = this->sensor_clock_.to_local_us(samples[i].sensortime);
+    }
+    return;
+  }
+  // Headerless FIFO: no sensortime, count back from the read at the ODR
+  uint32_t period_us = FifoParser::odr_to_ticks(this->accel_cfg_.cfg.acc.odr) * 625 / 16;
+  for (uint16_t i = 0; i < n; i++)
+    samples[i].timestamp_us = read_us - (n - 1 - i) * period_us;
+}
+
+void BMI270Component::process_samples_(const ImuSample *samples, uint16_t n) {
+  if (this->bias_model_enabled_)
+    this->update_bias_model_(samples, n);
+  if (this->fusion_enabled_)
+    this->update_fusion_(samples, n);
+  if (this->stats_channels_ != 0)
+    this->update_statistics_(samples, n);
+  if (this->orientation_enabled_)
+    this->update_screen_orientation_(samples, n);
+  if (this->tap_enabled_)
+    this->update_taps_(samples, n);
+#ifdef USE_BMI270_SPECTRUM
+  this->update_spectrum_(samples, n);
+#endif
+#ifdef USE_TEXT_SENSOR
+  if (this->vector_text_sensor_ != nullptr) {
+    for (uint16_t i = 0; i < n; i++)
+      this->append_vector_(samples[i]);
+  }
+#endif
+}
+
+#ifdef USE_BMI270_SPECTRUM
+void BMI270Component::update_spectrum_(const ImuSample *samples, uint16_t n) {
+  if (!this->spectrum_initialized_) {
+    this->spectrum_.init(25600.0f / FifoParser::odr_to_ticks(this->accel_cfg_.cfg.acc.odr));
+    this->spectrum_initialized_ = true;
+  }
+  for (uint16_t i = 0; i < n; i++) {
+    const ImuSample &s = samples[i];
+    float value;
+    if (this->spectrum_axis_ == SPECTRUM_AXIS_MAGNITUDE) {
+      float x = s.acc[0], y = s.acc[1], z = s.acc[2];
+      value = sqrtf(x * x + y * y + z * z);
+    } else {
+      value = s.acc[this->spectrum_axis_];
+    }
+    this->spectrum_.add_sample(value * this->accel_scale_);
+  }
+}
+
+void BMI270Component::publish_spectrum_() {
+  // Less than one block since the last update; keep the previous values
+  if (this->spectrum_.get_blocks() == 0)
+    return;
+  if (this->dominant_frequency_sensor_ != nullptr)
+    this->dominant_frequency_sensor_->publish_state(this->spectrum_.get_dominant_frequency());
+  if (this->peak_amplitude_sensor_ != nullptr)
+    this->peak_amplitude_sensor_->publish_state(this->spectrum_.get_peak_amplitude());
+  for (uint8_t i = 0; i < this->spectrum_band_count_; i++) {
+    const SpectrumBand &band = this->spectrum_bands_[i];
+    band.sensor->publish_state(sqrtf(this->spectrum_.get_band_energy(band.low, band.high)));
+  }
+  this->spectrum_.reset_average();
+}
+#endif
+
+void BMI270Component::update_statistics_(const ImuSample *samples, uint16_t n) {
+  if (this->stats_window_samples_ == 0) {
+    // Window length in samples at the configured ODR
+    float odr_hz = 25600.0f / FifoParser::odr_to_ticks(this->accel_cfg_.cfg.acc.odr);
+    this->stats_window_samples_ = (uint32_t) (this->stats_window_ms_ * odr_hz / 1000.0f);
+    if (this->stats_window_samples_ == 0)
+      this->stats_window_samples_ = 1;
+    for (auto &axis : this->stats_)
+      axis.reset();
+  }
+
+  for (uint16_t i = 0; i < n; i++) {
+    const ImuSample &s = samples[i];
+    const float values[6] = {
+        s.acc[0] * this->accel_scale_,
+        s.acc[1] * this->accel_scale_,
+        s.acc[2] * this->accel_scale_,
+        (s.gyr[0] - this->gyro_bias_x_) * this->gyro_scale_,
+        (s.gyr[1] - this->gyro_bias_y_) * this->gyro_scale_,
+        (s.gyr[2] - this->gyro_bias_z_) * this->gyro_scale_,
+    };
+    for (uint8_t ch = 0; ch < 6; ch++) {
+      if (this->stats_channels_ & (1 << ch))
+        this->stats_[ch].add(values[ch]);
+    }
+    // Every enabled channel sees the same samples, any of them counts
+    uint8_t first = __builtin_ctz(this->stats_channels_);
+    if (this->stats_[first].get_count() >= this->stats_window_samples_)
+      this->publish_statistics_();
+  }
+}
+
+void BMI270Component::publish_statistics_() {
+  for (uint8_t ch = 0; ch < 6; ch++) {
+    if (!(this->stats_channels_ & (1 << ch)))
+      continue;
+    for (uint8_t stat = 0; stat < STATISTIC_COUNT; stat++) {
+      sensor::Sensor *sens = this->stats_sensors_[ch][stat];
+      if (sens != nullptr)
+        sens->publish_state(this->stats_[ch].get((WindowStatistic) stat));
+    }
+    this->stats_[ch].reset();
+  }
+}
+
+void BMI270Component::update_screen_orientation_(const ImuSample *samples, uint16_t n) {
+  // The batch mean is gravity plus whatever shaking averaged out; one
+  // classification per batch instead of per sample
+  int32_t sum[3] = {0, 0, 0};
+  for (uint16_t i = 0; i < n; i++) {
+    sum[0] += samples[i].acc[0];
+    sum[1] += samples[i].acc[1];
+    sum[2] += samples[i].acc[2];
+  }
+  if (this->orientation_detector_.update(sum[0], sum[1], sum[2], millis()))
+    this->report_screen_orientation_();
+}
+
+void BMI270Component::update_taps_(const ImuSample *samples, uint16_t n) {
+  for (uint16_t i = 0; i < n; i++) {
+    TapEvent event = this->tap_detector_.update(samples[i].acc);
+    if (event == TAP_EVENT_NONE)
+      continue;
+    uint32_t latency_us = micros() - samples[i].timestamp_us;
+    if (latency_us > this->tap_latency_max_us_)
+      this->tap_latency_max_us_ = latency_us;
+    ESP_LOGD(TAG, "%s, %u us after the sample", event == TAP_EVENT_DOUBLE ? "Double tap" : "Tap",
+             (unsigned) latency_us);
+    if (event == TAP_EVENT_DOUBLE)
+      this->double_tap_callback_.call();
+    else
+      this->tap_callback_.call();
+  }
+}
+
+void BMI270Component::settle_screen_orientation_() {
+  // The no-motion detector has already waited for the device to come to
+  // rest, so this one reading is final and skips the hold time
+  uint8_t data[6];
+  if (bmi2_get_regs(BMI2_ACC_DATA_ADDR, data, sizeof(data), &this->sensor_) != BMI2_OK)
+    return;
+  int16_t x = (int16_t) (data[1] << 8 | data[0]);
+  int16_t y = (int16_t) (data[3] << 8 | data[2]);
+  int16_t z = (int16_t) (data[5] << 8 | data[4]);
+  if (this->orientation_detector_.settle(x, y, z))
+    this->report_screen_orientation_();
+}
+
+void BMI270Component::report_screen_orientation_() {
+  Orientation orientation = this->orientation_detector_.get_orientation();
+  ESP_LOGD(TAG, "Orientation: %s", orientation_to_string(orientation));
+#ifdef USE_TEXT_SENSOR
+  if (this->orientation_text_sensor_ != nullptr)
+    this->orientation_text_sensor_->publish_state(orientation_to_string(orientation));
+#endif
+  this->orientation_callback_.call(orientation);
+}
+
+void BMI270Component::update_bias_model_(const ImuSample *samples, uint16_t n) {
+  if (isnan(this->temperature_))
+    return;
+  // The any-motion detector knows better than a single window
+  if (this->motion_enabled_ && !this->still_)
+    return;
+  for (uint16_t i = 0; i < n; i++)
+    this->bias_model_.add_sample(samples[i].gyr, samples[i].acc, this->temperature_);
+
+  if (this->bias_model_.is_dirty() && millis() - this->bias_saved_ms_ > BIAS_SAVE_INTERVAL_MS)
+    this->save_bias_model_();
+}
+
+void BMI270Component::apply_bias_model_() {
+  float bias[3];
+  if (!this->bias_model_.get_bias(this->temperature_, bias))
+    return;
+  this->gyro_bias_x_ = lroundf(bias[0]);
+  this->gyro_bias_y_ = lroundf(bias[1]);
+  this->gyro_bias_z_ = lroundf(bias[2]);
+}
+
+void BMI270Component::save_bias_model_() {
+  // Flash writes are rate limited by the caller; the table changes slowly
+  this->bias_saved_ms_ = millis();
+  this->bias_model_.clear_dirty();
+  if (!this->bias_pref_.save(&this->bias_model_.get_table()))
+    ESP_LOGW(TAG, "Failed to store gyro bias table");
+}
+
+void BMI270Component::on_shutdown() {
+  if (this->bias_model_enabled_ && this->bias_model_.is_dirty())
+    this->save_bias_model_();
+}
+
+void BMI270Component::update_fusion_(const ImuSample *samples, uint16_t n) {
+  // Drift-corrected once the sensor clock has locked
+  const float tick_s = this->sensor_clock_.is_locked() ? this->sensor_clock_.get_tick_s() : SENSORTIME_TICK_S;
+  const float period_s = FifoParser::odr_to_ticks(this->accel_cfg_.cfg.acc.odr) * tick_s;
+  const float gyro_scale = this->gyro_scale_ * DEG_TO_RAD_F;
+  // Polled, the gap between samples is the poll itself, not lost samples
+  float max_dt_s = FUSION_MAX_DT_S;
+  if (this->fifo_mode_ == FIFO_MODE_DISABLED) {
+    const float poll_s = 2.0f * this->get_update_interval() / 1000.0f;
+    max_dt_s = poll_s > max_dt_s ? poll_s : max_dt_s;
+  }
+
+  for (uint16_t i = 0; i < n; i++) {
+    const ImuSample &s = samples[i];
+    float dt = period_s;
+    if (s.sensortime != 0 && this->fusion_sensortime_ != 0) {
+      dt = ((s.sensortime - this->fusion_sensortime_) & BMI2_SENSORTIME_MASK) * tick_s;
+      if (dt <= 0.0f || dt > max_dt_s)
+        dt = period_s;
+    }
+    this->fusion_sensortime_ = s.sensortime;
+
+    float gx = (s.gyr[0] - this->gyro_bias_x_) * gyro_scale;
+    float gy = (s.gyr[1] - this->gyro_bias_y_) * gyro_scale;
+    float gz = (s.gyr[2] - this->gyro_bias_z_) * gyro_scale;
+    if (this->has_mag_) {
+      // The newest magnetometer reading is held across the batch
+      this->fusion_.update_marg(gx, gy, gz, s.acc[0], s.acc[1], s.acc[2], this->mag_ut_[0], this->mag_ut_[1],
+                                this->mag_ut_[2], dt);
+    } else {
+      this->fusion_.update_imu(gx, gy, gz, s.acc[0], s.acc[1], s.acc[2], dt);
+    }
+  }
+}
+
+void BMI270Component::publish_orientation_() {
+  if (!this->fusion_enabled_ || !this->fusion_.is_initialized())
+    return;
+
+  if (this->quaternion_w_sensor_ != nullptr)
+    this->quaternion_w_sensor_->publish_state(this->fusion_.get_w());
+  if (this->quaternion_x_sensor_ != nullptr)
+    this->quaternion_x_sensor_->publish_state(this->fusion_.get_x());
+  if (this->quaternion_y_sensor_ != nullptr)
+    this->quaternion_y_sensor_->publish_state(this->fusion_.get_y());
+  if (this->quaternion_z_sensor_ != nullptr)
+    this->quaternion_z_sensor_->publish_state(this->fusion_.get_z());
+
+  float roll, pitch, yaw;
+  this->fusion_.get_euler(&roll, &pitch, &yaw);
+  if (this->roll_sensor_ != nullptr)
+    this->roll_sensor_->publish_state(roll);
+  if (this->pitch_sensor_ != nullptr)
+    this->pitch_sensor_->publish_state(pitch);
+  if (this->yaw_sensor_ != nullptr)
+    this->yaw_sensor_->publish_state(yaw);
+}
+
+void BMI270Component::publish_sample_(const ImuSample &sample) {
+  if (this->first_sample_ms_ == 0) {
+    this->first_sample_ms_ = millis();
+    ESP_LOGI(TAG, "First sample %u ms after boot, %u ms after setup start", (unsigned) this->first_sample_ms_,
+             (unsigned) (this->first_sample_ms_ - this->setup_start_ms_));
+  }
+  this->publish_gated_(PUBLISH_CHANNEL_ACCEL_X, this->accel_x_sensor_, sample.acc[0] * this->accel_scale_);
+  this->publish_gated_(PUBLISH_CHANNEL_ACCEL_Y, this->accel_y_sensor_, sample.acc[1] * this->accel_scale_);
+  this->publish_gated_(PUBLISH_CHANNEL_ACCEL_Z, this->accel_z_sensor_, sample.acc[2] * this->accel_scale_);
+
+  // Gyroscope output in °/s (degrees per second), with bias correction
+  this->publish_gated_(PUBLISH_CHANNEL_GYRO_X, this->gyro_x_sensor_,
+                       (sample.gyr[0] - this->gyro_bias_x_) * this->gyro_scale_);
+  this->publish_gated_(PUBLISH_CHANNEL_GYRO_Y, this->gyro_y_sensor_,
+                       (sample.gyr[1] - this->gyro_bias_y_) * this->gyro_scale_);
+  this->publish_gated_(PUBLISH_CHANNEL_GYRO_Z, this->gyro_z_sensor_,
+                       (sample.gyr[2] - this->gyro_bias_z_) * this->gyro_scale_);
+#ifdef USE_TEXT_SENSOR
+  if (this->vector_text_sensor_ != nullptr)
+    this->flush_vectors_();
+#endif
+  this->publish_magnetometer_(sample);
+  this->publish_counters_();
+  this->publish_timing_(sample);
+}
+
+void BMI270Component::publish_timing_(const ImuSample &sample) {
+  // Sample to publish, covering FIFO buffering and loop latency
+  if (this->sample_latency_sensor_ != nullptr)
+    this->sample_latency_sensor_->publish_state((micros() - sample.timestamp_us) / 1000.0f);
+  if (!this->sensor_clock_.is_locked())
+    return;
+  if (this->timestamp_jitter_sensor_ != nullptr)
+    this->timestamp_jitter_sensor_->publish_state(this->sensor_clock_.get_jitter_us());
+  if (this->clock_drift_sensor_ != nullptr)
+    this->clock_drift_sensor_->publish_state(this->sensor_clock_.get_drift_ppm());
+  if (this->sync_skew_sensor_ != nullptr && this->sync_leader_ != nullptr &&
+      this->sync_leader_->sensor_clock_.is_locked())
+    this->sync_skew_sensor_->publish_state(this->sync_skew_us_);
+}
+
+#ifdef USE_TEXT_SENSOR
+void BMI270Component::append_vector_(const ImuSample &sample) {
+  const bool accel = this->vector_fields_ != VECTOR_FIELDS_GYRO;
+  const bool gyro = this->vector_fields_ != VECTOR_FIELDS_ACCEL;
+  const int16_t gyr[3] = {
+      (int16_t) clamp<int32_t>(sample.gyr[0] - this->gyro_bias_x_, INT16_MIN, INT16_MAX),
+      (int16_t) clamp<int32_t>(sample.gyr[1] - this->gyro_bias_y_, INT16_MIN, INT16_MAX),
+      (int16_t) clamp<int32_t>(sample.gyr[2] - this->gyro_bias_z_, INT16_MIN, INT16_MAX),
+  };
+
+  if (this->vector_encoding_ == VECTOR_ENCODING_BASE64) {
+    // 3 bytes sensortime + up to 6 x int16, records back to back
+    uint8_t record[3 + 12];
+    uint8_t len = 0;
+    record[len++] = sample.sensortime & 0xFF;
+    record[len++] = (sample.sensortime >> 8) & 0xFF;
+    record[len++] = (sample.sensortime >> 16) & 0xFF;
+    for (uint8_t i = 0; accel && i < 3; i++) {
+      record[len++] = (uint16_t) sample.acc[i] & 0xFF;
+      record[len++] = (uint16_t) sample.acc[i] >> 8;
+    }
+    for (uint8_t i = 0; gyro && i < 3; i++) {
+      record[len++] = (uint16_t) gyr[i] & 0xFF;
+      record[len++] = (uint16_t) gyr[i] >> 8;
+    }
+    if (this->vector_len_ + len > VECTOR_MAX_RAW_LEN)
+      this->flush_vectors_();
+    memcpy(this->vector_buffer_ + this->vector_len_, record, len);
+    this->vector_len_ += len;
+  } else {
+    // sensortime,ax,ay,az,gx,gy,gz in m/s² and °/s, records separated by ';'
+    char record[96];
+    int len = snprintf(record, sizeof(record), "%u", (unsigned) sample.sensortime);
+    for (uint8_t i = 0; accel && i < 3; i++)
+      len += snprintf(record + len, sizeof(record) - len, ",%.3f", sample.acc[i] * this->accel_scale_);
+    for (uint8_t i = 0; gyro && i < 3; i++)
+      len += snprintf(record + len, sizeof(record) - len, ",%.2f", gyr[i] * this->gyro_scale_);
+    if (this->vector_len_ != 0 && this->vector_len_ + 1 + len > VECTOR_MAX_STATE_LEN)
+      this->flush_vectors_();
+    if (this->vector_len_ != 0)
+      this->vector_buffer_[this->vector_len_++] = ';';
+    memcpy(this->vector_buffer_ + this->vector_len_, record, len);
+    this->vector_len_ += len;
+  }
+}
+
+void BMI270Component::flush_vectors_() {
+  if (this->vector_len_ == 0)
+    return;
+  if (this->vector_encoding_ == VECTOR_ENCODING_BASE64) {
+    this->vector_text_sensor_->publish_state(base64_encode((const uint8_t *) this->vector_buffer_, this->vector_len_));
+  } else {
+    this->vector_text_sensor_->publish_state(std::string(this->vector_buffer_, this->vector_len_));
+  }
+  this->vector_len_ = 0;
+  this->publishes_emitted_++;
+}
+#endif
+
+void BMI270Component::publish_gated_(PublishChannel channel, sensor::Sensor *sens, float value) {
+  if (sens == nullptr)
+    return;
+  // Decided before publish_state() so a suppressed value costs no filter,
+  // log or API work
+  PublishGate &gate = this->publish_gates_[channel];
+  uint32_t now = millis();
+  if (gate.published) {
+    uint32_t elapsed = now - gate.last_ms;
+    bool expired = gate.max_interval_ms != 0 && elapsed >= gate.max_interval_ms;
+    bool changed = gate.deadband <= 0.0f || fabsf(value - gate.last_value) > gate.deadband ||
+                   isnan(value) != isnan(gate.last_value);
+    if ((gate.min_interval_ms != 0 && elapsed < gate.min_interval_ms) || (!changed && !expired)) {
+      this->publishes_suppressed_++;
+      return;
+    }
+  }
+  gate.published = true;
+  gate.last_value = value;
+  gate.last_ms = now;
+  this->publishes_emitted_++;
+  sens->publish_state(value);
+}
+
+void BMI270Component::publish_counters_() {
+  if (this->publishes_emitted_sensor_ == nullptr && this->publishes_suppressed_sensor_ == nullptr)
+    return;
+  uint32_t now = millis();
+  if (this->publishes_reported_ != UINT32_MAX && now - this->counters_published_ms_ < COUNTERS_INTERVAL_MS)
+    return;
+  uint32_t total = this->publishes_emitted_ + this->publishes_suppressed_;
+  if (total == this->publishes_reported_)
+    return;
+  this->publishes_reported_ = total;
+  this->counters_published_ms_ = now;
+  if (this->publishes_emitted_sensor_ != nullptr)
+    this->publishes_emitted_sensor_->publish_state(this->publishes_emitted_);
+  if (this->publishes_suppressed_sensor_ != nullptr)
+    this->publishes_suppressed_sensor_->publish_state(this->publishes_suppressed_);
+}
+
+void BMI270Component::publish_temperature_() {
+  if (this->temperature_sensor_ == nullptr && !this->bias_model_enabled_)
+    return;
+  uint32_t now = millis();
+  if (this->last_temperature_ms_ != 0 && now - this->last_temperature_ms_ < TEMPERATURE_INTERVAL_MS)
+    return;
+
+  // Temperature: Registers 0x22 (LSB) and 0x23 (MSB)
+  // Resolution: 1/512 °C/LSB, with 0x0000 = 23°C
+  int16_t temp_raw;
+  int8_t rslt = bmi2_get_temperature(&temp_raw, &this->sensor_);
+  this->record_read_result_(rslt);
+  if (rslt == BMI2_OK) {
+    this->last_temperature_ms_ = now;
+    this->temperature_ = (temp_raw / 512.0f) + 23.0f;
+    if (this->bias_model_enabled_)
+      this->apply_bias_model_();
+    this->publish_gated_(PUBLISH_CHANNEL_TEMPERATURE, this->temperature_sensor_, this->temperature_);
+  }
+}
+
+void BMI270Component::dump_config() {
+  ESP_LOGCONFIG(TAG, "BMI270:");
+  this->dump_bus_config_();
+  const BMI270Diagnostics &diag = this->diagnostics_;
+  if (diag.failed_step != nullptr) {
+    ESP_LOGE(TAG, "  Setup failed at %s after %u ms: error %d", diag.failed_step, (unsigned) diag.setup_ms,
+             diag.error);
+    if (diag.snapshot_valid) {
+      ESP_LOGE(TAG, "  STATUS=0x%02X INTERNAL_STATUS=0x%02X PWR_CTRL=0x%02X PWR_CONF=0x%02X", diag.status,
+               diag.internal_status, diag.pwr_ctrl, diag.pwr_conf);
+      ESP_LOGE(TAG, "  ACC_CONF=0x%02X ACC_RANGE=0x%02X GYR_CONF=0x%02X GYR_RANGE=0x%02X", diag.acc_conf,
+               diag.acc_range, diag.gyr_conf, diag.gyr_range);
+    } else {
+      ESP_LOGE(TAG, "  Register snapshot unavailable");
+    }
+  } else if (diag.setup_ms != 0) {
+    ESP_LOGCONFIG(TAG, "  Setup: INIT_OK after %u ms, ready after %u ms", (unsigned) diag.init_ms,
+                  (unsigned) diag.setup_ms);
+  }
+  LOG_SENSOR("  ", "Setup Time", this->setup_time_sensor_);
+  LOG_SENSOR("  ", "Setup Error", this->setup_error_sensor_);
+  ESP_LOGCONFIG(TAG, "  Health: %u re-initialization attempts, %u read errors", (unsigned) this->recoveries_,
+                (unsigned) this->read_errors_);
+  LOG_SENSOR("  ", "Recoveries", this->recoveries_sensor_);
+  ESP_LOGCONFIG(TAG, "  Accel: ODR code 0x%02X, range ±%ug, bandwidth %u", this->accel_odr_, 2u << this->accel_range_,
+                this->accel_bandwidth_);
+  ESP_LOGCONFIG(TAG, "  Gyro: ODR code 0x%02X, range ±%u°/s, bandwidth %u", this->gyro_odr_,
+                2000u >> this->gyro_range_, this->gyro_bandwidth_);
+  ESP_LOGCONFIG(TAG, "  Filter mode: %s", this->performance_mode_ ? "performance" : "power optimized");
+  if (this->motion_enabled_) {
+    ESP_LOGCONFIG(TAG, "  Any-motion: threshold %u, duration %u ms", this->any_motion_cfg_.threshold,
+                  this->any_motion_cfg_.duration * 20u);
+    ESP_LOGCONFIG(TAG, "  No-motion: threshold %u, duration %u ms", this->no_motion_cfg_.threshold,
+                  this->no_motion_cfg_.duration * 20u);
+    ESP_LOGCONFIG(TAG, "  Motion events: %u, interrupt latency %u us (max %u us)", (unsigned) this->motion_events_,
+                  (unsigned) this->motion_latency_us_, (unsigned) this->motion_latency_max_us_);
+#ifdef USE_BINARY_SENSOR
+    LOG_BINARY_SENSOR("  ", "Any Motion", this->any_motion_binary_sensor_);
+    LOG_BINARY_SENSOR("  ", "No Motion", this->no_motion_binary_sensor_);
+#endif
+  }
+  if (this->steps_enabled_()) {
+    LOG_SENSOR("  ", "Step Count", this->step_count_sensor_);
+#ifdef USE_BINARY_SENSOR
+    LOG_BINARY_SENSOR("  ", "Step Detector", this->step_detector_binary_sensor_);
+#endif
+#ifdef USE_TEXT_SENSOR
+    LOG_TEXT_SENSOR("  ", "Activity", this->activity_text_sensor_);
+#endif
+  }
+#ifdef USE_TEXT_SENSOR
+  LOG_TEXT_SENSOR("  ", "Vector", this->vector_text_sensor_);
+#endif
+  if (this->tap_enabled_) {
+    ESP_LOGCONFIG(TAG, "  Taps: %.2f g, %u ms shock, %u ms quiet, double-tap window %u ms", this->tap_threshold_g_,
+                  (unsigned) this->tap_duration_ms_, (unsigned) this->tap_quiet_ms_,
+                  this->double_tap_enabled_ ? (unsigned) this->double_tap_window_ms_ : 0u);
+    ESP_LOGCONFIG(TAG, "  Taps detected: %u, rejected as motion: %u, max latency %u us",
+                  (unsigned) this->tap_detector_.get_taps(), (unsigned) this->tap_detector_.get_rejected(),
+                  (unsigned) this->tap_latency_max_us_);
+  }
+  if (this->orientation_enabled_) {
+    ESP_LOGCONFIG(TAG, "  Screen orientation: %s (flat within %.0f°, hysteresis %.0f°, hold %u ms)",
+                  orientation_to_string(this->orientation_detector_.get_orientation()),
+                  this->orientation_detector_.get_flat_angle(), this->orientation_detector_.get_hysteresis(),
+                  (unsigned) this->orientation_detector_.get_hold_time());
+#ifdef USE_TEXT_SENSOR
+    LOG_TEXT_SENSOR("  ", "Orientation", this->orientation_text_sensor_);
+#endif
+  }
+  if (this->features_enabled_())
+    LOG_PIN("  Feature interrupt pin: ", this->feature_int_pin_);
+  if (this->calibration_.gyr_valid) {
+    const bmi2_offsets &off = this->calibration_.offsets;
+    ESP_LOGCONFIG(TAG, "  Gyro offsets: %d %d %d (x0.061 °/s)", off.gyr[0], off.gyr[1], off.gyr[2]);
+    if (this->calibration_.acc_valid)
+      ESP_LOGCONFIG(TAG, "  Accel offsets: %d %d %d (x3.9 mg)", off.acc[0], off.acc[1], off.acc[2]);
+  } else {
+    ESP_LOGCONFIG(TAG, "  Offsets: not calibrated");
+  }
+  if (this->stats_channels_ != 0) {
+    ESP_LOGCONFIG(TAG, "  Statistics: %u ms windows (%u samples)", (unsigned) this->stats_window_ms_,
+                  (unsigned) this->stats_window_samples_);
+  }
+#ifdef USE_BMI270_SPECTRUM
+  static const char *const SPECTRUM_AXIS_NAMES[] = {"X", "Y", "Z", "magnitude"};
+  ESP_LOGCONFIG(TAG, "  Spectrum: accel %s, %u-point FFT, %u bands", SPECTRUM_AXIS_NAMES[this->spectrum_axis_],
+                SpectrumAnalyzer::SIZE, this->spectrum_band_count_);
+#endif
+  if (this->bias_model_enabled_) {
+    ESP_LOGCONFIG(TAG, "  Gyro bias model: %u of %u bins learned, %u observations",
+                  this->bias_model_.get_learned_bins(), BIAS_TABLE_BINS, (unsigned) this->bias_model_.get_observations());
+  }
+  if (this->mag_enabled_) {
+    static const char *const MAG_AXES[] = {"-Z", "-Y", "-X", "", "X", "Y", "Z"};
+    ESP_LOGCONFIG(TAG, "  Magnetometer: BMM150 at 0x%02X on AUX, ODR code 0x%02X, axes %s %s %s", this->mag_address_,
+                  this->mag_odr_, MAG_AXES[this->mag_axes_[0] + 3], MAG_AXES[this->mag_axes_[1] + 3],
+                  MAG_AXES[this->mag_axes_[2] + 3]);
+    LOG_SENSOR("  ", "Mag X", this->mag_x_sensor_);
+    LOG_SENSOR("  ", "Mag Y", this->mag_y_sensor_);
+    LOG_SENSOR("  ", "Mag Z", this->mag_z_sensor_);
+    LOG_SENSOR("  ", "Heading", this->heading_sensor_);
+  }
+  if (this->sensor_clock_.has_reference()) {
+    ESP_LOGCONFIG(TAG, "  Sensor clock: %s, drift %.0f ppm, jitter %u us (max %u), %u resyncs",
+                  this->sensor_clock_.is_locked() ? "locked" : "locking", this->sensor_clock_.get_drift_ppm(),
+                  (unsigned) this->sensor_clock_.get_jitter_us(), (unsigned) this->sensor_clock_.get_max_jitter_us(),
+                  (unsigned) this->sensor_clock_.get_resyncs());
+  }
+  if (this->sync_leader_ != nullptr) {
+    ESP_LOGCONFIG(TAG, "  Synchronized: read by the leader, sample skew %d us (max %u)", (int) this->sync_skew_us_,
+                  (unsigned) this->sync_max_skew_us_);
+    LOG_SENSOR("  ", "Sync Skew", this->sync_skew_sensor_);
+  } else if (this->sync_next_ != nullptr) {
+    ESP_LOGCONFIG(TAG, "  Synchronized: group leader");
+  }
+  ESP_LOGCONFIG(TAG, "  Publishes: %u emitted, %u suppressed", (unsigned) this->publishes_emitted_,
+                (unsigned) this->publishes_suppressed_);
+  static const char *const POWER_SAVE_NAMES[] = {"normal", "low power", "gyro fast start", "suspend"};
+  ESP_LOGCONFIG(TAG, "  Power save: %s", POWER_SAVE_NAMES[this->power_save_mode_]);
+  ESP_LOGCONFIG(TAG, "  Receiving data: %s", this->has_sample_ ? "Yes" : "No");
+  ESP_LOGCONFIG(TAG, "  Initialized: %s", this->is_initialized_ ? "Yes" : "No");
+  if (this->first_sample_ms_ != 0) {
+    ESP_LOGCONFIG(TAG, "  First sample: %u ms after boot", (unsigned) this->first_sample_ms_);
+  }
+  if (this->fifo_mode_ != FIFO_MODE_DISABLED) {
+    ESP_LOGCONFIG(TAG, "  FIFO: %s mode, watermark %u samples",
+                  this->fifo_mode_ == FIFO_MODE_HEADER ? "header" : "headerless", this->fifo_watermark_);
+  }
+  ESP_LOGCONFIG(TAG, "  Config upload: %u ms, %u transactions, %u byte chunks (%u retries)",
+                (unsigned) this->upload_time_ms_, (unsigned) this->upload_transactions_, this->upload_chunk_size_,
+                this->upload_retries_);
+  ESP_LOGCONFIG(TAG, "  Bus: %u transactions, %u bytes", (unsigned) this->bus_transactions_,
+                (unsigned) this->bus_bytes_);
+  if (this->fusion_enabled_) {
+    ESP_LOGCONFIG(TAG, "  Orientation fusion: Madgwick, beta=%.3f", this->fusion_.get_beta());
+  }
+  LOG_PIN("  INT1 Pin: ", this->int1_pin_);
+  LOG_PIN("  INT2 Pin: ", this->int2_pin_);
+}
+
+float BMI270Component::get_setup_priority() const {
+  return setup_priority::DATA;
+}
+
+int8_t BMI270Component::read_bytes(uint8_t reg_addr, uint8_t *data, uint32_t len, void *intf_ptr) {
+  auto *component = reinterpret_cast<BMI270Component *>(intf_ptr);
+  component->bus_transactions_++;
+  component->bus_bytes_ += len;
+  return component->bus_read_(reg_addr, data, len);
+}
+
+int8_t BMI270Component::write_bytes(uint8_t reg_addr, const uint8_t *data, uint32_t len, void *intf_ptr) {
+  auto *component = reinterpret_cast<BMI270Component *>(intf_ptr);
+  component->bus_transactions_++;
+  component->bus_bytes_ += len;
+  return component->bus_write_(reg_addr, data, len);
+}
+
+void BMI270Component::delay_usec(uint32_t period, void *) {
+  delay_microseconds_safe(period);
+}
+
+#ifdef USE_I2C
+int8_t BMI270I2CComponent::bus_read_(uint8_t reg_addr, uint8_t *data, uint32_t len) {
+  if (this->read_register(reg_addr, data, len) != i2c::ERROR_OK) {
+    return BMI2_E_COM_FAIL;
+  }
+  return BMI2_OK;
+}
+
+int8_t BMI270I2CComponent::bus_write_(uint8_t reg_addr, const uint8_t *data, uint32_t len) {
+  if (this->write_register(reg_addr, data, len) != i2c::ERROR_OK) {
+    return BMI2_E_COM_FAIL;
+  }
+  return BMI2_OK;
+}
+
+void BMI270I2CComponent::dump_bus_config_() { LOG_I2C_DEVICE(this); }
+#endif
+
+}  // namespace bmi270
+}  // namespace esphome
@@ -1,144 +1,695 @@
-#pragma once
-
-#include "esphome/core/component.h"
-#include "esphome/components/sensor/sensor.h"
-#include "esphome/components/i2c/i2c.h"
-#include "esphome/core/hal.h"
-
-// BMI270 API type definitions and constants
-#define BMI2_OK 0
-#define BMI2_E_COM_FAIL 1
-#define BMI2_E_CONFIG_LOAD 2
-
-#define BMI2_I2C_INTF 0
-#define BMI2_ACCEL 0
-#define BMI2_GYRO 1
-
-#define BMI2_ACC_ODR_100HZ 0x08
-#define BMI2_ACC_RANGE_2G 0x00
-#define BMI2_ACC_NORMAL_AVG4 0x01
-#define BMI2_PERF_OPT_MODE 0x00
-
-#define BMI2_GYR_ODR_100HZ 0x08
-#define BMI2_GYR_RANGE_2000 0x04
-#define BMI2_GYR_NORMAL_MODE 0x00
-#define BMI2_POWER_OPT_MODE 0x00
-
-namespace esphome {
-namespace bmi270 {
-
-// Forward declarations for BMI270 API structures
-struct bmi2_dev {
-  uint8_t chip_id;
-  uint8_t intf;
-  void *intf_ptr;
-  int8_t (*read)(uint8_t reg_addr, uint8_t *data, uint32_t len, void *intf_ptr);
-  int8_t (*write)(uint8_t reg_addr, const uint8_t *data, uint32_t len, void *intf_ptr);
-  void (*delay_us)(uint32_t period, void *intf_ptr);
-};
-
-struct bmi2_accel_config {
-  uint8_t odr;
-  uint8_t range;
-  uint8_t bw;
-  uint8_t perf_mode;
-};
-
-struct bmi2_gyro_config {
-  uint8_t odr;
-  uint8_t range;
-  uint8_t bw;
-  uint8_t noise_perf;
-  uint8_t filter_perf;
-};
-
-struct bmi2_sens_config {
-  uint8_t type;
-  union {
-    bmi2_accel_config acc;
-    bmi2_gyro_config gyr;
-  } cfg;
-};
-
-struct bmi2_sens_axes_data {
-  int16_t x;
-  int16_t y;
-  int16_t z;
-};
-
-struct bmi2_sensor_data {
-  uint8_t type;
-  union {
-    bmi2_sens_axes_data acc;
-    bmi2_sens_axes_data gyr;
-  } sens_data;
-};
-
-// BMI270 API function declarations
-int8_t bmi270_init(bmi2_dev *dev);
-int8_t bmi270_sensor_enable(const uint8_t *sens_list, uint8_t n_sens, bmi2_dev *dev);
-int8_t bmi270_set_sensor_config(bmi2_sens_config *sens_cfg, uint8_t n_sens, bmi2_dev *dev);
-int8_t bmi2_get_sensor_data(bmi2_sensor_data *sensor_data, uint8_t n_sens, bmi2_dev *dev);
-
-// Power save mode enumeration
-enum PowerSaveMode {
-  POWER_SAVE_MODE_NORMAL = 0,
-  POWER_SAVE_MODE_LOW_POWER = 1,
-  // POWER_SAVE_MODE_PERFORMANCE = 2, // Optional
-};
-
-class BMI270Component : public PollingComponent, public i2c::I2CDevice {
- public:
-  void setup() override;
-  void dump_config() override;
-  void update() override;
-  float get_setup_priority() const override;
-
-  void set_accel_x_sensor(sensor::Sensor *accel_x_sensor) { accel_x_sensor_ = accel_x_sensor; }
-  void set_accel_y_sensor(sensor::Sensor *accel_y_sensor) { accel_y_sensor_ = accel_y_sensor; }
-  void set_accel_z_sensor(sensor::Sensor *accel_z_sensor) { accel_z_sensor_ = accel_z_sensor; }
-  void set_temperature_sensor(sensor::Sensor *temperature_sensor) { temperature_sensor_ = temperature_sensor; }
-  void set_gyro_x_sensor(sensor::Sensor *gyro_x_sensor) { gyro_x_sensor_ = gyro_x_sensor; }
-  void set_gyro_y_sensor(sensor::Sensor *gyro_y_sensor) { gyro_y_sensor_ = gyro_y_sensor; }
-  void set_gyro_z_sensor(sensor::Sensor *gyro_z_sensor) { gyro_z_sensor_ = gyro_z_sensor; }
-  
-  void set_power_save_mode(PowerSaveMode mode) { power_save_mode_ = mode; }
-
- protected:
-  bool bmi270_init_config_file();
-  void apply_power_save_mode();
-
-  // Static callback functions for BMI270 API
-  static int8_t read_bytes(uint8_t reg_addr, uint8_t *data, uint32_t len, void *intf_ptr);
-  static int8_t write_bytes(uint8_t reg_addr, const uint8_t *data, uint32_t len, void *intf_ptr);
-  static void delay_usec(uint32_t period, void *intf_ptr);
-
-  sensor::Sensor *accel_x_sensor_{nullptr};
-  sensor::Sensor *accel_y_sensor_{nullptr};
-  sensor::Sensor *accel_z_sensor_{nullptr};
-  sensor::Sensor *temperature_sensor_{nullptr};
-  sensor::Sensor *gyro_x_sensor_{nullptr};
-  sensor::Sensor *gyro_y_sensor_{nullptr};
-  sensor::Sensor *gyro_z_sensor_{nullptr};
-
-  float accel_sensitivity_{0.0f};
-  float gyro_sensitivity_{0.0f};
-  PowerSaveMode power_save_mode_{POWER_SAVE_MODE_NORMAL};
-  bool sensors_active_{false};
-
-  // Gyroscope bias calibration values (in LSB)
-  int16_t gyro_bias_x_{0};
-  int16_t gyro_bias_y_{0};
-  int16_t gyro_bias_z_{0};
-
-  // BMI270 device structure and configuration
-  bmi2_dev sensor_{};
-  bmi2_sens_config accel_cfg_{};
-  bmi2_sens_config gyro_cfg_{};
-  bool is_initialized_{false};
-
-  std::string failure_reason_{""};
-};
-
-}  // namespace bmi270
+#pragma once
+
+#include "esphome/core/automation.h"
+#include "esphome/core/component.h"
+#include "esphome/components/sensor/sensor.h"
+#ifdef USE_I2C
+#include "esphome/components/i2c/i2c.h"
+#endif
+#ifdef USE_BINARY_SENSOR
+#include "esphome/components/binary_sensor/binary_sensor.h"
+#endif
+#ifdef USE_TEXT_SENSOR
+#include "esphome/components/text_sensor/text_sensor.h"
+#endif
+#ifdef USE_BUTTON
+#include "esphome/components/button/button.h"
+#endif
+#include "esphome/core/hal.h"
+#include "esphome/core/gpio.h"
+#include "esphome/core/preferences.h"
+#include "bmi270_api.h"
+#include "bmi270_bias.h"
+#include "bmi270_bmm150.h"
+#include "bmi270_clock.h"
+#include "bmi270_fifo.h"
+#include "bmi270_fusion.h"
+#include "bmi270_orientation.h"
+#include "bmi270_stats.h"
+#include "bmi270_tap.h"
+#ifdef USE_BMI270_SPECTRUM
+#include "bmi270_fft.h"
+#endif
+
+#include <math.h>
+
+namespace esphome {
+namespace bmi270 {
+
+// Conversion factors per range code, resolved at compile time. Each step up
+// in the ACC_RANGE code doubles the g range; each step up in GYR_RANGE
+// halves the dps range.
+constexpr int32_t accel_lsb_per_g(uint8_t range) { return 16384 >> range; }
+constexpr float accel_range_scale(uint8_t range) {
+  return 9.80665f / (float) accel_lsb_per_g(range);  // LSB to m/s²
+}
+constexpr float gyro_range_scale(uint8_t range) {
+  return 1.0f / (16.4f * (float) (1 << range));  // LSB to °/s
+}
+static_assert(accel_lsb_per_g(BMI2_ACC_RANGE_2G) == 16384, "±2g is 16384 LSB/g");
+static_assert(accel_range_scale(BMI2_ACC_RANGE_16G) == 9.80665f / 2048.0f, "±16g is 2048 LSB/g");
+static_assert(gyro_range_scale(BMI2_GYR_RANGE_125) == 1.0f / 262.4f, "±125°/s is 262.4 LSB/°/s");
+
+// Power save mode enumeration
+enum PowerSaveMode {
+  POWER_SAVE_MODE_NORMAL = 0,
+  // Accel in low-power averaging mode, gyro suspended between reads,
+  // advanced power save enabled
+  POWER_SAVE_MODE_LOW_POWER = 1,
+  // As LOW_POWER, but the gyro idles in fast start-up for quick wake-ups
+  POWER_SAVE_MODE_GYRO_FAST_START = 2,
+  // Accel and gyro suspended between reads
+  POWER_SAVE_MODE_SUSPEND = 3,
+};
+
+// Accel channel fed to the spectrum stage
+enum SpectrumAxis : uint8_t {
+  SPECTRUM_AXIS_X = 0,
+  SPECTRUM_AXIS_Y,
+  SPECTRUM_AXIS_Z,
+  SPECTRUM_AXIS_MAGNITUDE,
+};
+#define BMI2_MAX_SPECTRUM_BANDS 8
+
+// Axes packed into one vector record
+enum VectorFields : uint8_t {
+  VECTOR_FIELDS_ACCEL = 0,
+  VECTOR_FIELDS_GYRO,
+  VECTOR_FIELDS_ACCEL_GYRO,
+};
+
+// Vector record encoding: CSV of SI values, or base64 of the packed raw
+// little-endian record (24-bit sensortime, then int16 counts per axis)
+enum VectorEncoding : uint8_t {
+  VECTOR_ENCODING_CSV = 0,
+  VECTOR_ENCODING_BASE64,
+};
+
+// Raw outputs that go through the publish gate
+enum PublishChannel : uint8_t {
+  PUBLISH_CHANNEL_ACCEL_X = 0,
+  PUBLISH_CHANNEL_ACCEL_Y,
+  PUBLISH_CHANNEL_ACCEL_Z,
+  PUBLISH_CHANNEL_GYRO_X,
+  PUBLISH_CHANNEL_GYRO_Y,
+  PUBLISH_CHANNEL_GYRO_Z,
+  PUBLISH_CHANNEL_TEMPERATURE,
+  PUBLISH_CHANNEL_COUNT,
+};
+
+// Publish-on-change limits for one output. A deadband of 0 publishes every
+// value; intervals of 0 are unlimited.
+struct PublishGate {
+  float deadband;
+  uint32_t min_interval_ms;
+  uint32_t max_interval_ms;
+  float last_value;
+  uint32_t last_ms;
+  bool published;
+};
+
+// Non-blocking bring-up steps, advanced from loop()
+enum SetupState : uint8_t {
+  SETUP_STATE_PREPARE = 0,
+  SETUP_STATE_UPLOAD,
+  SETUP_STATE_WAIT_INIT,
+  SETUP_STATE_CONFIGURE,
+  SETUP_STATE_CRT,
+  SETUP_STATE_CALIBRATE,
+  SETUP_STATE_READY,
+  // Waiting out the backoff after a failure, then re-initializing
+  SETUP_STATE_RECOVER,
+};
+
+// Bring-up record, fixed size so a failing boot allocates nothing. The
+// register snapshot is only read when a step fails; dump_config() formats it.
+struct BMI270Diagnostics {
+  const char *failed_step;  // nullptr while setup succeeds
+  int8_t error;             // BMI2_* result of the failed step
+  bool snapshot_valid;
+  uint8_t status;
+  uint8_t internal_status;
+  uint8_t acc_conf;
+  uint8_t acc_range;
+  uint8_t gyr_conf;
+  uint8_t gyr_range;
+  uint8_t pwr_conf;
+  uint8_t pwr_ctrl;
+  uint32_t init_ms;   // setup start to INIT_OK
+  uint32_t setup_ms;  // setup start to ready or failure
+};
+
+// Calibration result kept in preferences so later boots skip FOC
+struct BMI270Calibration {
+  bmi2_offsets offsets;
+  bool acc_valid;
+  bool gyr_valid;
+};
+
+class BMI270Component : public PollingComponent {
+ public:
+  void setup() override;
+  void dump_config() override;
+  void update() override;
+  void loop() override;
+  void on_shutdown() override;
+  float get_setup_priority() const override;
+
+  void set_accel_x_sensor(sensor::Sensor *accel_x_sensor) { accel_x_sensor_ = accel_x_sensor; }
+  void set_accel_y_sensor(sensor::Sensor *accel_y_sensor) { accel_y_sensor_ = accel_y_sensor; }
+  void set_accel_z_sensor(sensor::Sensor *accel_z_sensor) { accel_z_sensor_ = accel_z_sensor; }
+  void set_temperature_sensor(sensor::Sensor *temperature_sensor) { temperature_sensor_ = temperature_sensor; }
+  void set_gyro_x_sensor(sensor::Sensor *gyro_x_sensor) { gyro_x_sensor_ = gyro_x_sensor; }
+  void set_gyro_y_sensor(sensor::Sensor *gyro_y_sensor) { gyro_y_sensor_ = gyro_y_sensor; }
+  void set_gyro_z_sensor(sensor::Sensor *gyro_z_sensor) { gyro_z_sensor_ = gyro_z_sensor; }
+  void set_roll_sensor(sensor::Sensor *roll_sensor) { roll_sensor_ = roll_sensor; fusion_enabled_ = true; }
+  void set_pitch_sensor(sensor::Sensor *pitch_sensor) { pitch_sensor_ = pitch_sensor; fusion_enabled_ = true; }
+  void set_yaw_sensor(sensor::Sensor *yaw_sensor) { yaw_sensor_ = yaw_sensor; fusion_enabled_ = true; }
+  void set_quaternion_w_sensor(sensor::Sensor *sens) { quaternion_w_sensor_ = sens; fusion_enabled_ = true; }
+  void set_publish_limits(PublishChannel channel, float deadband, uint32_t min_interval_ms,
+                          uint32_t max_interval_ms) {
+    publish_gates_[channel].deadband = deadband;
+    publish_gates_[channel].min_interval_ms = min_interval_ms;
+    publish_gates_[channel].max_interval_ms = max_interval_ms;
+  }
+  void set_timestamp_jitter_sensor(sensor::Sensor *sens) { timestamp_jitter_sensor_ = sens; }
+  void set_clock_drift_sensor(sensor::Sensor *sens) { clock_drift_sensor_ = sens; }
+  void set_sample_latency_sensor(sensor::Sensor *sens) { sample_latency_sensor_ = sens; }
+  // Read this instance right after the leader's reads instead of on its own
+  // timer; followers are chained behind the leader in config order
+  void set_sync_leader(BMI270Component *leader) {
+    BMI270Component *tail = leader;
+    while (tail->sync_next_ != nullptr)
+      tail = tail->sync_next_;
+    tail->sync_next_ = this;
+    sync_prev_ = tail;
+    sync_leader_ = leader;
+  }
+  void set_sync_skew_sensor(sensor::Sensor *sens) { sync_skew_sensor_ = sens; }
+  void set_setup_time_sensor(sensor::Sensor *sens) { setup_time_sensor_ = sens; }
+  void set_setup_error_sensor(sensor::Sensor *sens) { setup_error_sensor_ = sens; }
+  void set_recoveries_sensor(sensor::Sensor *sens) { recoveries_sensor_ = sens; }
+  // Local micros() at which the last published sample was taken
+  uint32_t get_last_sample_timestamp_us() const { return last_sample_.timestamp_us; }
+  const SensorClock &get_sensor_clock() const { return sensor_clock_; }
+  void set_publishes_emitted_sensor(sensor::Sensor *sens) { publishes_emitted_sensor_ = sens; }
+  void set_publishes_suppressed_sensor(sensor::Sensor *sens) { publishes_suppressed_sensor_ = sens; }
+  void set_quaternion_x_sensor(sensor::Sensor *sens) { quaternion_x_sensor_ = sens; fusion_enabled_ = true; }
+  void set_quaternion_y_sensor(sensor::Sensor *sens) { quaternion_y_sensor_ = sens; fusion_enabled_ = true; }
+  void set_quaternion_z_sensor(sensor::Sensor *sens) { quaternion_z_sensor_ = sens; fusion_enabled_ = true; }
+  void set_fusion_beta(float beta) { fusion_.set_beta(beta); }
+  void set_orientation_config(float flat_angle, float hysteresis, uint32_t hold_ms) {
+    orientation_detector_.configure(flat_angle, hysteresis, hold_ms);
+  }
+  // Called only when the debounced screen orientation changes
+  void add_on_orientation_callback(std::function<void(Orientation)> &&callback) {
+    orientation_callback_.add(std::move(callback));
+    orientation_enabled_ = true;
+  }
+  Orientation get_orientation() const { return orientation_detector_.get_orientation(); }
+  void set_tap_config(float threshold_g, uint32_t duration_ms, uint32_t quiet_ms, uint32_t double_tap_window_ms) {
+    tap_threshold_g_ = threshold_g;
+    tap_duration_ms_ = duration_ms;
+    tap_quiet_ms_ = quiet_ms;
+    double_tap_window_ms_ = double_tap_window_ms;
+  }
+  // With a double-tap callback, single taps wait out the double-tap window
+  void add_on_tap_callback(std::function<void()> &&callback) {
+    tap_callback_.add(std::move(callback));
+    tap_enabled_ = true;
+  }
+  void add_on_double_tap_callback(std::function<void()> &&callback) {
+    double_tap_callback_.add(std::move(callback));
+    tap_enabled_ = true;
+    double_tap_enabled_ = true;
+  }
+  void set_magnetometer(uint8_t address, uint8_t odr) {
+    mag_address_ = address;
+    mag_odr_ = odr;
+    mag_enabled_ = true;
+  }
+  // Source of each BMI270 axis as +/-(BMM150 axis index + 1)
+  void set_magnetometer_axes(int8_t x, int8_t y, int8_t z) {
+    mag_axes_[0] = x;
+    mag_axes_[1] = y;
+    mag_axes_[2] = z;
+  }
+  void set_mag_x_sensor(sensor::Sensor *sens) { mag_x_sensor_ = sens; }
+  void set_mag_y_sensor(sensor::Sensor *sens) { mag_y_sensor_ = sens; }
+  void set_mag_z_sensor(sensor::Sensor *sens) { mag_z_sensor_ = sens; }
+  void set_heading_sensor(sensor::Sensor *sens) { heading_sensor_ = sens; }
+  
+  void set_power_save_mode(PowerSaveMode mode) { power_save_mode_ = mode; }
+  void set_accel_odr(uint8_t odr) { accel_odr_ = odr; }
+  void set_accel_range(uint8_t range) {
+    accel_range_ = range;
+    accel_scale_ = accel_range_scale(range);
+  }
+  void set_accel_bandwidth(uint8_t bandwidth) { accel_bandwidth_ = bandwidth; }
+  void set_accel_averaging(uint8_t averaging) { accel_averaging_ = averaging; }
+  void set_gyro_odr(uint8_t odr) { gyro_odr_ = odr; }
+  void set_gyro_range(uint8_t range) {
+    gyro_range_ = range;
+    gyro_scale_ = gyro_range_scale(range);
+  }
+  void set_gyro_bandwidth(uint8_t bandwidth) { gyro_bandwidth_ = bandwidth; }
+  void set_performance_mode(bool performance) { performance_mode_ = performance; }
+  void set_fifo_mode(FifoMode mode) { fifo_mode_ = mode; }
+  void set_fifo_watermark(uint16_t samples) { fifo_watermark_ = samples; }
+  void set_config_burst_size(uint16_t size) { config_burst_size_ = size; }
+  void set_int1_pin(InternalGPIOPin *int1_pin) { int1_pin_ = int1_pin; }
+  void set_int2_pin(InternalGPIOPin *int2_pin) { int2_pin_ = int2_pin; }
+#ifdef USE_BINARY_SENSOR
+  void set_any_motion_binary_sensor(binary_sensor::BinarySensor *sens) { any_motion_binary_sensor_ = sens; }
+  void set_no_motion_binary_sensor(binary_sensor::BinarySensor *sens) { no_motion_binary_sensor_ = sens; }
+#endif
+  void set_any_motion_config(uint16_t threshold, uint16_t duration) {
+    any_motion_cfg_.threshold = threshold;
+    any_motion_cfg_.duration = duration;
+    motion_enabled_ = true;
+  }
+  void set_no_motion_config(uint16_t threshold, uint16_t duration) {
+    no_motion_cfg_.threshold = threshold;
+    no_motion_cfg_.duration = duration;
+    motion_enabled_ = true;
+  }
+  void set_pause_when_still(bool pause) { pause_when_still_ = pause; }
+  void set_accel_calibration(bool enable) { accel_calibration_ = enable; }
+  void set_gyro_crt(bool enable) { gyro_crt_ = enable; }
+  void set_gyro_bias_model(bool enable) { bias_model_enabled_ = enable; }
+  // Channels 0-2 accel x/y/z, 3-5 gyro x/y/z
+  void set_statistics_window(uint32_t window_ms) { stats_window_ms_ = window_ms; }
+  void set_statistics_sensor(uint8_t channel, WindowStatistic statistic, sensor::Sensor *sens) {
+    stats_sensors_[channel][statistic] = sens;
+    stats_channels_ |= 1 << channel;
+  }
+
+#ifdef USE_BMI270_SPECTRUM
+  void set_spectrum_axis(SpectrumAxis axis) { spectrum_axis_ = axis; }
+  void set_dominant_frequency_sensor(sensor::Sensor *sens) { dominant_frequency_sensor_ = sens; }
+  void set_peak_amplitude_sensor(sensor::Sensor *sens) { peak_amplitude_sensor_ = sens; }
+  void add_spectrum_band(float low, float high, sensor::Sensor *sens) {
+    if (spectrum_band_count_ < BMI2_MAX_SPECTRUM_BANDS)
+      spectrum_bands_[spectrum_band_count_++] = {low, high, sens};
+  }
+#endif
+
+  // Run FOC (and CRT if enabled) again and persist the new offsets. The
+  // device must lie still, flat with +Z up when accel calibration is on.
+  void recalibrate();
+  void set_step_count_sensor(sensor::Sensor *sens) {
+    step_count_sensor_ = sens;
+    step_cfg_.counter = true;
+  }
+#ifdef USE_BINARY_SENSOR
+  void set_step_detector_binary_sensor(binary_sensor::BinarySensor *sens) {
+    step_detector_binary_sensor_ = sens;
+    step_cfg_.detector = true;
+  }
+#endif
+#ifdef USE_TEXT_SENSOR
+  void set_activity_text_sensor(text_sensor::TextSensor *sens) {
+    activity_text_sensor_ = sens;
+    step_cfg_.activity = true;
+  }
+  void set_vector_text_sensor(text_sensor::TextSensor *sens) { vector_text_sensor_ = sens; }
+  void set_orientation_text_sensor(text_sensor::TextSensor *sens) {
+    orientation_text_sensor_ = sens;
+    orientation_enabled_ = true;
+  }
+  void set_vector_fields(VectorFields fields) { vector_fields_ = fields; }
+  void set_vector_encoding(VectorEncoding encoding) { vector_encoding_ = encoding; }
+#endif
+
+ protected:
+  bool bmi270_init_config_file();
+  void run_setup_step_();
+  void setup_wait_(uint32_t ms);
+  void fail_setup_(const char *step, int8_t error);
+  void finish_setup_();
+  // Health monitoring: repeated read errors or a lost INIT_OK re-run the
+  // bring-up with backoff, reusing the cached configuration and offsets
+  void start_recovery_(const char *reason);
+  void record_read_result_(int8_t rslt);
+  void check_health_();
+  void snapshot_registers_();
+  void publish_diagnostics_();
+  bool configure_sensors_();
+  void start_calibration_();
+  bool finish_calibration_();
+  bool apply_offsets_();
+  bool start_acquisition_();
+  // FIFO watermark in bytes for fifo_watermark_ samples in the current frame layout
+  uint16_t fifo_watermark_bytes_() const;
+  int8_t apply_power_save_mode();
+  uint8_t idle_pwr_ctrl_() const;
+  uint8_t read_pwr_ctrl_() const;
+  void read_and_publish_();
+  bool read_sample_();
+  bool read_fifo_batch_();
+  void publish_latest_();
+  // Shared acquisition schedule of a sync_with group, run by the leader
+  void read_followers_();
+  void publish_followers_();
+  void process_samples_(const ImuSample *samples, uint16_t n);
+  void update_fusion_(const ImuSample *samples, uint16_t n);
+  void publish_sample_(const ImuSample &sample);
+  int8_t configure_magnetometer_();
+  void update_magnetometer_(const uint8_t *aux);
+  void publish_magnetometer_(const ImuSample &sample);
+  void publish_gated_(PublishChannel channel, sensor::Sensor *sens, float value);
+  void publish_counters_();
+  void stamp_samples_(ImuSample *samples, uint16_t n, uint32_t read_us, bool has_sensortime);
+  void publish_timing_(const ImuSample &sample);
+  void publish_orientation_();
+  void publish_temperature_();
+  void update_bias_model_(const ImuSample *samples, uint16_t n);
+  void update_statistics_(const ImuSample *samples, uint16_t n);
+  void update_screen_orientation_(const ImuSample *samples, uint16_t n);
+  void update_taps_(const ImuSample *samples, uint16_t n);
+  void settle_screen_orientation_();
+  void report_screen_orientation_();
+#ifdef USE_BMI270_SPECTRUM
+  void update_spectrum_(const ImuSample *samples, uint16_t n);
+  void publish_spectrum_();
+#endif
+  void publish_statistics_();
+  void apply_bias_model_();
+  void save_bias_model_();
+  int8_t setup_interrupts_();
+  int8_t configure_features_();
+  int8_t attach_feature_interrupt_();
+  void handle_feature_status_();
+  void handle_motion_(uint8_t int_status);
+  void read_step_output_(bool step_event);
+  bool steps_enabled_() const { return this->step_cfg_.counter || this->step_cfg_.detector || this->step_cfg_.activity; }
+  bool features_enabled_() const { return this->motion_enabled_ || this->steps_enabled_(); }
+
+  static void gpio_intr(BMI270Component *arg);
+  static void feature_intr(BMI270Component *arg);
+
+  // Transport hooks implemented by the I2C and SPI variants. Everything else
+  // reaches the bus only through sensor_.read/write, which lead here.
+  virtual int8_t bus_read_(uint8_t reg_addr, uint8_t *data, uint32_t len) = 0;
+  virtual int8_t bus_write_(uint8_t reg_addr, const uint8_t *data, uint32_t len) = 0;
+  virtual uint8_t bus_interface_() const = 0;
+  // Distinguishes several sensors in the preference keys
+  virtual uint32_t bus_preference_key_() const = 0;
+  virtual void dump_bus_config_() = 0;
+
+  // Static callback functions for BMI270 API
+  static int8_t read_bytes(uint8_t reg_addr, uint8_t *data, uint32_t len, void *intf_ptr);
+  static int8_t write_bytes(uint8_t reg_addr, const uint8_t *data, uint32_t len, void *intf_ptr);
+  static void delay_usec(uint32_t period, void *intf_ptr);
+
+  sensor::Sensor *accel_x_sensor_{nullptr};
+  sensor::Sensor *accel_y_sensor_{nullptr};
+  sensor::Sensor *accel_z_sensor_{nullptr};
+  sensor::Sensor *temperature_sensor_{nullptr};
+  sensor::Sensor *gyro_x_sensor_{nullptr};
+  sensor::Sensor *gyro_y_sensor_{nullptr};
+  sensor::Sensor *gyro_z_sensor_{nullptr};
+  sensor::Sensor *publishes_emitted_sensor_{nullptr};
+  sensor::Sensor *publishes_suppressed_sensor_{nullptr};
+  PublishGate publish_gates_[PUBLISH_CHANNEL_COUNT]{};
+  uint32_t publishes_emitted_{0};
+  uint32_t publishes_suppressed_{0};
+  uint32_t publishes_reported_{UINT32_MAX};
+  uint32_t counters_published_ms_{0};
+  sensor::Sensor *roll_sensor_{nullptr};
+  sensor::Sensor *pitch_sensor_{nullptr};
+  sensor::Sensor *yaw_sensor_{nullptr};
+  sensor::Sensor *quaternion_w_sensor_{nullptr};
+  sensor::Sensor *quaternion_x_sensor_{nullptr};
+  sensor::Sensor *quaternion_y_sensor_{nullptr};
+  sensor::Sensor *quaternion_z_sensor_{nullptr};
+
+  // Output data rate, range and filter settings (register codes)
+  uint8_t accel_odr_{BMI2_ACC_ODR_100HZ};
+  uint8_t accel_range_{BMI2_ACC_RANGE_2G};
+  uint8_t accel_bandwidth_{BMI2_ACC_NORMAL_AVG4};
+  uint8_t accel_averaging_{BMI2_ACC_NORMAL_AVG4};
+  uint8_t gyro_odr_{BMI2_GYR_ODR_100HZ};
+  uint8_t gyro_range_{BMI2_GYR_RANGE_2000};
+  uint8_t gyro_bandwidth_{BMI2_GYR_NORMAL_MODE};
+  bool performance_mode_{true};
+  // LSB to output unit for the selected ranges; one multiply on the hot path
+  float accel_scale_{accel_range_scale(BMI2_ACC_RANGE_2G)};
+  float gyro_scale_{gyro_range_scale(BMI2_GYR_RANGE_2000)};
+  PowerSaveMode power_save_mode_{POWER_SAVE_MODE_NORMAL};
+  bool gyro_needed_{false};
+  bool waking_{false};
+
+  // Hardware offset compensation (FOC/CRT), persisted across boots
+  bool accel_calibration_{false};
+  bool gyro_crt_{false};
+  BMI270Calibration calibration_{};
+  ESPPreferenceObject calibration_pref_;
+
+  // Residual gyro bias learned against temperature while still; feeds
+  // gyro_bias_* whenever the temperature is read
+  bool bias_model_enabled_{false};
+  BiasEstimator bias_model_;
+  ESPPreferenceObject bias_pref_;
+  uint32_t bias_saved_ms_{0};
+  float temperature_{NAN};
+
+  // Gyroscope bias calibration values (in LSB)
+  int16_t gyro_bias_x_{0};
+  int16_t gyro_bias_y_{0};
+  int16_t gyro_bias_z_{0};
+
+  // BMI270 device structure and configuration
+  bmi2_dev sensor_{};
+  bmi2_sens_config accel_cfg_{};
+  bmi2_sens_config gyro_cfg_{};
+  bool is_initialized_{false};
+
+  // Setup state machine
+  SetupState setup_state_{SETUP_STATE_PREPARE};
+  bool setup_waiting_{false};
+  uint16_t upload_index_{0};
+
+  // Config upload strategy and instrumentation
+  uint16_t config_burst_size_{256};
+  uint16_t upload_chunk_size_{0};
+  uint8_t upload_retries_{0};
+  uint32_t upload_start_ms_{0};
+  uint32_t upload_start_transactions_{0};
+  uint32_t upload_time_ms_{0};
+  uint32_t upload_transactions_{0};
+  uint8_t init_polls_{0};
+  uint8_t calibration_count_{0};
+  uint8_t calibration_attempts_{0};
+  int32_t calibration_sum_[6]{};
+  int16_t calibration_min_[6]{};
+  int16_t calibration_max_[6]{};
+  uint16_t crt_polls_{0};
+  bool recalibrating_{false};
+  bool recovering_{false};
+  // Set once the first bring-up has finished; a recovery only takes the
+  // short path when calibration_ holds the offsets it established
+  bool setup_complete_{false};
+  uint8_t consecutive_errors_{0};
+  uint32_t recovery_backoff_ms_{0};
+  uint32_t recoveries_{0};
+  uint32_t read_errors_{0};
+  uint32_t last_health_check_ms_{0};
+  sensor::Sensor *recoveries_sensor_{nullptr};
+  uint32_t setup_start_ms_{0};
+  uint32_t first_sample_ms_{0};
+
+  // Bus accounting for everything that goes through the bmi2_dev callbacks
+  uint32_t bus_transactions_{0};
+  uint32_t bus_bytes_{0};
+  uint32_t last_temperature_ms_{0};
+
+  // FIFO streaming
+  FifoMode fifo_mode_{FIFO_MODE_DISABLED};
+  FifoParser fifo_parser_;
+  uint8_t fifo_buffer_[BMI2_FIFO_BUFFER_SIZE];
+  ImuSample fifo_samples_[BMI2_FIFO_MAX_SAMPLES];
+  uint16_t fifo_sample_count_{0};
+  uint16_t fifo_watermark_{16};
+  ImuSample last_sample_{};
+
+  // Sensortime to micros() mapping, observed with every read that carries
+  // a sensortime
+  SensorClock sensor_clock_;
+  sensor::Sensor *timestamp_jitter_sensor_{nullptr};
+  sensor::Sensor *clock_drift_sensor_{nullptr};
+  sensor::Sensor *sample_latency_sensor_{nullptr};
+  bool has_sample_{false};
+
+  // sync_with group: the leader reads every follower right after itself
+  BMI270Component *sync_leader_{nullptr};
+  BMI270Component *sync_prev_{nullptr};
+  BMI270Component *sync_next_{nullptr};
+  sensor::Sensor *sync_skew_sensor_{nullptr};
+  bool sync_pending_{false};
+  int32_t sync_skew_us_{0};
+  uint32_t sync_max_skew_us_{0};
+
+  // Windowed statistics over every sample; only the aggregates are published
+  uint32_t stats_window_ms_{1000};
+  uint32_t stats_window_samples_{0};
+  uint8_t stats_channels_{0};
+  AxisStatistics stats_[6];
+  sensor::Sensor *stats_sensors_[6][STATISTIC_COUNT]{};
+
+#ifdef USE_BMI270_SPECTRUM
+  // Accel spectrum, averaged over the blocks completed between updates
+  struct SpectrumBand {
+    float low;
+    float high;
+    sensor::Sensor *sensor;
+  };
+  SpectrumAxis spectrum_axis_{SPECTRUM_AXIS_Z};
+  bool spectrum_initialized_{false};
+  SpectrumAnalyzer spectrum_;
+  sensor::Sensor *dominant_frequency_sensor_{nullptr};
+  sensor::Sensor *peak_amplitude_sensor_{nullptr};
+  SpectrumBand spectrum_bands_[BMI2_MAX_SPECTRUM_BANDS]{};
+  uint8_t spectrum_band_count_{0};
+#endif
+
+  // BMM150 behind the aux interface: the chip reads it autonomously into
+  // the burst registers and FIFO, so it costs no extra bus transactions
+  bool mag_enabled_{false};
+  uint8_t mag_address_{BMM150_DEFAULT_ADDRESS};
+  uint8_t mag_odr_{BMI2_AUX_ODR_25HZ};
+  int8_t mag_axes_[3]{1, 2, 3};
+  Bmm150Trim mag_trim_{};
+  float mag_ut_[3]{};
+  bool has_mag_{false};
+  sensor::Sensor *mag_x_sensor_{nullptr};
+  sensor::Sensor *mag_y_sensor_{nullptr};
+  sensor::Sensor *mag_z_sensor_{nullptr};
+  sensor::Sensor *heading_sensor_{nullptr};
+
+  // Orientation fusion, fed with every sample
+  bool fusion_enabled_{false};
+  MadgwickFilter fusion_;
+  uint32_t fusion_sensortime_{0};
+
+  // Screen orientation, classified once per batch from its mean and once
+  // more from a single accel read when the no-motion detector fires, so a
+  // device left at rest reports without any further reads
+  bool orientation_enabled_{false};
+  OrientationDetector orientation_detector_;
+  CallbackManager<void(Orientation)> orientation_callback_;
+#ifdef USE_TEXT_SENSOR
+  text_sensor::TextSensor *orientation_text_sensor_{nullptr};
+#endif
+
+  // Tap detection on every FIFO sample; thresholds are converted to LSB and
+  // samples at the configured range and ODR during setup
+  bool tap_enabled_{false};
+  bool double_tap_enabled_{false};
+  float tap_threshold_g_{1.0f};
+  uint32_t tap_duration_ms_{50};
+  uint32_t tap_quiet_ms_{50};
+  uint32_t double_tap_window_ms_{300};
+  TapDetector tap_detector_;
+  CallbackManager<void()> tap_callback_;
+  CallbackManager<void()> double_tap_callback_;
+  // Sample to callback, the part of the response time spent on the host
+  uint32_t tap_latency_max_us_{0};
+
+  // Interrupt routing: the data interrupt (FIFO watermark or data-ready)
+  // goes to INT1 when wired, otherwise INT2
+  InternalGPIOPin *int1_pin_{nullptr};
+  InternalGPIOPin *int2_pin_{nullptr};
+  InternalGPIOPin *data_int_pin_{nullptr};
+  volatile bool data_irq_{false};
+
+  // Any-/no-motion detection in the feature engine. Feature interrupts go to
+  // INT2 when wired, otherwise INT1; without a pin INT_STATUS_0 is polled.
+#ifdef USE_BINARY_SENSOR
+  binary_sensor::BinarySensor *any_motion_binary_sensor_{nullptr};
+  binary_sensor::BinarySensor *no_motion_binary_sensor_{nullptr};
+#endif
+  bool motion_enabled_{false};
+  bmi2_motion_config any_motion_cfg_{5, 0xAA, 0x07, true};
+  bmi2_motion_config no_motion_cfg_{5, 0x90, 0x07, true};
+  bool pause_when_still_{false};
+  bool still_{false};
+  InternalGPIOPin *feature_int_pin_{nullptr};
+  volatile bool feature_irq_{false};
+  volatile uint32_t feature_irq_us_{0};
+  // Interrupt edge to published state
+  uint32_t motion_latency_us_{0};
+  uint32_t motion_latency_max_us_{0};
+  uint32_t motion_events_{0};
+
+  // Step counter, detector and activity recognition in the feature engine,
+  // sharing the feature interrupt line; outputs are published on change
+  sensor::Sensor *step_count_sensor_{nullptr};
+#ifdef USE_BINARY_SENSOR
+  binary_sensor::BinarySensor *step_detector_binary_sensor_{nullptr};
+#endif
+#ifdef USE_TEXT_SENSOR
+  text_sensor::TextSensor *activity_text_sensor_{nullptr};
+#endif
+  bmi2_step_config step_cfg_{1, false, false, false};
+  uint32_t step_count_{UINT32_MAX};
+  uint8_t step_activity_{0xFF};
+
+#ifdef USE_TEXT_SENSOR
+  // One packed record per sample instead of a publish per axis; the records
+  // of a batch are collected and published several to a state
+  void append_vector_(const ImuSample &sample);
+  void flush_vectors_();
+  text_sensor::TextSensor *vector_text_sensor_{nullptr};
+  char vector_buffer_[256];
+  uint16_t vector_len_{0};
+  VectorFields vector_fields_{VECTOR_FIELDS_ACCEL_GYRO};
+  VectorEncoding vector_encoding_{VECTOR_ENCODING_CSV};
+#endif
+
+  BMI270Diagnostics diagnostics_{};
+  sensor::Sensor *setup_time_sensor_{nullptr};
+  sensor::Sensor *setup_error_sensor_{nullptr};
+};
+
+#ifdef USE_I2C
+class BMI270I2CComponent : public BMI270Component, public i2c::I2CDevice {
+ protected:
+  int8_t bus_read_(uint8_t reg_addr, uint8_t *data, uint32_t len) override;
+  int8_t bus_write_(uint8_t reg_addr, const uint8_t *data, uint32_t len) override;
+  uint8_t bus_interface_() const override { return BMI2_I2C_INTF; }
+  uint32_t bus_preference_key_() const override { return this->address_; }
+  void dump_bus_config_() override;
+};
+#endif
+
+class OrientationTrigger : public Trigger<Orientation> {
+ public:
+  explicit OrientationTrigger(BMI270Component *parent) {
+    parent->add_on_orientation_callback([this](Orientation orientation) { this->trigger(orientation); });
+  }
+};
+
+class TapTrigger : public Trigger<> {
+ public:
+  explicit TapTrigger(BMI270Component *parent) {
+    parent->add_on_tap_callback([this]() { this->trigger(); });
+  }
+};
+
+class DoubleTapTrigger : public Trigger<> {
+ public:
+  explicit DoubleTapTrigger(BMI270Component *parent) {
+    parent->add_on_double_tap_callback([this]() { this->trigger(); });
+  }
+};
+
+#ifdef USE_BUTTON
+class BMI270RecalibrateButton : public button::Button, public Parented<BMI270Component> {
+ protected:
+  void press_action() override { this->parent_->recalibrate(); }
+};
+#endif
+
+}  // namespace bmi270
 }  // namespace esphome
\ No newline at end of file
@@ -0,0 +1,425 @@
+#include "bmi270_api.h"
+#include "bmi270_config.h"
+
+namespace esphome {
+namespace bmi270 {
+
+#define BMI2_INIT_DATA_SIZE sizeof(bmi270_config_file)
+
+uint16_t bmi270_get_config_size() { return BMI2_INIT_DATA_SIZE; }
+
+int8_t bmi270_prepare_config_load(bmi2_dev *dev) {
+  uint8_t chip_id;
+  int8_t rslt = dev->read(BMI2_CHIP_ID_ADDR, &chip_id, 1, dev->intf_ptr);
+  if (rslt != BMI2_OK) return rslt;
+
+  if (chip_id != BMI2_CHIP_ID) return BMI2_E_COM_FAIL;
+
+  dev->chip_id = chip_id;
+
+  // Disable advanced power save mode (required for config upload)
+  uint8_t pwr_conf = 0x00;
+  rslt = dev->write(BMI2_PWR_CONF_ADDR, &pwr_conf, 1, dev->intf_ptr);
+  if (rslt != BMI2_OK) return rslt;
+  dev->delay_us(450, dev->intf_ptr);
+
+  // Disable config loading (INIT_CTRL = 0)
+  uint8_t init_ctrl = 0x00;
+  return dev->write(BMI2_INIT_CTRL_ADDR, &init_ctrl, 1, dev->intf_ptr);
+}
+
+int8_t bmi270_write_config_chunk(uint16_t index, uint16_t len, bmi2_dev *dev) {
+  // The BMI270 requires setting the word address (index / 2) before each chunk
+  uint16_t word_addr = index / 2;
+  uint8_t addr_array[2];
+  addr_array[0] = (uint8_t)(word_addr & 0x0F);         // Lower 4 bits
+  addr_array[1] = (uint8_t)((word_addr >> 4) & 0xFF);  // Upper 8 bits
+
+  // Write the address to INIT_ADDR registers
+  int8_t rslt = dev->write(BMI2_INIT_ADDR_0, addr_array, 2, dev->intf_ptr);
+  if (rslt != BMI2_OK) return rslt;
+
+  // Write config data chunk
+  return dev->write(BMI2_INIT_DATA_ADDR, &bmi270_config_file[index], len, dev->intf_ptr);
+}
+
+int8_t bmi270_start_config_load(bmi2_dev *dev) {
+  // Enable config loading (INIT_CTRL = 1)
+  uint8_t init_ctrl = 0x01;
+  return dev->write(BMI2_INIT_CTRL_ADDR, &init_ctrl, 1, dev->intf_ptr);
+}
+
+int8_t bmi270_get_init_status(uint8_t *internal_status, bmi2_dev *dev) {
+  return dev->read(BMI2_INTERNAL_STATUS_ADDR, internal_status, 1, dev->intf_ptr);
+}
+
+int8_t bmi270_init(bmi2_dev *dev) {
+  int8_t rslt = bmi270_prepare_config_load(dev);
+  if (rslt != BMI2_OK) return rslt;
+
+  // Upload config file in chunks with proper addressing
+  const uint16_t chunk_size = 32;  // Bytes per chunk (must be even)
+  for (uint16_t index = 0; index < BMI2_INIT_DATA_SIZE; index += chunk_size) {
+    uint16_t len = (BMI2_INIT_DATA_SIZE - index) > chunk_size ? chunk_size : (BMI2_INIT_DATA_SIZE - index);
+    rslt = bmi270_write_config_chunk(index, len, dev);
+    if (rslt != BMI2_OK) return rslt;
+  }
+
+  rslt = bmi270_start_config_load(dev);
+  if (rslt != BMI2_OK) return rslt;
+
+  // Wait for initialization to complete (150ms as per datasheet)
+  dev->delay_us(150000, dev->intf_ptr);
+
+  // Check internal status to verify config load was successful
+  uint8_t internal_status = 0;
+  rslt = bmi270_get_init_status(&internal_status, dev);
+  if (rslt != BMI2_OK) return rslt;
+
+  // Bit 0 should be 1 (INIT_OK) for successful initialization
+  if ((internal_status & BMI2_INIT_OK) != BMI2_INIT_OK) {
+    return BMI2_E_CONFIG_LOAD;
+  }
+
+  return BMI2_OK;
+}
+
+int8_t bmi270_sensor_enable(const uint8_t *sens_list, uint8_t n_sens, bmi2_dev *dev) {
+  // Enable accelerometer (0x04), gyroscope (0x02), and temperature (0x08)
+  uint8_t pwr_ctrl = 0x0E; // TEMP (0x08) + ACC (0x04) + GYR (0x02) = 0x0E
+  return dev->write(BMI2_PWR_CTRL_ADDR, &pwr_ctrl, 1, dev->intf_ptr);
+}
+
+int8_t bmi2_get_regs(uint8_t reg_addr, uint8_t *data, uint16_t len, bmi2_dev *dev) {
+  return dev->read(reg_addr, data, len, dev->intf_ptr);
+}
+
+int8_t bmi2_set_pwr_ctrl(uint8_t pwr_ctrl, bmi2_dev *dev) {
+  return dev->write(BMI2_PWR_CTRL_ADDR, &pwr_ctrl, 1, dev->intf_ptr);
+}
+
+int8_t bmi2_set_pwr_conf(uint8_t pwr_conf, bmi2_dev *dev) {
+  // With advanced power save on, consecutive writes need 450 us between them
+  int8_t rslt = dev->write(BMI2_PWR_CONF_ADDR, &pwr_conf, 1, dev->intf_ptr);
+  dev->delay_us(450, dev->intf_ptr);
+  return rslt;
+}
+
+int8_t bmi270_set_sensor_config(bmi2_sens_config *sens_cfg, uint8_t n_sens, bmi2_dev *dev) {
+  if (sens_cfg->type == BMI2_ACCEL) {
+    uint8_t acc_conf = sens_cfg->cfg.acc.odr | (sens_cfg->cfg.acc.bw << 4) | (sens_cfg->cfg.acc.perf_mode << 7);
+    uint8_t acc_range = sens_cfg->cfg.acc.range;
+    int8_t rslt = dev->write(BMI2_ACC_CONF_ADDR, &acc_conf, 1, dev->intf_ptr);
+    if (rslt != BMI2_OK) return rslt;
+    return dev->write(BMI2_ACC_RANGE_ADDR, &acc_range, 1, dev->intf_ptr);
+  } else if (sens_cfg->type == BMI2_GYRO) {
+    uint8_t gyr_conf = sens_cfg->cfg.gyr.odr | (sens_cfg->cfg.gyr.bw << 4) | (sens_cfg->cfg.gyr.noise_perf << 6) |
+                       (sens_cfg->cfg.gyr.filter_perf << 7);
+    uint8_t gyr_range = sens_cfg->cfg.gyr.range;
+    int8_t rslt = dev->write(BMI2_GYR_CONF_ADDR, &gyr_conf, 1, dev->intf_ptr);
+    if (rslt != BMI2_OK) return rslt;
+    return dev->write(BMI2_GYR_RANGE_ADDR, &gyr_range, 1, dev->intf_ptr);
+  }
+  return BMI2_OK;
+}
+
+static inline int16_t bmi2_word(const uint8_t *data) { return (int16_t)(data[0] | (data[1] << 8)); }
+
+int8_t bmi2_get_sensor_data(bmi2_sensor_data *sensor_data, uint8_t n_sens, bmi2_dev *dev) {
+  // Accel (0x0C..0x11) and gyro (0x12..0x17) are contiguous, one transaction
+  uint8_t data[12];
+  int8_t rslt = dev->read(BMI2_ACC_DATA_ADDR, data, 12, dev->intf_ptr);
+  if (rslt != BMI2_OK) return rslt;
+
+  sensor_data[0].sens_data.acc.x = bmi2_word(&data[0]);
+  sensor_data[0].sens_data.acc.y = bmi2_word(&data[2]);
+  sensor_data[0].sens_data.acc.z = bmi2_word(&data[4]);
+
+  sensor_data[1].sens_data.gyr.x = bmi2_word(&data[6]);
+  sensor_data[1].sens_data.gyr.y = bmi2_word(&data[8]);
+  sensor_data[1].sens_data.gyr.z = bmi2_word(&data[10]);
+
+  return BMI2_OK;
+}
+
+int8_t bmi2_get_burst_data(bmi2_burst_data *burst, bmi2_dev *dev) {
+  uint8_t data[BMI2_BURST_DATA_LENGTH];
+  int8_t rslt = dev->read(BMI2_STATUS_ADDR, data, BMI2_BURST_DATA_LENGTH, dev->intf_ptr);
+  if (rslt != BMI2_OK) return rslt;
+
+  burst->status = data[0];
+  for (uint8_t i = 0; i < 8; i++)
+    burst->aux[i] = data[1 + i];
+  burst->acc.x = bmi2_word(&data[9]);
+  burst->acc.y = bmi2_word(&data[11]);
+  burst->acc.z = bmi2_word(&data[13]);
+  burst->gyr.x = bmi2_word(&data[15]);
+  burst->gyr.y = bmi2_word(&data[17]);
+  burst->gyr.z = bmi2_word(&data[19]);
+  burst->sensortime = data[21] | (data[22] << 8) | ((uint32_t) data[23] << 16);
+
+  return BMI2_OK;
+}
+
+int8_t bmi2_get_temperature(int16_t *temp_raw, bmi2_dev *dev) {
+  uint8_t data[2];
+  int8_t rslt = dev->read(BMI2_TEMPERATURE_ADDR, data, 2, dev->intf_ptr);
+  if (rslt != BMI2_OK) return rslt;
+  *temp_raw = bmi2_word(data);
+  return BMI2_OK;
+}
+
+int8_t bmi2_set_fifo_config(FifoMode mode, bool aux, bmi2_dev *dev) {
+  // Sensortime frames are only emitted in header mode
+  uint8_t fifo_config[2];
+  fifo_config[0] = mode == FIFO_MODE_HEADER ? BMI2_FIFO_TIME_EN : 0x00;
+  fifo_config[1] = 0x00;
+  if (mode != FIFO_MODE_DISABLED) {
+    fifo_config[1] = BMI2_FIFO_ACC_EN | BMI2_FIFO_GYR_EN;
+    if (aux)
+      fifo_config[1] |= BMI2_FIFO_AUX_EN;
+    if (mode == FIFO_MODE_HEADER)
+      fifo_config[1] |= BMI2_FIFO_HEADER_EN;
+  }
+  return dev->write(BMI2_FIFO_CONFIG_0_ADDR, fifo_config, 2, dev->intf_ptr);
+}
+
+int8_t bmi2_flush_fifo(bmi2_dev *dev) {
+  uint8_t cmd = BMI2_FIFO_FLUSH_CMD;
+  return dev->write(BMI2_CMD_ADDR, &cmd, 1, dev->intf_ptr);
+}
+
+int8_t bmi2_get_fifo_length(uint16_t *fifo_length, bmi2_dev *dev) {
+  uint8_t data[2];
+  int8_t rslt = dev->read(BMI2_FIFO_LENGTH_0_ADDR, data, 2, dev->intf_ptr);
+  if (rslt != BMI2_OK) return rslt;
+  *fifo_length = (uint16_t)(data[0] | (data[1] << 8)) & BMI2_FIFO_LENGTH_MASK;
+  return BMI2_OK;
+}
+
+int8_t bmi2_read_fifo_data(uint8_t *data, uint16_t len, bmi2_dev *dev) {
+  // FIFO_DATA does not auto-increment, so the whole FIFO drains in one burst
+  return dev->read(BMI2_FIFO_DATA_ADDR, data, len, dev->intf_ptr);
+}
+
+int8_t bmi2_set_fifo_watermark(uint16_t watermark, bmi2_dev *dev) {
+  uint8_t data[2] = {(uint8_t)(watermark & 0xFF), (uint8_t)((watermark >> 8) & 0x1F)};
+  return dev->write(BMI2_FIFO_WTM_0_ADDR, data, 2, dev->intf_ptr);
+}
+
+int8_t bmi2_set_int_pin_config(uint8_t int_pin, uint8_t io_ctrl, bmi2_dev *dev) {
+  uint8_t reg = int_pin == BMI2_INT1 ? BMI2_INT1_IO_CTRL_ADDR : BMI2_INT2_IO_CTRL_ADDR;
+  int8_t rslt = dev->write(reg, &io_ctrl, 1, dev->intf_ptr);
+  if (rslt != BMI2_OK) return rslt;
+  // Non-latched: data-ready pulses per sample, the watermark line stays high
+  // until the FIFO drains below the level
+  uint8_t latch = 0x00;
+  return dev->write(BMI2_INT_LATCH_ADDR, &latch, 1, dev->intf_ptr);
+}
+
+int8_t bmi2_map_data_int(uint8_t int_map, bmi2_dev *dev) {
+  return dev->write(BMI2_INT_MAP_DATA_ADDR, &int_map, 1, dev->intf_ptr);
+}
+
+int8_t bmi2_map_feat_int(uint8_t int_pin, uint8_t feat_map, bmi2_dev *dev) {
+  uint8_t reg = int_pin == BMI2_INT1 ? BMI2_INT1_MAP_FEAT_ADDR : BMI2_INT2_MAP_FEAT_ADDR;
+  return dev->write(reg, &feat_map, 1, dev->intf_ptr);
+}
+
+int8_t bmi2_get_int_status(uint8_t *int_status, bmi2_dev *dev) {
+  // Clear-on-read
+  return dev->read(BMI2_INT_STATUS_0_ADDR, int_status, 1, dev->intf_ptr);
+}
+
+int8_t bmi2_get_feat_page(uint8_t page, uint8_t *data, bmi2_dev *dev) {
+  int8_t rslt = dev->write(BMI2_FEAT_PAGE_ADDR, &page, 1, dev->intf_ptr);
+  if (rslt != BMI2_OK) return rslt;
+  return dev->read(BMI2_FEATURES_REG_ADDR, data, BMI2_FEAT_PAGE_LEN, dev->intf_ptr);
+}
+
+int8_t bmi2_set_feat_page(uint8_t page, const uint8_t *data, bmi2_dev *dev) {
+  int8_t rslt = dev->write(BMI2_FEAT_PAGE_ADDR, &page, 1, dev->intf_ptr);
+  if (rslt != BMI2_OK) return rslt;
+  return dev->write(BMI2_FEATURES_REG_ADDR, data, BMI2_FEAT_PAGE_LEN, dev->intf_ptr);
+}
+
+int8_t bmi2_set_motion_config(uint8_t page, uint8_t offset, const bmi2_motion_config *config, bmi2_dev *dev) {
+  // Read-modify-write the whole page, the other blocks on it belong to
+  // features this driver does not touch
+  uint8_t data[BMI2_FEAT_PAGE_LEN];
+  int8_t rslt = bmi2_get_feat_page(page, data, dev);
+  if (rslt != BMI2_OK) return rslt;
+
+  // Word 0: duration [12:0], select_x/y/z [15:13]
+  // Word 1: threshold [10:0], enable [15]
+  uint16_t word0 = (config->duration & 0x1FFF) | ((uint16_t)(config->axes & 0x07) << 13);
+  uint16_t word1 = (data[offset + 2] | (data[offset + 3] << 8)) & 0x7800;
+  word1 |= (config->threshold & 0x07FF) | (config->enable ? 0x8000 : 0x0000);
+  data[offset] = word0 & 0xFF;
+  data[offset + 1] = word0 >> 8;
+  data[offset + 2] = word1 & 0xFF;
+  data[offset + 3] = word1 >> 8;
+  return bmi2_set_feat_page(page, data, dev);
+}
+
+int8_t bmi2_set_step_config(const bmi2_step_config *config, bmi2_dev *dev) {
+  uint8_t data[BMI2_FEAT_PAGE_LEN];
+  int8_t rslt = bmi2_get_feat_page(BMI2_STEP_CNT_PAGE, data, dev);
+  if (rslt != BMI2_OK) return rslt;
+
+  uint8_t *block = &data[BMI2_STEP_CNT_OFFSET];
+  // The counter only interrupts on its watermark; leave it off without one
+  uint16_t watermark = config->counter ? config->watermark & BMI2_STEP_CNT_WTM_MASK : 0;
+  block[0] = watermark & 0xFF;
+  block[1] = (block[1] & ~((BMI2_STEP_CNT_WTM_MASK >> 8) | 0x04)) | (watermark >> 8);
+  block[3] &= ~(BMI2_STEP_DET_EN | BMI2_STEP_CNT_EN | BMI2_STEP_ACT_EN);
+  if (config->detector)
+    block[3] |= BMI2_STEP_DET_EN;
+  if (config->counter)
+    block[3] |= BMI2_STEP_CNT_EN;
+  if (config->activity)
+    block[3] |= BMI2_STEP_ACT_EN;
+  return bmi2_set_feat_page(BMI2_STEP_CNT_PAGE, data, dev);
+}
+
+int8_t bmi2_get_step_output(uint32_t *step_count, uint8_t *activity, bmi2_dev *dev) {
+  uint8_t data[BMI2_FEAT_PAGE_LEN];
+  int8_t rslt = bmi2_get_feat_page(BMI2_STEP_OUT_PAGE, data, dev);
+  if (rslt != BMI2_OK) return rslt;
+  const uint8_t *count = &data[BMI2_STEP_COUNT_OUT_OFFSET];
+  *step_count = count[0] | (count[1] << 8) | ((uint32_t) count[2] << 16) | ((uint32_t) count[3] << 24);
+  *activity = data[BMI2_STEP_ACT_OUT_OFFSET] & 0x03;
+  return BMI2_OK;
+}
+
+int8_t bmi2_set_offsets(const bmi2_offsets *offsets, bool acc_en, bool gyr_en, bmi2_dev *dev) {
+  // gyr_gain_en shares the register with the offsets and is kept as is
+  uint8_t comp_6;
+  int8_t rslt = dev->read(BMI2_GYR_OFF_COMP_6_ADDR, &comp_6, 1, dev->intf_ptr);
+  if (rslt != BMI2_OK) return rslt;
+
+  // Accel offsets, gyro low bytes and the gyro high bits + enable in one burst
+  uint8_t data[7];
+  uint8_t gyr_high = (comp_6 & BMI2_GYR_GAIN_EN) | (gyr_en ? BMI2_GYR_OFF_EN : 0x00);
+  for (uint8_t i = 0; i < 3; i++) {
+    data[i] = (uint8_t) offsets->acc[i];
+    data[3 + i] = offsets->gyr[i] & 0xFF;
+    gyr_high |= ((offsets->gyr[i] >> 8) & 0x03) << (2 * i);
+  }
+  data[6] = gyr_high;
+  rslt = dev->write(BMI2_ACC_OFF_COMP_0_ADDR, data, 7, dev->intf_ptr);
+  if (rslt != BMI2_OK) return rslt;
+
+  // NV_CONF also holds the interface settings, only touch acc_off_en
+  uint8_t nv_conf;
+  rslt = dev->read(BMI2_NV_CONF_ADDR, &nv_conf, 1, dev->intf_ptr);
+  if (rslt != BMI2_OK) return rslt;
+  uint8_t new_nv_conf = acc_en ? (nv_conf | BMI2_NV_ACC_OFF_EN) : (nv_conf & ~BMI2_NV_ACC_OFF_EN);
+  if (new_nv_conf == nv_conf)
+    return BMI2_OK;
+  return dev->write(BMI2_NV_CONF_ADDR, &new_nv_conf, 1, dev->intf_ptr);
+}
+
+int8_t bmi2_set_gyro_gain_enable(bool enable, bmi2_dev *dev) {
+  uint8_t comp_6;
+  int8_t rslt = dev->read(BMI2_GYR_OFF_COMP_6_ADDR, &comp_6, 1, dev->intf_ptr);
+  if (rslt != BMI2_OK) return rslt;
+  uint8_t new_comp_6 = enable ? (comp_6 | BMI2_GYR_GAIN_EN) : (comp_6 & ~BMI2_GYR_GAIN_EN);
+  if (new_comp_6 == comp_6)
+    return BMI2_OK;
+  return dev->write(BMI2_GYR_OFF_COMP_6_ADDR, &new_comp_6, 1, dev->intf_ptr);
+}
+
+int8_t bmi2_start_crt(bmi2_dev *dev) {
+  // Requires the gyro disabled and the accel running
+  uint8_t data[BMI2_FEAT_PAGE_LEN];
+  int8_t rslt = bmi2_get_feat_page(BMI2_CRT_PAGE, data, dev);
+  if (rslt != BMI2_OK) return rslt;
+  data[BMI2_CRT_OFFSET] = (data[BMI2_CRT_OFFSET] & ~BMI2_CRT_ABORT) | BMI2_CRT_SELECT | BMI2_CRT_RUNNING;
+  rslt = bmi2_set_feat_page(BMI2_CRT_PAGE, data, dev);
+  if (rslt != BMI2_OK) return rslt;
+  uint8_t cmd = BMI2_G_TRIGGER_CMD;
+  return dev->write(BMI2_CMD_ADDR, &cmd, 1, dev->intf_ptr);
+}
+
+int8_t bmi2_get_crt_status(bool *running, uint8_t *status, bmi2_dev *dev) {
+  uint8_t data[BMI2_FEAT_PAGE_LEN];
+  int8_t rslt = bmi2_get_feat_page(BMI2_CRT_PAGE, data, dev);
+  if (rslt != BMI2_OK) return rslt;
+  *running = (data[BMI2_CRT_OFFSET] & BMI2_CRT_RUNNING) != 0;
+  if (*running)
+    return BMI2_OK;
+  rslt = bmi2_get_feat_page(BMI2_GYR_GAIN_STATUS_PAGE, data, dev);
+  if (rslt != BMI2_OK) return rslt;
+  // g_trig_status [5:3]: 0 ok, 1 precondition, 2 download, 3 aborted
+  *status = (data[BMI2_GYR_GAIN_STATUS_OFFSET] >> 3) & 0x07;
+  return BMI2_OK;
+}
+
+int8_t bmi2_set_aux_if(uint8_t aux_addr, bool manual, bmi2_dev *dev) {
+  uint8_t if_conf;
+  int8_t rslt = dev->read(BMI2_IF_CONF_ADDR, &if_conf, 1, dev->intf_ptr);
+  if (rslt != BMI2_OK) return rslt;
+  if_conf |= BMI2_IF_CONF_AUX_EN;
+  rslt = dev->write(BMI2_IF_CONF_ADDR, &if_conf, 1, dev->intf_ptr);
+  if (rslt != BMI2_OK) return rslt;
+  uint8_t dev_id = aux_addr << 1;
+  rslt = dev->write(BMI2_AUX_DEV_ID_ADDR, &dev_id, 1, dev->intf_ptr);
+  if (rslt != BMI2_OK) return rslt;
+  uint8_t aux_if_conf = BMI2_AUX_RD_BURST_8 | BMI2_AUX_MAN_RD_BURST_8;
+  if (manual)
+    aux_if_conf |= BMI2_AUX_MANUAL_EN;
+  return dev->write(BMI2_AUX_IF_CONF_ADDR, &aux_if_conf, 1, dev->intf_ptr);
+}
+
+static int8_t bmi2_wait_aux(bmi2_dev *dev) {
+  for (uint8_t i = 0; i < BMI2_AUX_BUSY_POLLS; i++) {
+    uint8_t status;
+    int8_t rslt = dev->read(BMI2_STATUS_ADDR, &status, 1, dev->intf_ptr);
+    if (rslt != BMI2_OK) return rslt;
+    if ((status & BMI2_AUX_BUSY) == 0)
+      return BMI2_OK;
+    dev->delay_us(100, dev->intf_ptr);
+  }
+  return BMI2_E_COM_FAIL;
+}
+
+int8_t bmi2_read_aux_man(uint8_t reg, uint8_t *data, uint8_t len, bmi2_dev *dev) {
+  // Manual mode reads up to 8 bytes per transfer into the aux data registers
+  while (len > 0) {
+    uint8_t chunk = len > BMI2_AUX_MAX_BURST ? BMI2_AUX_MAX_BURST : len;
+    int8_t rslt = dev->write(BMI2_AUX_RD_ADDR, &reg, 1, dev->intf_ptr);
+    if (rslt != BMI2_OK) return rslt;
+    rslt = bmi2_wait_aux(dev);
+    if (rslt != BMI2_OK) return rslt;
+    rslt = dev->read(BMI2_AUX_DATA_ADDR, data, chunk, dev->intf_ptr);
+    if (rslt != BMI2_OK) return rslt;
+    reg += chunk;
+    data += chunk;
+    len -= chunk;
+  }
+  return BMI2_OK;
+}
+
+int8_t bmi2_write_aux_man(uint8_t reg, uint8_t value, bmi2_dev *dev) {
+  // Writing the address starts the transfer
+  int8_t rslt = dev->write(BMI2_AUX_WR_DATA_ADDR, &value, 1, dev->intf_ptr);
+  if (rslt != BMI2_OK) return rslt;
+  rslt = dev->write(BMI2_AUX_WR_ADDR, &reg, 1, dev->intf_ptr);
+  if (rslt != BMI2_OK) return rslt;
+  return bmi2_wait_aux(dev);
+}
+
+int8_t bmi2_set_aux_data_mode(uint8_t odr, uint8_t read_addr, bmi2_dev *dev) {
+  // From here on the chip reads read_addr.. into 0x04-0x0B (and the FIFO)
+  // at the aux ODR without any host traffic
+  int8_t rslt = dev->write(BMI2_AUX_CONF_ADDR, &odr, 1, dev->intf_ptr);
+  if (rslt != BMI2_OK) return rslt;
+  rslt = dev->write(BMI2_AUX_RD_ADDR, &read_addr, 1, dev->intf_ptr);
+  if (rslt != BMI2_OK) return rslt;
+  uint8_t aux_if_conf = BMI2_AUX_RD_BURST_8;
+  return dev->write(BMI2_AUX_IF_CONF_ADDR, &aux_if_conf, 1, dev->intf_ptr);
+}
+
+}  // namespace bmi270
+}  // namespace esphome
@@ -0,0 +1,309 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "bmi270_fifo.h"
+
+// Register-level BMI270 driver in the style of the Bosch SensorAPI. All bus
+// access goes through the read/write/delay_us callbacks in bmi2_dev, and
+// nothing here depends on ESPHome, so the driver builds on the host and can
+// be run against a simulated register map.
+
+// BMI270 API type definitions and constants
+#define BMI2_OK 0
+#define BMI2_E_COM_FAIL 1
+#define BMI2_E_CONFIG_LOAD 2
+
+#define BMI2_I2C_INTF 0
+#define BMI2_SPI_INTF 1
+#define BMI2_ACCEL 0
+#define BMI2_GYRO 1
+
+// ACC_CONF: odr [3:0], bwp [6:4], filter_perf [7]
+#define BMI2_ACC_ODR_100HZ 0x08
+#define BMI2_ACC_ODR_1600HZ 0x0C
+#define BMI2_ACC_RANGE_2G 0x00
+#define BMI2_ACC_RANGE_16G 0x03
+#define BMI2_ACC_OSR4_AVG1 0x00
+#define BMI2_ACC_OSR2_AVG2 0x01
+#define BMI2_ACC_NORMAL_AVG4 0x02
+#define BMI2_ACC_CIC_AVG8 0x03
+#define BMI2_POWER_OPT_MODE 0x00
+#define BMI2_PERF_OPT_MODE 0x01
+
+// GYR_CONF: odr [3:0], bwp [5:4], noise_perf [6], filter_perf [7]
+// AUX_CONF: aux_odr [3:0], same codes as the accel
+#define BMI2_AUX_ODR_12_5HZ 0x05
+#define BMI2_AUX_ODR_25HZ 0x06
+
+#define BMI2_GYR_ODR_100HZ 0x08
+#define BMI2_GYR_ODR_3200HZ 0x0D
+#define BMI2_GYR_RANGE_2000 0x00
+#define BMI2_GYR_RANGE_125 0x04
+#define BMI2_GYR_OSR4_MODE 0x00
+#define BMI2_GYR_OSR2_MODE 0x01
+#define BMI2_GYR_NORMAL_MODE 0x02
+
+// BMI270 Register addresses
+#define BMI2_CHIP_ID_ADDR 0x00
+#define BMI2_PWR_CONF_ADDR 0x7C
+#define BMI2_PWR_CTRL_ADDR 0x7D
+#define BMI2_INIT_CTRL_ADDR 0x59
+#define BMI2_INIT_ADDR_0 0x5B
+#define BMI2_INIT_ADDR_1 0x5C
+#define BMI2_INIT_DATA_ADDR 0x5E
+#define BMI2_ACC_CONF_ADDR 0x40
+#define BMI2_ACC_RANGE_ADDR 0x41
+#define BMI2_GYR_CONF_ADDR 0x42
+#define BMI2_GYR_RANGE_ADDR 0x43
+#define BMI2_ACC_DATA_ADDR 0x0C
+#define BMI2_GYR_DATA_ADDR 0x12
+#define BMI2_TEMPERATURE_ADDR 0x22
+#define BMI2_INTERNAL_STATUS_ADDR 0x21
+#define BMI2_STATUS_ADDR 0x03
+#define BMI2_NV_CONF_ADDR 0x70
+#define BMI2_ACC_OFF_COMP_0_ADDR 0x71
+#define BMI2_GYR_OFF_COMP_3_ADDR 0x74
+#define BMI2_GYR_OFF_COMP_6_ADDR 0x77
+#define BMI2_OFFSET_ADDR 0x77
+#define BMI2_FIFO_LENGTH_0_ADDR 0x24
+#define BMI2_FIFO_DATA_ADDR 0x26
+#define BMI2_FIFO_WTM_0_ADDR 0x46
+#define BMI2_FIFO_CONFIG_0_ADDR 0x48
+#define BMI2_FIFO_CONFIG_1_ADDR 0x49
+#define BMI2_AUX_DATA_ADDR 0x04
+#define BMI2_AUX_CONF_ADDR 0x44
+#define BMI2_AUX_DEV_ID_ADDR 0x4B
+#define BMI2_AUX_IF_CONF_ADDR 0x4C
+#define BMI2_AUX_RD_ADDR 0x4D
+#define BMI2_AUX_WR_ADDR 0x4E
+#define BMI2_AUX_WR_DATA_ADDR 0x4F
+#define BMI2_IF_CONF_ADDR 0x6B
+#define BMI2_CMD_ADDR 0x7E
+#define BMI2_INT1_IO_CTRL_ADDR 0x53
+#define BMI2_INT2_IO_CTRL_ADDR 0x54
+#define BMI2_INT_LATCH_ADDR 0x55
+#define BMI2_INT_MAP_DATA_ADDR 0x58
+#define BMI2_INT1_MAP_FEAT_ADDR 0x56
+#define BMI2_INT2_MAP_FEAT_ADDR 0x57
+#define BMI2_INT_STATUS_0_ADDR 0x1C
+#define BMI2_FEAT_PAGE_ADDR 0x2F
+#define BMI2_FEATURES_REG_ADDR 0x30
+#define BMI2_FEAT_PAGE_LEN 16
+
+// INTx_IO_CTRL: push-pull, active high, output enabled
+#define BMI2_INT_IO_OUTPUT_EN 0x08
+#define BMI2_INT_IO_ACTIVE_HIGH 0x02
+#define BMI2_INT1 0
+#define BMI2_INT2 1
+
+// INT_MAP_DATA bits for INT1; INT2 bits are the same shifted left by 4
+#define BMI2_FFULL_INT 0x01
+#define BMI2_FWM_INT 0x02
+#define BMI2_DRDY_INT 0x04
+
+// FIFO_CONFIG_0 / FIFO_CONFIG_1 bits
+#define BMI2_FIFO_TIME_EN 0x02
+#define BMI2_FIFO_HEADER_EN 0x10
+#define BMI2_FIFO_ACC_EN 0x40
+#define BMI2_FIFO_GYR_EN 0x80
+#define BMI2_FIFO_AUX_EN 0x20
+#define BMI2_FIFO_LENGTH_MASK 0x3FFF
+
+#define BMI2_FIFO_FLUSH_CMD 0xB0
+#define BMI2_G_TRIGGER_CMD 0x02
+
+// Offset compensation enables: acc_off_en in NV_CONF, gyr_off_en in
+// GYR_OFF_COMP_6 next to the upper gyro offset bits; gyr_gain_en in the
+// same register applies the CRT sensitivity trims
+#define BMI2_NV_ACC_OFF_EN 0x08
+#define BMI2_GYR_OFF_EN 0x40
+#define BMI2_GYR_GAIN_EN 0x80
+
+// Feature engine config blocks (page, byte offset within the page)
+#define BMI2_ANY_MOT_PAGE 1
+#define BMI2_ANY_MOT_OFFSET 0x0C
+#define BMI2_NO_MOT_PAGE 2
+#define BMI2_NO_MOT_OFFSET 0x00
+#define BMI2_STEP_CNT_PAGE 6
+#define BMI2_STEP_CNT_OFFSET 0x0C
+#define BMI2_STEP_OUT_PAGE 0
+#define BMI2_STEP_COUNT_OUT_OFFSET 0x00
+#define BMI2_STEP_ACT_OUT_OFFSET 0x04
+
+// Step counter block: watermark [9:0] and reset [10] in word 0, enables in
+// the high byte of word 1
+#define BMI2_STEP_CNT_WTM_MASK 0x03FF
+#define BMI2_STEP_DET_EN 0x08
+#define BMI2_STEP_CNT_EN 0x10
+#define BMI2_STEP_ACT_EN 0x20
+
+// CRT (component retrimming) control on page 1, result in the gyro gain
+// status byte on output page 0
+#define BMI2_CRT_PAGE 1
+#define BMI2_CRT_OFFSET 0x03
+#define BMI2_CRT_SELECT 0x01
+#define BMI2_CRT_ABORT 0x02
+#define BMI2_CRT_RUNNING 0x04
+#define BMI2_GYR_GAIN_STATUS_PAGE 0
+#define BMI2_GYR_GAIN_STATUS_OFFSET 0x08
+
+// INT_STATUS_0 / INTx_MAP_FEAT bits
+#define BMI2_STEP_CNT_INT 0x02
+#define BMI2_STEP_ACT_INT 0x04
+#define BMI2_NO_MOT_INT 0x20
+#define BMI2_ANY_MOT_INT 0x40
+
+// PWR_CTRL / PWR_CONF bits
+// AUX_IF_CONF: aux_rd_burst [1:0], man_rd_burst [3:2], aux_manual_en [7]
+#define BMI2_AUX_RD_BURST_8 0x03
+#define BMI2_AUX_MAN_RD_BURST_8 0x0C
+#define BMI2_AUX_MANUAL_EN 0x80
+#define BMI2_IF_CONF_AUX_EN 0x20
+#define BMI2_AUX_BUSY 0x04
+#define BMI2_AUX_BUSY_POLLS 20
+#define BMI2_AUX_MAX_BURST 8
+
+#define BMI2_PWR_CTRL_AUX_EN 0x01
+#define BMI2_PWR_CTRL_GYR_EN 0x02
+#define BMI2_PWR_CTRL_ACC_EN 0x04
+#define BMI2_PWR_CTRL_TEMP_EN 0x08
+#define BMI2_PWR_CONF_ADV_POWER_SAVE 0x01
+#define BMI2_PWR_CONF_FUP_EN 0x04
+
+#define BMI2_CHIP_ID 0x24
+#define BMI2_INIT_OK 0x01
+#define BMI2_BURST_DATA_LENGTH 24  // STATUS (0x03) through SENSORTIME_2 (0x1A)
+#define BMI2_DRDY_ACC 0x80
+#define BMI2_DRDY_GYR 0x40
+#define BMI2_DRDY_AUX 0x20
+
+namespace esphome {
+namespace bmi270 {
+
+struct bmi2_dev {
+  uint8_t chip_id;
+  uint8_t intf;
+  void *intf_ptr;
+  int8_t (*read)(uint8_t reg_addr, uint8_t *data, uint32_t len, void *intf_ptr);
+  int8_t (*write)(uint8_t reg_addr, const uint8_t *data, uint32_t len, void *intf_ptr);
+  void (*delay_us)(uint32_t period, void *intf_ptr);
+};
+
+struct bmi2_accel_config {
+  uint8_t odr;
+  uint8_t range;
+  uint8_t bw;
+  uint8_t perf_mode;
+};
+
+struct bmi2_gyro_config {
+  uint8_t odr;
+  uint8_t range;
+  uint8_t bw;
+  uint8_t noise_perf;
+  uint8_t filter_perf;
+};
+
+struct bmi2_sens_config {
+  uint8_t type;
+  union {
+    bmi2_accel_config acc;
+    bmi2_gyro_config gyr;
+  } cfg;
+};
+
+struct bmi2_sens_axes_data {
+  int16_t x;
+  int16_t y;
+  int16_t z;
+};
+
+struct bmi2_sensor_data {
+  uint8_t type;
+  union {
+    bmi2_sens_axes_data acc;
+    bmi2_sens_axes_data gyr;
+  } sens_data;
+};
+
+// Status, aux, accel, gyro and sensortime (0x03..0x1A) in one burst
+struct bmi2_burst_data {
+  uint8_t status;
+  uint8_t aux[8];
+  bmi2_sens_axes_data acc;
+  bmi2_sens_axes_data gyr;
+  uint32_t sensortime;
+};
+
+// Any-motion / no-motion feature configuration (one 4-byte block each)
+struct bmi2_motion_config {
+  uint16_t duration;   // 13 bits, 20 ms per LSB
+  uint16_t threshold;  // 11 bits, 1 g / 2048 per LSB
+  uint8_t axes;        // bit0 x, bit1 y, bit2 z
+  bool enable;
+};
+
+// Step counter feature configuration
+struct bmi2_step_config {
+  uint16_t watermark;  // 10 bits, counter interrupt every 20 * watermark steps
+  bool detector;
+  bool counter;
+  bool activity;
+};
+
+// Step activity output (feature output page 0, byte 0x04)
+enum StepActivity : uint8_t {
+  STEP_ACTIVITY_STILL = 0,
+  STEP_ACTIVITY_WALKING = 1,
+  STEP_ACTIVITY_RUNNING = 2,
+  STEP_ACTIVITY_UNKNOWN = 3,
+};
+
+// Offset compensation registers 0x71..0x77. Accel: 3.9 mg/LSB, 8 bit.
+// Gyro: 0.061 °/s/LSB, 10 bit.
+struct bmi2_offsets {
+  int8_t acc[3];
+  int16_t gyr[3];
+};
+
+// BMI270 API function declarations
+uint16_t bmi270_get_config_size();
+int8_t bmi270_init(bmi2_dev *dev);
+int8_t bmi270_prepare_config_load(bmi2_dev *dev);
+int8_t bmi270_write_config_chunk(uint16_t index, uint16_t len, bmi2_dev *dev);
+int8_t bmi270_start_config_load(bmi2_dev *dev);
+int8_t bmi270_get_init_status(uint8_t *internal_status, bmi2_dev *dev);
+int8_t bmi270_sensor_enable(const uint8_t *sens_list, uint8_t n_sens, bmi2_dev *dev);
+int8_t bmi2_get_regs(uint8_t reg_addr, uint8_t *data, uint16_t len, bmi2_dev *dev);
+int8_t bmi2_set_pwr_ctrl(uint8_t pwr_ctrl, bmi2_dev *dev);
+int8_t bmi2_set_pwr_conf(uint8_t pwr_conf, bmi2_dev *dev);
+int8_t bmi270_set_sensor_config(bmi2_sens_config *sens_cfg, uint8_t n_sens, bmi2_dev *dev);
+int8_t bmi2_get_sensor_data(bmi2_sensor_data *sensor_data, uint8_t n_sens, bmi2_dev *dev);
+int8_t bmi2_get_burst_data(bmi2_burst_data *burst, bmi2_dev *dev);
+int8_t bmi2_get_temperature(int16_t *temp_raw, bmi2_dev *dev);
+int8_t bmi2_set_fifo_config(FifoMode mode, bool aux, bmi2_dev *dev);
+int8_t bmi2_flush_fifo(bmi2_dev *dev);
+int8_t bmi2_get_fifo_length(uint16_t *fifo_length, bmi2_dev *dev);
+int8_t bmi2_read_fifo_data(uint8_t *data, uint16_t len, bmi2_dev *dev);
+int8_t bmi2_set_fifo_watermark(uint16_t watermark, bmi2_dev *dev);
+int8_t bmi2_set_int_pin_config(uint8_t int_pin, uint8_t io_ctrl, bmi2_dev *dev);
+int8_t bmi2_map_data_int(uint8_t int_map, bmi2_dev *dev);
+int8_t bmi2_map_feat_int(uint8_t int_pin, uint8_t feat_map, bmi2_dev *dev);
+int8_t bmi2_get_int_status(uint8_t *int_status, bmi2_dev *dev);
+int8_t bmi2_get_feat_page(uint8_t page, uint8_t *data, bmi2_dev *dev);
+int8_t bmi2_set_feat_page(uint8_t page, const uint8_t *data, bmi2_dev *dev);
+int8_t bmi2_set_motion_config(uint8_t page, uint8_t offset, const bmi2_motion_config *config, bmi2_dev *dev);
+int8_t bmi2_set_step_config(const bmi2_step_config *config, bmi2_dev *dev);
+int8_t bmi2_get_step_output(uint32_t *step_count, uint8_t *activity, bmi2_dev *dev);
+int8_t bmi2_set_offsets(const bmi2_offsets *offsets, bool acc_en, bool gyr_en, bmi2_dev *dev);
+int8_t bmi2_set_gyro_gain_enable(bool enable, bmi2_dev *dev);
+int8_t bmi2_start_crt(bmi2_dev *dev);
+int8_t bmi2_get_crt_status(bool *running, uint8_t *status, bmi2_dev *dev);
+int8_t bmi2_set_aux_if(uint8_t aux_addr, bool manual, bmi2_dev *dev);
+int8_t bmi2_read_aux_man(uint8_t reg, uint8_t *data, uint8_t len, bmi2_dev *dev);
+int8_t bmi2_write_aux_man(uint8_t reg, uint8_t value, bmi2_dev *dev);
+int8_t bmi2_set_aux_data_mode(uint8_t odr, uint8_t read_addr, bmi2_dev *dev);
+
+}  // namespace bmi270
+}  // namespace esphome
@@ -0,0 +1,116 @@
+#include "bmi270_bias.h"
+
+namespace esphome {
+namespace bmi270 {
+
+void BiasEstimator::set_limits(float max_gyro_std, float acc_one_g, float max_acc_dev) {
+  this->max_gyro_var_ = max_gyro_std * max_gyro_std;
+  this->acc_one_g_sq_ = acc_one_g * acc_one_g;
+  this->acc_min_sq_ = (acc_one_g - max_acc_dev) * (acc_one_g - max_acc_dev);
+  this->acc_max_sq_ = (acc_one_g + max_acc_dev) * (acc_one_g + max_acc_dev);
+}
+
+void BiasEstimator::reset() {
+  this->table_ = {};
+  this->dirty_ = true;
+  this->observations_ = 0;
+  this->reset_window_();
+}
+
+void BiasEstimator::reset_window_() {
+  this->window_count_ = 0;
+  for (uint8_t i = 0; i < 3; i++) {
+    this->window_sum_[i] = 0;
+    this->window_sum_sq_[i] = 0.0f;
+  }
+  this->window_temperature_ = 0.0f;
+}
+
+void BiasEstimator::add_sample(const int16_t *gyr, const int16_t *acc, float temperature) {
+  // Anything but gravity on the accel means the device is being handled
+  float acc_sq = (float) acc[0] * acc[0] + (float) acc[1] * acc[1] + (float) acc[2] * acc[2];
+  if (acc_sq < this->acc_min_sq_ || acc_sq > this->acc_max_sq_) {
+    this->reset_window_();
+    return;
+  }
+
+  for (uint8_t i = 0; i < 3; i++) {
+    this->window_sum_[i] += gyr[i];
+    this->window_sum_sq_[i] += (float) gyr[i] * gyr[i];
+  }
+  this->window_temperature_ += temperature;
+  if (++this->window_count_ < BIAS_WINDOW_SAMPLES)
+    return;
+
+  const float n = BIAS_WINDOW_SAMPLES;
+  float mean[3];
+  bool still = true;
+  for (uint8_t i = 0; i < 3; i++) {
+    mean[i] = this->window_sum_[i] / n;
+    float var = this->window_sum_sq_[i] / n - mean[i] * mean[i];
+    if (var > this->max_gyro_var_)
+      still = false;
+  }
+  float window_temperature = this->window_temperature_ / n;
+  this->reset_window_();
+  if (still)
+    this->learn_(window_temperature, mean);
+}
+
+void BiasEstimator::learn_(float temperature, const float *mean) {
+  // Checked before the cast, which would round the first bin below up to 0
+  float pos = (temperature - BIAS_TABLE_MIN_C) / BIAS_TABLE_BIN_C;
+  if (pos < 0.0f || pos >= BIAS_TABLE_BINS)
+    return;
+  int bin = (int) pos;
+
+  uint16_t &weight = this->table_.weight[bin];
+  if (weight < BIAS_MAX_WEIGHT)
+    weight++;
+  const float alpha = 1.0f / weight;
+  for (uint8_t i = 0; i < 3; i++)
+    this->table_.bias[bin][i] += alpha * (mean[i] - this->table_.bias[bin][i]);
+  this->dirty_ = true;
+  this->observations_++;
+}
+
+uint8_t BiasEstimator::get_learned_bins() const {
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < BIAS_TABLE_BINS; i++) {
+    if (this->table_.weight[i] != 0)
+      n++;
+  }
+  return n;
+}
+
+bool BiasEstimator::get_bias(float temperature, float *bias) const {
+  // Nearest learned bin centre on each side of the temperature
+  float pos = (temperature - BIAS_TABLE_MIN_C) / BIAS_TABLE_BIN_C - 0.5f;
+  int below = -1, above = -1;
+  for (int i = 0; i < BIAS_TABLE_BINS; i++) {
+    if (this->table_.weight[i] == 0)
+      continue;
+    if (i <= pos)
+      below = i;
+    else if (above < 0)
+      above = i;
+  }
+  if (below < 0 && above < 0)
+    return false;
+
+  if (below < 0 || above < 0) {
+    // Outside the learned range: hold the closest bin
+    int bin = below < 0 ? above : below;
+    for (uint8_t i = 0; i < 3; i++)
+      bias[i] = this->table_.bias[bin][i];
+    return true;
+  }
+
+  float t = (pos - below) / (float) (above - below);
+  for (uint8_t i = 0; i < 3; i++)
+    bias[i] = this->table_.bias[below][i] + t * (this->table_.bias[above][i] - this->table_.bias[below][i]);
+  return true;
+}
+
+}  // namespace bmi270
+}  // namespace esphome
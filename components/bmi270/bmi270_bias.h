@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stdint.h>
+
+// Gyro bias as a function of die temperature, learned from windows in which
+// the device lies still. Kept free of ESPHome dependencies so it can be
+// replayed against recorded sample/temperature traces on the host.
+
+namespace esphome {
+namespace bmi270 {
+
+static const uint8_t BIAS_TABLE_BINS = 20;
+static const float BIAS_TABLE_MIN_C = -10.0f;
+static const float BIAS_TABLE_BIN_C = 4.0f;
+// Samples per stillness window; each still window is one bias observation
+static const uint8_t BIAS_WINDOW_SAMPLES = 32;
+// Caps how slowly a bin follows new observations (EMA weight 1/64)
+static const uint16_t BIAS_MAX_WEIGHT = 64;
+
+// Persisted as-is in preferences
+struct BiasTable {
+  float bias[BIAS_TABLE_BINS][3];  // gyro LSB
+  uint16_t weight[BIAS_TABLE_BINS];
+};
+
+class BiasEstimator {
+ public:
+  // Stillness limits in raw LSB: gyro standard deviation per axis, and the
+  // allowed deviation of the accel norm from one g
+  void set_limits(float max_gyro_std, float acc_one_g, float max_acc_dev);
+
+  void add_sample(const int16_t *gyr, const int16_t *acc, float temperature);
+
+  // Bias at a temperature, interpolated between learned bins. Returns false
+  // until at least one bin has been learned.
+  bool get_bias(float temperature, float *bias) const;
+
+  void reset();
+  const BiasTable &get_table() const { return this->table_; }
+  void set_table(const BiasTable &table) { this->table_ = table; }
+  bool is_dirty() const { return this->dirty_; }
+  void clear_dirty() { this->dirty_ = false; }
+  uint32_t get_observations() const { return this->observations_; }
+  uint8_t get_learned_bins() const;
+
+ protected:
+  void reset_window_();
+  void learn_(float temperature, const float *mean);
+
+  float max_gyro_var_{0.0f};
+  float acc_one_g_sq_{0.0f};
+  float acc_min_sq_{0.0f};
+  float acc_max_sq_{0.0f};
+
+  BiasTable table_{};
+  bool dirty_{false};
+  uint32_t observations_{0};
+
+  uint8_t window_count_{0};
+  int32_t window_sum_[3]{};
+  float window_sum_sq_[3]{};
+  float window_temperature_{0.0f};
+};
+
+}  // namespace bmi270
+}  // namespace esphome
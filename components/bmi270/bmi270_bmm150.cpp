@@ -0,0 +1,61 @@
+#include "bmi270_bmm150.h"
+
+namespace esphome {
+namespace bmi270 {
+
+// Raw values the BMM150 reports on overflow
+static const int16_t BMM150_XY_OVERFLOW = -4096;
+static const int16_t BMM150_Z_OVERFLOW = -16384;
+
+Bmm150Trim bmm150_parse_trim(const uint8_t x1y1[2], const uint8_t z4x2y2[4], const uint8_t z2xy1[10]) {
+  Bmm150Trim trim{};
+  trim.dig_x1 = (int8_t) x1y1[0];
+  trim.dig_y1 = (int8_t) x1y1[1];
+  trim.dig_z4 = (int16_t) (z4x2y2[0] | (z4x2y2[1] << 8));
+  trim.dig_x2 = (int8_t) z4x2y2[2];
+  trim.dig_y2 = (int8_t) z4x2y2[3];
+  trim.dig_z2 = (int16_t) (z2xy1[0] | (z2xy1[1] << 8));
+  trim.dig_z1 = (uint16_t) (z2xy1[2] | (z2xy1[3] << 8));
+  trim.dig_xyz1 = (uint16_t) (z2xy1[4] | ((z2xy1[5] & 0x7F) << 8));
+  trim.dig_z3 = (int16_t) (z2xy1[6] | (z2xy1[7] << 8));
+  trim.dig_xy2 = (int8_t) z2xy1[8];
+  trim.dig_xy1 = z2xy1[9];
+  return trim;
+}
+
+static float compensate_xy(const Bmm150Trim &trim, int16_t raw, uint16_t rhall, int8_t dig_1, int8_t dig_2) {
+  float r = (float) trim.dig_xyz1 * 16384.0f / rhall - 16384.0f;
+  float c1 = (float) trim.dig_xy2 * (r * r / 268435456.0f);
+  float c2 = c1 + r * (float) trim.dig_xy1 / 16384.0f;
+  float c3 = (float) dig_2 + 160.0f;
+  float c4 = raw * ((c2 + 256.0f) * c3);
+  return (c4 / 8192.0f + (float) dig_1 * 8.0f) / 16.0f;
+}
+
+bool bmm150_compensate(const Bmm150Trim &trim, const uint8_t data[8], float out_ut[3]) {
+  // X/Y are 13 bit, Z 15 bit, RHALL 14 bit, all left aligned
+  int16_t x = (int16_t) (data[0] | (data[1] << 8)) >> 3;
+  int16_t y = (int16_t) (data[2] | (data[3] << 8)) >> 3;
+  int16_t z = (int16_t) (data[4] | (data[5] << 8)) >> 1;
+  uint16_t rhall = (uint16_t) (data[6] | (data[7] << 8)) >> 2;
+
+  if (rhall == 0 || trim.dig_xyz1 == 0 || trim.dig_z1 == 0 || trim.dig_z2 == 0)
+    return false;
+  if (x == BMM150_XY_OVERFLOW || y == BMM150_XY_OVERFLOW || z == BMM150_Z_OVERFLOW)
+    return false;
+
+  out_ut[0] = compensate_xy(trim, x, rhall, trim.dig_x1, trim.dig_x2);
+  out_ut[1] = compensate_xy(trim, y, rhall, trim.dig_y1, trim.dig_y2);
+
+  float z0 = (float) z - (float) trim.dig_z4;
+  float z1 = (float) rhall - (float) trim.dig_xyz1;
+  float z2 = (float) trim.dig_z3 * z1;
+  float z3 = (float) trim.dig_z1 * (float) rhall / 32768.0f;
+  float z4 = (float) trim.dig_z2 + z3;
+  float z5 = z0 * 131072.0f - z2;
+  out_ut[2] = z5 / (z4 * 4.0f) / 16.0f;
+  return true;
+}
+
+}  // namespace bmi270
+}  // namespace esphome
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdint.h>
+
+// BMM150 magnetometer behind the BMI270 auxiliary interface: register map,
+// trim data and the Bosch floating point compensation. Kept free of
+// ESPHome dependencies so recorded aux frames can be checked on the host.
+
+#define BMM150_DEFAULT_ADDRESS 0x10
+#define BMM150_CHIP_ID_ADDR 0x40
+#define BMM150_CHIP_ID 0x32
+#define BMM150_DATA_ADDR 0x42  // X, Y, Z, RHALL: 8 bytes, read by the aux interface
+#define BMM150_POWER_CTRL_ADDR 0x4B
+#define BMM150_OP_MODE_ADDR 0x4C
+#define BMM150_REP_XY_ADDR 0x51
+#define BMM150_REP_Z_ADDR 0x52
+#define BMM150_DIG_X1_ADDR 0x5D  // x1, y1
+#define BMM150_DIG_Z4_ADDR 0x62  // z4 (2), x2, y2
+#define BMM150_DIG_Z2_ADDR 0x68  // z2 (2), z1 (2), xyz1 (2), z3 (2), xy2, xy1
+
+#define BMM150_POWER_ON 0x01
+// Normal mode, data rate in bits [5:3]
+#define BMM150_OP_MODE_NORMAL 0x00
+#define BMM150_DATA_RATE_15HZ (0x04 << 3)
+#define BMM150_DATA_RATE_30HZ (0x07 << 3)
+// Regular preset: 9 XY and 15 Z repetitions
+#define BMM150_REP_XY_REGULAR 0x04
+#define BMM150_REP_Z_REGULAR 0x0E
+// Power-on to sleep mode
+#define BMM150_STARTUP_US 3000
+
+namespace esphome {
+namespace bmi270 {
+
+struct Bmm150Trim {
+  int8_t dig_x1;
+  int8_t dig_y1;
+  int8_t dig_x2;
+  int8_t dig_y2;
+  uint16_t dig_z1;
+  int16_t dig_z2;
+  int16_t dig_z3;
+  int16_t dig_z4;
+  uint8_t dig_xy1;
+  int8_t dig_xy2;
+  uint16_t dig_xyz1;
+};
+
+// Assemble the trim block from the three register reads above
+Bmm150Trim bmm150_parse_trim(const uint8_t x1y1[2], const uint8_t z4x2y2[4], const uint8_t z2xy1[10]);
+
+// Compensate one 8-byte data frame into µT. Returns false on an overflowed
+// or not yet valid reading.
+bool bmm150_compensate(const Bmm150Trim &trim, const uint8_t data[8], float out_ut[3]);
+
+}  // namespace bmi270
+}  // namespace esphome
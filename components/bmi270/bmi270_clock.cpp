@@ -0,0 +1,132 @@
+#include "bmi270_clock.h"
+
+namespace esphome {
+namespace bmi270 {
+
+static const uint32_t SENSORTIME_MASK = 0x00FFFFFF;
+static const uint32_t SENSORTIME_HALF = 0x00800000;
+// 39.0625 us in Q24
+static const int64_t NOMINAL_RATE_Q24 = (int64_t) 625 << 20;
+// The sensor oscillator is trimmed to a few percent; anything beyond is a
+// bad observation
+static const int64_t MAX_RATE_DEVIATION_Q24 = NOMINAL_RATE_Q24 / 32;
+// Prediction errors beyond the worst-case drift plus this mean a stall or a
+// sensor reset: start over
+static const int32_t RESYNC_ERROR_US = 20000;
+// Frequency corrections are spread over at least this many ticks (10 s), so
+// closely spaced reads do not turn delay noise into drift
+static const int64_t FREQ_TAU_TICKS = 256000;
+// The first rate estimate waits for this much sensortime (1 s): one tick of
+// counter resolution over a single 100 ms poll is already ~400 ppm
+static const uint32_t RATE_BASELINE_TICKS = 25600;
+// Gaps longer than this risk an ambiguous 24-bit wrap (655 s)
+static const uint32_t MAX_GAP_US = 300000000;
+
+void SensorClock::reset() {
+  this->observations_ = 0;
+  this->rate_q24_ = NOMINAL_RATE_Q24;
+  this->jitter_us_ = 0;
+  this->max_jitter_us_ = 0;
+}
+
+void SensorClock::seed_(uint32_t sensortime, uint32_t local_us) {
+  if (this->rate_q24_ == 0)
+    this->rate_q24_ = NOMINAL_RATE_Q24;
+  this->ref_ticks_ = sensortime & SENSORTIME_MASK;
+  this->ref_local_us_ = local_us;
+  this->observations_ = 1;
+}
+
+uint32_t SensorClock::to_local_us(uint32_t sensortime) const {
+  // Signed 24-bit distance from the reference
+  int32_t dt = (int32_t) ((sensortime - this->ref_ticks_) & SENSORTIME_MASK);
+  if (dt >= (int32_t) SENSORTIME_HALF)
+    dt -= (int32_t) (SENSORTIME_MASK + 1);
+  int64_t offset_q24 = (int64_t) dt * this->rate_q24_;
+  return this->ref_local_us_ + (int32_t) (offset_q24 / (1 << 24));
+}
+
+void SensorClock::clamp_rate_() {
+  if (this->rate_q24_ > NOMINAL_RATE_Q24 + MAX_RATE_DEVIATION_Q24)
+    this->rate_q24_ = NOMINAL_RATE_Q24 + MAX_RATE_DEVIATION_Q24;
+  if (this->rate_q24_ < NOMINAL_RATE_Q24 - MAX_RATE_DEVIATION_Q24)
+    this->rate_q24_ = NOMINAL_RATE_Q24 - MAX_RATE_DEVIATION_Q24;
+}
+
+float SensorClock::get_tick_s() const {
+  int64_t rate = this->rate_q24_ != 0 ? this->rate_q24_ : NOMINAL_RATE_Q24;
+  return (float) rate / (float) (1 << 24) * 1e-6f;
+}
+
+float SensorClock::get_drift_ppm() const {
+  if (this->rate_q24_ == 0)
+    return 0.0f;
+  return (float) (this->rate_q24_ - NOMINAL_RATE_Q24) * 1e6f / (float) NOMINAL_RATE_Q24;
+}
+
+void SensorClock::observe(uint32_t sensortime, uint32_t local_us) {
+  sensortime &= SENSORTIME_MASK;
+  if (this->observations_ == 0 || local_us - this->ref_local_us_ > MAX_GAP_US) {
+    this->seed_(sensortime, local_us);
+    return;
+  }
+  uint32_t dt_ticks = (sensortime - this->ref_ticks_) & SENSORTIME_MASK;
+  if (dt_ticks == 0 || dt_ticks >= SENSORTIME_HALF)
+    return;
+
+  uint32_t predicted = this->to_local_us(sensortime);
+  int32_t error = (int32_t) (local_us - predicted);
+  int64_t limit = RESYNC_ERROR_US + (((int64_t) dt_ticks * MAX_RATE_DEVIATION_Q24) >> 24);
+  if (error > limit || error < -limit) {
+    this->resyncs_++;
+    this->seed_(sensortime, local_us);
+    return;
+  }
+
+  if (this->observations_ == 1) {
+    if (dt_ticks < RATE_BASELINE_TICKS)
+      return;
+    // Second point: take the rate straight from the two observations
+    this->rate_q24_ = ((int64_t) (local_us - this->ref_local_us_) << 24) / (int64_t) dt_ticks;
+    this->clamp_rate_();
+    this->ref_ticks_ = sensortime;
+    this->ref_local_us_ = local_us;
+    this->observations_++;
+    return;
+  }
+
+  uint32_t abs_error = error < 0 ? -error : error;
+  this->jitter_us_ += ((int32_t) abs_error - (int32_t) this->jitter_us_) / 16;
+  if (abs_error > this->max_jitter_us_)
+    this->max_jitter_us_ = abs_error;
+
+  // Early observations are closer to the true mapping than late ones. Both
+  // loops weigh them 8:1 so they settle at the same point; otherwise the
+  // frequency loop absorbs the mean read delay as drift.
+  int32_t phase = error < 0 ? error / 2 : error / 16;
+  // Frequency correction spreads the error over the elapsed ticks
+  int32_t freq_error = error < 0 ? error : error / 8;
+  this->rate_q24_ += ((int64_t) freq_error << 24) / ((int64_t) dt_ticks + FREQ_TAU_TICKS) / 2;
+  this->clamp_rate_();
+
+  this->ref_ticks_ = sensortime;
+  this->ref_local_us_ = predicted + phase;
+  if (this->observations_ < UINT32_MAX)
+    this->observations_++;
+}
+
+int32_t sample_phase_offset_us(uint32_t a_us, uint32_t b_us, uint32_t period_us) {
+  if (period_us == 0)
+    return (int32_t) (b_us - a_us);
+  int32_t period = (int32_t) period_us;
+  // Signed distance, so a wrap of micros() between the two does not matter
+  int32_t offset = (int32_t) (b_us - a_us) % period;
+  if (offset < 0)
+    offset += period;
+  if (offset > period / 2)
+    offset -= period;
+  return offset;
+}
+
+}  // namespace bmi270
+}  // namespace esphome
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+
+// Maps the 24-bit BMI270 sensortime onto the host's monotonic microsecond
+// clock. Each observation pairs a sensortime value with the local time it
+// was read at; a phase/frequency loop tracks the offset and the drift of
+// the sensor oscillator. Read delays only ever make the local time late, so
+// the loop follows early observations quickly and late ones slowly, which
+// converges on the minimum-delay path. Kept free of ESPHome dependencies so
+// it can be driven with synthetic clocks on the host.
+
+namespace esphome {
+namespace bmi270 {
+
+// Nominal sensortime tick: 39.0625 us (25.6 kHz)
+static const uint32_t SENSORTIME_TICK_NS = 39063;
+// Observations before the mapping is considered locked
+static const uint8_t CLOCK_LOCK_OBSERVATIONS = 8;
+
+class SensorClock {
+ public:
+  // Adds a pairing of sensortime and the local time (micros()) it was read at
+  void observe(uint32_t sensortime, uint32_t local_us);
+  // Local time of a sensortime, which may lie up to half a wrap (~5.5 min)
+  // either side of the last observation
+  uint32_t to_local_us(uint32_t sensortime) const;
+  // Duration of one sensortime tick in seconds, drift corrected
+  float get_tick_s() const;
+
+  bool has_reference() const { return this->observations_ != 0; }
+  bool is_locked() const { return this->observations_ >= CLOCK_LOCK_OBSERVATIONS; }
+  // Sensor oscillator error relative to the local clock, in ppm
+  float get_drift_ppm() const;
+  // Mean and worst absolute prediction error of recent observations, in us
+  uint32_t get_jitter_us() const { return this->jitter_us_; }
+  uint32_t get_max_jitter_us() const { return this->max_jitter_us_; }
+  void reset_max_jitter() { this->max_jitter_us_ = 0; }
+  uint32_t get_resyncs() const { return this->resyncs_; }
+  void reset();
+
+ protected:
+  void seed_(uint32_t sensortime, uint32_t local_us);
+  void clamp_rate_();
+
+  uint32_t ref_ticks_{0};
+  uint32_t ref_local_us_{0};
+  // Local microseconds per sensortime tick, Q24 fixed point
+  int64_t rate_q24_{0};
+  uint32_t observations_{0};
+  uint32_t jitter_us_{0};
+  uint32_t max_jitter_us_{0};
+  uint32_t resyncs_{0};
+};
+
+// Offset of a sample taken at b_us from the nearest sample of a stream that
+// sampled at a_us with the given period, within +/-period/2
+int32_t sample_phase_offset_us(uint32_t a_us, uint32_t b_us, uint32_t period_us);
+
+}  // namespace bmi270
+}  // namespace esphome
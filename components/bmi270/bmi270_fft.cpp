@@ -0,0 +1,185 @@
+#include "bmi270_fft.h"
+
+#include <math.h>
+
+#if defined(USE_ESP32) && __has_include(<esp_dsp.h>)
+#include <esp_dsp.h>
+#define BMI270_USE_ESP_DSP
+#endif
+
+namespace esphome {
+namespace bmi270 {
+
+static const float TWO_PI_F = 6.28318530718f;
+
+void SpectrumAnalyzer::init(float sample_rate) {
+  this->sample_rate_ = sample_rate;
+  this->window_sum_ = 0.0f;
+  this->window_sum_sq_ = 0.0f;
+  for (uint16_t n = 0; n < SIZE; n++) {
+    // Periodic Hann
+    float w = 0.5f - 0.5f * cosf(TWO_PI_F * n / SIZE);
+    this->window_[n] = w;
+    this->window_sum_ += w;
+    this->window_sum_sq_ += w * w;
+  }
+  for (uint16_t k = 0; k < SIZE / 2; k++) {
+    this->twiddle_[2 * k] = cosf(TWO_PI_F * k / SIZE);
+    this->twiddle_[2 * k + 1] = -sinf(TWO_PI_F * k / SIZE);
+  }
+#ifdef BMI270_USE_ESP_DSP
+  dsps_fft2r_init_fc32(nullptr, SIZE / 2);
+#endif
+  this->fill_ = 0;
+  this->reset_average();
+}
+
+void SpectrumAnalyzer::reset_average() {
+  for (uint16_t k = 0; k < BINS; k++)
+    this->power_[k] = 0.0f;
+  this->blocks_ = 0;
+}
+
+bool SpectrumAnalyzer::add_sample(float x) {
+  this->buffer_[this->fill_++] = x;
+  if (this->fill_ < SIZE)
+    return false;
+  this->fill_ = 0;
+  this->transform_();
+  return true;
+}
+
+#ifndef BMI270_USE_ESP_DSP
+// In-place iterative radix-2 DIT FFT over m interleaved complex values.
+// Twiddles for size m are every (SIZE / m)-th entry of the SIZE table.
+static void fft_radix2(float *data, uint16_t m, const float *twiddle) {
+  for (uint16_t i = 1, j = 0; i < m; i++) {
+    uint16_t bit = m >> 1;
+    for (; j & bit; bit >>= 1)
+      j ^= bit;
+    j ^= bit;
+    if (i < j) {
+      float tr = data[2 * i], ti = data[2 * i + 1];
+      data[2 * i] = data[2 * j];
+      data[2 * i + 1] = data[2 * j + 1];
+      data[2 * j] = tr;
+      data[2 * j + 1] = ti;
+    }
+  }
+  for (uint16_t len = 2; len <= m; len <<= 1) {
+    const uint16_t half = len >> 1;
+    const uint16_t stride = SpectrumAnalyzer::SIZE / len;
+    for (uint16_t start = 0; start < m; start += len) {
+      for (uint16_t k = 0; k < half; k++) {
+        const float wr = twiddle[2 * k * stride], wi = twiddle[2 * k * stride + 1];
+        float *a = &data[2 * (start + k)];
+        float *b = &data[2 * (start + k + half)];
+        float br = b[0] * wr - b[1] * wi;
+        float bi = b[0] * wi + b[1] * wr;
+        b[0] = a[0] - br;
+        b[1] = a[1] - bi;
+        a[0] += br;
+        a[1] += bi;
+      }
+    }
+  }
+}
+#endif
+
+void SpectrumAnalyzer::transform_() {
+  // Remove the block mean so gravity does not leak into the low bins
+  float mean = 0.0f;
+  for (uint16_t n = 0; n < SIZE; n++)
+    mean += this->buffer_[n];
+  mean /= SIZE;
+  for (uint16_t n = 0; n < SIZE; n++)
+    this->buffer_[n] = (this->buffer_[n] - mean) * this->window_[n];
+
+  // Real FFT of SIZE points as a complex FFT of SIZE/2 points: even samples
+  // in the real part, odd samples in the imaginary part
+  const uint16_t m = SIZE / 2;
+  float *z = this->buffer_;
+#ifdef BMI270_USE_ESP_DSP
+  dsps_fft2r_fc32(z, m);
+  dsps_bit_rev_fc32(z, m);
+#else
+  fft_radix2(z, m, this->twiddle_);
+#endif
+
+  // Split into the spectrum of the real input:
+  // X[k] = (Z[k] + conj(Z[m-k])) / 2 - i/2 * W^k * (Z[k] - conj(Z[m-k]))
+  for (uint16_t k = 0; k <= m / 2; k++) {
+    uint16_t mk = k == 0 ? 0 : m - k;
+    float zr = z[2 * k], zi = z[2 * k + 1];
+    float cr = z[2 * mk], ci = -z[2 * mk + 1];
+    float er = 0.5f * (zr + cr), ei = 0.5f * (zi + ci);
+    float dr = 0.5f * (zr - cr), di = 0.5f * (zi - ci);
+    // -i * d
+    float odr = di, odi = -dr;
+
+    // Bin k
+    float wr = this->twiddle_[2 * k], wi = this->twiddle_[2 * k + 1];
+    float xr = er + odr * wr - odi * wi;
+    float xi = ei + odr * wi + odi * wr;
+    this->power_[k] += xr * xr + xi * xi;
+
+    // Mirror bin m - k shares the same pair of Z values:
+    // E[m-k] = conj(E[k]) and O[m-k] = conj(O[k])
+    if (k != 0 && k != m - k) {
+      float er2 = er, ei2 = -ei;
+      float odr2 = odr, odi2 = -odi;
+      float wr2 = this->twiddle_[2 * (m - k)], wi2 = this->twiddle_[2 * (m - k) + 1];
+      float xr2 = er2 + odr2 * wr2 - odi2 * wi2;
+      float xi2 = ei2 + odr2 * wi2 + odi2 * wr2;
+      this->power_[m - k] += xr2 * xr2 + xi2 * xi2;
+    }
+  }
+  // Nyquist bin: Re(Z[0]) - Im(Z[0])
+  float nyquist = z[0] - z[1];
+  this->power_[m] += nyquist * nyquist;
+  this->blocks_++;
+}
+
+uint16_t SpectrumAnalyzer::peak_bin_() const {
+  uint16_t peak = 1;
+  for (uint16_t k = 2; k < BINS - 1; k++) {
+    if (this->power_[k] > this->power_[peak])
+      peak = k;
+  }
+  return peak;
+}
+
+float SpectrumAnalyzer::get_dominant_frequency() const {
+  if (this->blocks_ == 0)
+    return NAN;
+  uint16_t k = this->peak_bin_();
+  // Parabolic interpolation on the magnitudes around the peak
+  float a = sqrtf(this->power_[k - 1]), b = sqrtf(this->power_[k]), c = sqrtf(this->power_[k + 1]);
+  float denom = a - 2.0f * b + c;
+  float delta = denom != 0.0f ? 0.5f * (a - c) / denom : 0.0f;
+  return (k + delta) * this->get_bin_width();
+}
+
+float SpectrumAnalyzer::get_peak_amplitude() const {
+  if (this->blocks_ == 0)
+    return NAN;
+  float power = this->power_[this->peak_bin_()] / this->blocks_;
+  return 2.0f * sqrtf(power) / this->window_sum_;
+}
+
+float SpectrumAnalyzer::get_band_energy(float low, float high) const {
+  if (this->blocks_ == 0)
+    return NAN;
+  float bin_width = this->get_bin_width();
+  float sum = 0.0f;
+  for (uint16_t k = 1; k < BINS; k++) {
+    float f = k * bin_width;
+    if (f >= low && f <= high)
+      sum += this->power_[k];
+  }
+  // Parseval over the one-sided spectrum, corrected for the window power
+  return 2.0f * sum / (this->blocks_ * (float) SIZE * this->window_sum_sq_);
+}
+
+}  // namespace bmi270
+}  // namespace esphome
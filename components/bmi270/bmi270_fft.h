@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+
+// Block spectrum analysis: Hann-windowed real FFT over fixed-size blocks,
+// power averaged across blocks until read out. All buffers are members of
+// fixed size, nothing is allocated. Uses ESP-DSP's radix-2 kernel when it
+// is available and a portable radix-2 kernel otherwise; kept free of
+// ESPHome dependencies so it can be checked against known sines on the host.
+
+#ifndef BMI270_FFT_SIZE
+#define BMI270_FFT_SIZE 256
+#endif
+
+namespace esphome {
+namespace bmi270 {
+
+static_assert(BMI270_FFT_SIZE >= 16 && (BMI270_FFT_SIZE & (BMI270_FFT_SIZE - 1)) == 0,
+              "BMI270_FFT_SIZE must be a power of two");
+
+class SpectrumAnalyzer {
+ public:
+  static const uint16_t SIZE = BMI270_FFT_SIZE;
+  static const uint16_t BINS = SIZE / 2 + 1;
+
+  // Builds the window and twiddle tables
+  void init(float sample_rate);
+
+  // Appends one sample; transforms the block once it is full. Returns true
+  // when a block was added to the average.
+  bool add_sample(float x);
+
+  uint16_t get_blocks() const { return this->blocks_; }
+  float get_bin_width() const { return this->sample_rate_ / SIZE; }
+  // Interpolated frequency of the strongest bin (DC excluded), in Hz
+  float get_dominant_frequency() const;
+  // Amplitude of a sine at the strongest bin, in input units
+  float get_peak_amplitude() const;
+  // Mean-square signal in [low, high] Hz (input units squared)
+  float get_band_energy(float low, float high) const;
+  // Start a new average
+  void reset_average();
+
+ protected:
+  void transform_();
+  uint16_t peak_bin_() const;
+
+  float sample_rate_{0.0f};
+  float window_sum_{0.0f};
+  float window_sum_sq_{0.0f};
+  float window_[SIZE];
+  // e^(-2*pi*i*k/SIZE) for k < SIZE/2 as interleaved cos/sin pairs
+  float twiddle_[SIZE];
+  // Input block, transformed in place as SIZE/2 interleaved complex values
+  float buffer_[SIZE];
+  uint16_t fill_{0};
+  float power_[BINS];
+  uint16_t blocks_{0};
+};
+
+}  // namespace bmi270
+}  // namespace esphome
@@ -0,0 +1,154 @@
+#include "bmi270_fifo.h"
+
+namespace esphome {
+namespace bmi270 {
+
+static inline int16_t fifo_word(const uint8_t *data) { return (int16_t)(data[0] | (data[1] << 8)); }
+
+static inline void fifo_axes(const uint8_t *data, int16_t *axes) {
+  axes[0] = fifo_word(&data[0]);
+  axes[1] = fifo_word(&data[2]);
+  axes[2] = fifo_word(&data[4]);
+}
+
+uint16_t FifoParser::parse(const uint8_t *data, uint16_t len, ImuSample *samples, uint16_t max_samples) {
+  this->has_sensortime_ = false;
+  this->has_aux_ = false;
+  this->skipped_frames_ = 0;
+  this->dropped_frames_ = 0;
+  if (this->mode_ == FIFO_MODE_HEADERLESS)
+    return this->parse_headerless_(data, len, samples, max_samples);
+  return this->parse_header_(data, len, samples, max_samples);
+}
+
+uint16_t FifoParser::parse_header_(const uint8_t *data, uint16_t len, ImuSample *samples, uint16_t max_samples) {
+  uint16_t n = 0;
+  uint16_t index = 0;
+
+  while (index < len) {
+    uint8_t header = data[index] & BMI2_FIFO_HEADER_MASK;
+    index++;
+
+    if ((header & 0xC0) == BMI2_FIFO_HEADER_REG_FRM) {
+      // Over-read marker: no more valid frames
+      if (header == BMI2_FIFO_HEADER_EMPTY)
+        break;
+
+      uint16_t frame_len = 0;
+      if (header & BMI2_FIFO_HEADER_AUX_BIT)
+        frame_len += BMI2_FIFO_AUX_LENGTH;
+      if (header & BMI2_FIFO_HEADER_GYR_BIT)
+        frame_len += BMI2_FIFO_GYR_LENGTH;
+      if (header & BMI2_FIFO_HEADER_ACC_BIT)
+        frame_len += BMI2_FIFO_ACC_LENGTH;
+      if (index + frame_len > len) {
+        this->dropped_frames_++;
+        break;
+      }
+
+      // Payload order is aux, gyr, acc
+      const uint8_t *payload = &data[index];
+      if (header & BMI2_FIFO_HEADER_AUX_BIT) {
+        // Aux runs slower than accel/gyro; only the newest frame is kept
+        for (uint8_t i = 0; i < BMI2_FIFO_AUX_LENGTH; i++)
+          this->aux_[i] = payload[i];
+        this->has_aux_ = true;
+        payload += BMI2_FIFO_AUX_LENGTH;
+      }
+      if (header & BMI2_FIFO_HEADER_GYR_BIT) {
+        fifo_axes(payload, this->last_.gyr);
+        payload += BMI2_FIFO_GYR_LENGTH;
+      }
+      if (header & BMI2_FIFO_HEADER_ACC_BIT)
+        fifo_axes(payload, this->last_.acc);
+      index += frame_len;
+
+      if (header & (BMI2_FIFO_HEADER_ACC_BIT | BMI2_FIFO_HEADER_GYR_BIT)) {
+        if (n >= max_samples) {
+          this->dropped_frames_++;
+          continue;
+        }
+        samples[n] = this->last_;
+        samples[n].sensortime = 0;
+        n++;
+      }
+      continue;
+    }
+
+    uint16_t payload_len;
+    switch (header) {
+      case BMI2_FIFO_HEADER_SKIP_FRM:
+        payload_len = BMI2_FIFO_SKIP_FRM_LENGTH;
+        break;
+      case BMI2_FIFO_HEADER_SENS_TIME_FRM:
+        payload_len = BMI2_FIFO_SENS_TIME_LENGTH;
+        break;
+      case BMI2_FIFO_HEADER_INPUT_CFG_FRM:
+        payload_len = BMI2_FIFO_INPUT_CFG_LENGTH;
+        break;
+      case BMI2_FIFO_HEADER_SAMPLE_DROP_FRM:
+        payload_len = BMI2_FIFO_SAMPLE_DROP_LENGTH;
+        break;
+      default:
+        // Unknown header, the rest of the buffer cannot be framed
+        this->dropped_frames_++;
+        return n;
+    }
+    if (index + payload_len > len)
+      break;
+
+    if (header == BMI2_FIFO_HEADER_SENS_TIME_FRM) {
+      this->sensortime_ = data[index] | (data[index + 1] << 8) | ((uint32_t) data[index + 2] << 16);
+      this->has_sensortime_ = true;
+    } else if (header == BMI2_FIFO_HEADER_SKIP_FRM) {
+      // Payload holds the number of frames lost to overflow
+      this->skipped_frames_ += data[index];
+    }
+    index += payload_len;
+  }
+
+  return n;
+}
+
+uint16_t FifoParser::parse_headerless_(const uint8_t *data, uint16_t len, ImuSample *samples,
+                                       uint16_t max_samples) {
+  // Headerless frames always carry gyr followed by acc
+  const uint16_t frame_len = BMI2_FIFO_GYR_LENGTH + BMI2_FIFO_ACC_LENGTH;
+  uint16_t n = 0;
+
+  for (uint16_t index = 0; index + frame_len <= len; index += frame_len) {
+    const uint8_t *frame = &data[index];
+    uint16_t gyr_word = (uint16_t) fifo_word(&frame[0]);
+    uint16_t acc_word = (uint16_t) fifo_word(&frame[BMI2_FIFO_GYR_LENGTH]);
+
+    if (gyr_word == BMI2_FIFO_OVER_READ_WORD && acc_word == BMI2_FIFO_OVER_READ_WORD)
+      break;
+    if (gyr_word == BMI2_FIFO_GYR_DUMMY_WORD || acc_word == BMI2_FIFO_ACC_DUMMY_WORD) {
+      this->skipped_frames_++;
+      continue;
+    }
+    if (n >= max_samples) {
+      this->dropped_frames_++;
+      continue;
+    }
+
+    fifo_axes(&frame[0], this->last_.gyr);
+    fifo_axes(&frame[BMI2_FIFO_GYR_LENGTH], this->last_.acc);
+    samples[n] = this->last_;
+    samples[n].sensortime = 0;
+    n++;
+  }
+
+  return n;
+}
+
+void FifoParser::assign_sensortime(ImuSample *samples, uint16_t n, uint32_t last_sensortime, uint32_t period_ticks) {
+  // The sensortime frame follows the newest data frame
+  for (uint16_t i = 0; i < n; i++) {
+    uint32_t age = (uint32_t)(n - 1 - i) * period_ticks;
+    samples[i].sensortime = (last_sensortime - age) & BMI2_SENSORTIME_MASK;
+  }
+}
+
+}  // namespace bmi270
+}  // namespace esphome
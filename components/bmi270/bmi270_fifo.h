@@ -0,0 +1,100 @@
+#pragma once
+
+#include <stdint.h>
+
+// BMI270 FIFO frame parser. Kept free of ESPHome dependencies so it can be
+// built on the host and fed with recorded FIFO byte dumps.
+
+// Header mode frame headers. The two low bits (fh_ext) carry interrupt tags
+// and are masked off before matching.
+#define BMI2_FIFO_HEADER_MASK 0xFC
+#define BMI2_FIFO_HEADER_REG_FRM 0x80
+#define BMI2_FIFO_HEADER_ACC_BIT 0x04
+#define BMI2_FIFO_HEADER_GYR_BIT 0x08
+#define BMI2_FIFO_HEADER_AUX_BIT 0x10
+#define BMI2_FIFO_HEADER_SKIP_FRM 0x40
+#define BMI2_FIFO_HEADER_SENS_TIME_FRM 0x44
+#define BMI2_FIFO_HEADER_INPUT_CFG_FRM 0x48
+#define BMI2_FIFO_HEADER_SAMPLE_DROP_FRM 0x50
+#define BMI2_FIFO_HEADER_EMPTY 0x80
+
+// Payload lengths in bytes
+#define BMI2_FIFO_ACC_LENGTH 6
+#define BMI2_FIFO_GYR_LENGTH 6
+#define BMI2_FIFO_AUX_LENGTH 8
+#define BMI2_FIFO_SKIP_FRM_LENGTH 1
+#define BMI2_FIFO_SENS_TIME_LENGTH 3
+#define BMI2_FIFO_INPUT_CFG_LENGTH 4
+#define BMI2_FIFO_SAMPLE_DROP_LENGTH 1
+
+// Headerless mode markers (little-endian 16-bit words)
+#define BMI2_FIFO_OVER_READ_WORD 0x8000
+#define BMI2_FIFO_ACC_DUMMY_WORD 0x7F01
+#define BMI2_FIFO_GYR_DUMMY_WORD 0x7F02
+
+// The BMI270 FIFO is 2 KB; the buffer leaves room for the sensortime frame
+// that is appended after the last data frame.
+#define BMI2_FIFO_SIZE 2048
+#define BMI2_FIFO_BUFFER_SIZE (BMI2_FIFO_SIZE + 1 + BMI2_FIFO_SENS_TIME_LENGTH)
+#define BMI2_FIFO_MAX_SAMPLES (BMI2_FIFO_SIZE / (BMI2_FIFO_ACC_LENGTH + BMI2_FIFO_GYR_LENGTH) + 1)
+
+// Sensortime runs at 25.6 kHz (39.0625 us per tick) and wraps at 24 bits
+#define BMI2_SENSORTIME_MASK 0x00FFFFFF
+
+namespace esphome {
+namespace bmi270 {
+
+enum FifoMode {
+  FIFO_MODE_DISABLED = 0,
+  FIFO_MODE_HEADER = 1,
+  FIFO_MODE_HEADERLESS = 2,
+};
+
+struct ImuSample {
+  int16_t acc[3];
+  int16_t gyr[3];
+  uint32_t sensortime;  // 24-bit sensortime ticks, only valid if the batch carried one
+  uint32_t timestamp_us;  // local micros() of the sample, filled in after the read
+};
+
+class FifoParser {
+ public:
+  void set_mode(FifoMode mode) { this->mode_ = mode; }
+  FifoMode get_mode() const { return this->mode_; }
+
+  // Parse len bytes of raw FIFO data into at most max_samples samples and
+  // return the number of samples written. A frame that is cut short at the
+  // end of the buffer is dropped; the chip re-sends it on the next read.
+  uint16_t parse(const uint8_t *data, uint16_t len, ImuSample *samples, uint16_t max_samples);
+
+  bool has_sensortime() const { return this->has_sensortime_; }
+  uint32_t get_sensortime() const { return this->sensortime_; }
+  // Newest aux (magnetometer) payload of the last parse, header mode only
+  bool has_aux() const { return this->has_aux_; }
+  const uint8_t *get_aux() const { return this->aux_; }
+  uint16_t get_skipped_frames() const { return this->skipped_frames_; }
+  uint16_t get_dropped_frames() const { return this->dropped_frames_; }
+
+  // Spread sensortime stamps backwards from the sensortime frame, one ODR
+  // period per sample.
+  static void assign_sensortime(ImuSample *samples, uint16_t n, uint32_t last_sensortime, uint32_t period_ticks);
+  // Sensortime ticks per sample for a BMI2 ODR register code (0x08 = 100 Hz)
+  static uint32_t odr_to_ticks(uint8_t odr) { return odr >= 1 && odr <= 0x0D ? (1UL << (16 - odr)) : 256; }
+
+ protected:
+  uint16_t parse_header_(const uint8_t *data, uint16_t len, ImuSample *samples, uint16_t max_samples);
+  uint16_t parse_headerless_(const uint8_t *data, uint16_t len, ImuSample *samples, uint16_t max_samples);
+
+  FifoMode mode_{FIFO_MODE_HEADER};
+  bool has_sensortime_{false};
+  uint32_t sensortime_{0};
+  bool has_aux_{false};
+  uint8_t aux_[BMI2_FIFO_AUX_LENGTH]{};
+  uint16_t skipped_frames_{0};
+  uint16_t dropped_frames_{0};
+  // Last complete values, used when a header frame carries only one sensor
+  ImuSample last_{};
+};
+
+}  // namespace bmi270
+}  // namespace esphome
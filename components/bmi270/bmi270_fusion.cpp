@@ -0,0 +1,197 @@
+#include "bmi270_fusion.h"
+
+#include <math.h>
+
+namespace esphome {
+namespace bmi270 {
+
+static const float RAD_TO_DEG_F = 57.29577951f;
+
+static inline float inv_sqrt(float x) { return 1.0f / sqrtf(x); }
+
+void MadgwickFilter::reset() {
+  this->q0_ = 1.0f;
+  this->q1_ = this->q2_ = this->q3_ = 0.0f;
+  this->initialized_ = false;
+}
+
+float tilt_compensated_yaw(float ax, float ay, float az, float mx, float my, float mz) {
+  float roll = atan2f(ay, az);
+  float pitch = atan2f(-ax, sqrtf(ay * ay + az * az));
+  float cr = cosf(roll), sr = sinf(roll);
+  float cp = cosf(pitch), sp = sinf(pitch);
+  // Magnetometer rotated back to the horizontal plane
+  float hx = mx * cp + my * sr * sp + mz * cr * sp;
+  float hy = my * cr - mz * sr;
+  return atan2f(-hy, hx);
+}
+
+void MadgwickFilter::seed_from_gravity_(float ax, float ay, float az, float yaw) {
+  // Start from the accel-derived tilt (and compass yaw, when there is one)
+  // instead of converging from identity over several seconds
+  float roll = atan2f(ay, az);
+  float pitch = atan2f(-ax, sqrtf(ay * ay + az * az));
+  float cr = cosf(roll * 0.5f), sr = sinf(roll * 0.5f);
+  float cp = cosf(pitch * 0.5f), sp = sinf(pitch * 0.5f);
+  float cy = cosf(yaw * 0.5f), sy = sinf(yaw * 0.5f);
+  this->q0_ = cr * cp * cy + sr * sp * sy;
+  this->q1_ = sr * cp * cy - cr * sp * sy;
+  this->q2_ = cr * sp * cy + sr * cp * sy;
+  this->q3_ = cr * cp * sy - sr * sp * cy;
+  this->initialized_ = true;
+}
+
+void MadgwickFilter::normalize_() {
+  float recip_norm = inv_sqrt(this->q0_ * this->q0_ + this->q1_ * this->q1_ + this->q2_ * this->q2_ +
+                              this->q3_ * this->q3_);
+  this->q0_ *= recip_norm;
+  this->q1_ *= recip_norm;
+  this->q2_ *= recip_norm;
+  this->q3_ *= recip_norm;
+}
+
+void MadgwickFilter::update_imu(float gx, float gy, float gz, float ax, float ay, float az, float dt) {
+  bool has_accel = !(ax == 0.0f && ay == 0.0f && az == 0.0f);
+  if (!this->initialized_) {
+    if (!has_accel)
+      return;
+    this->seed_from_gravity_(ax, ay, az);
+    return;
+  }
+
+  float q0 = this->q0_, q1 = this->q1_, q2 = this->q2_, q3 = this->q3_;
+
+  // Rate of change of quaternion from gyroscope
+  float q_dot1 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+  float q_dot2 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+  float q_dot3 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+  float q_dot4 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+
+  if (has_accel) {
+    float recip_norm = inv_sqrt(ax * ax + ay * ay + az * az);
+    ax *= recip_norm;
+    ay *= recip_norm;
+    az *= recip_norm;
+
+    float _2q0 = 2.0f * q0, _2q1 = 2.0f * q1, _2q2 = 2.0f * q2, _2q3 = 2.0f * q3;
+    float _4q0 = 4.0f * q0, _4q1 = 4.0f * q1, _4q2 = 4.0f * q2;
+    float _8q1 = 8.0f * q1, _8q2 = 8.0f * q2;
+    float q0q0 = q0 * q0, q1q1 = q1 * q1, q2q2 = q2 * q2, q3q3 = q3 * q3;
+
+    // Gradient descent corrective step
+    float s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+    float s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+    float s2 = 4.0f * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+    float s3 = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
+    float s_norm = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+    if (s_norm > 0.0f) {
+      recip_norm = inv_sqrt(s_norm);
+      q_dot1 -= this->beta_ * s0 * recip_norm;
+      q_dot2 -= this->beta_ * s1 * recip_norm;
+      q_dot3 -= this->beta_ * s2 * recip_norm;
+      q_dot4 -= this->beta_ * s3 * recip_norm;
+    }
+  }
+
+  this->q0_ = q0 + q_dot1 * dt;
+  this->q1_ = q1 + q_dot2 * dt;
+  this->q2_ = q2 + q_dot3 * dt;
+  this->q3_ = q3 + q_dot4 * dt;
+  this->normalize_();
+}
+
+void MadgwickFilter::update_marg(float gx, float gy, float gz, float ax, float ay, float az, float mx, float my,
+                                 float mz, float dt) {
+  if (mx == 0.0f && my == 0.0f && mz == 0.0f) {
+    this->update_imu(gx, gy, gz, ax, ay, az, dt);
+    return;
+  }
+  bool has_accel = !(ax == 0.0f && ay == 0.0f && az == 0.0f);
+  if (!this->initialized_) {
+    if (!has_accel)
+      return;
+    this->seed_from_gravity_(ax, ay, az, tilt_compensated_yaw(ax, ay, az, mx, my, mz));
+    return;
+  }
+  if (!has_accel) {
+    this->update_imu(gx, gy, gz, ax, ay, az, dt);
+    return;
+  }
+
+  float q0 = this->q0_, q1 = this->q1_, q2 = this->q2_, q3 = this->q3_;
+
+  // Rate of change of quaternion from gyroscope
+  float q_dot1 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+  float q_dot2 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+  float q_dot3 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+  float q_dot4 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+
+  float recip_norm = inv_sqrt(ax * ax + ay * ay + az * az);
+  ax *= recip_norm;
+  ay *= recip_norm;
+  az *= recip_norm;
+  recip_norm = inv_sqrt(mx * mx + my * my + mz * mz);
+  mx *= recip_norm;
+  my *= recip_norm;
+  mz *= recip_norm;
+
+  float _2q0mx = 2.0f * q0 * mx, _2q0my = 2.0f * q0 * my, _2q0mz = 2.0f * q0 * mz, _2q1mx = 2.0f * q1 * mx;
+  float _2q0 = 2.0f * q0, _2q1 = 2.0f * q1, _2q2 = 2.0f * q2, _2q3 = 2.0f * q3;
+  float _2q0q2 = 2.0f * q0 * q2, _2q2q3 = 2.0f * q2 * q3;
+  float q0q0 = q0 * q0, q0q1 = q0 * q1, q0q2 = q0 * q2, q0q3 = q0 * q3;
+  float q1q1 = q1 * q1, q1q2 = q1 * q2, q1q3 = q1 * q3;
+  float q2q2 = q2 * q2, q2q3 = q2 * q3, q3q3 = q3 * q3;
+
+  // Reference direction of the Earth's magnetic field
+  float hx = mx * q0q0 - _2q0my * q3 + _2q0mz * q2 + mx * q1q1 + _2q1 * my * q2 + _2q1 * mz * q3 - mx * q2q2 -
+             mx * q3q3;
+  float hy = _2q0mx * q3 + my * q0q0 - _2q0mz * q1 + _2q1mx * q2 - my * q1q1 + my * q2q2 + _2q2 * mz * q3 - my * q3q3;
+  float _2bx = sqrtf(hx * hx + hy * hy);
+  float _2bz = -_2q0mx * q2 + _2q0my * q1 + mz * q0q0 + _2q1mx * q3 - mz * q1q1 + _2q2 * my * q3 - mz * q2q2 +
+               mz * q3q3;
+  float _4bx = 2.0f * _2bx, _4bz = 2.0f * _2bz;
+
+  // Gradient descent corrective step
+  float fa_x = 2.0f * q1q3 - _2q0q2 - ax;
+  float fa_y = 2.0f * q0q1 + _2q2q3 - ay;
+  float fa_z = 1.0f - 2.0f * q1q1 - 2.0f * q2q2 - az;
+  float fm_x = _2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx;
+  float fm_y = _2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my;
+  float fm_z = _2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz;
+  float s0 = -_2q2 * fa_x + _2q1 * fa_y - _2bz * q2 * fm_x + (-_2bx * q3 + _2bz * q1) * fm_y + _2bx * q2 * fm_z;
+  float s1 = _2q3 * fa_x + _2q0 * fa_y - 4.0f * q1 * fa_z + _2bz * q3 * fm_x + (_2bx * q2 + _2bz * q0) * fm_y +
+             (_2bx * q3 - _4bz * q1) * fm_z;
+  float s2 = -_2q0 * fa_x + _2q3 * fa_y - 4.0f * q2 * fa_z + (-_4bx * q2 - _2bz * q0) * fm_x +
+             (_2bx * q1 + _2bz * q3) * fm_y + (_2bx * q0 - _4bz * q2) * fm_z;
+  float s3 = _2q1 * fa_x + _2q2 * fa_y + (-_4bx * q3 + _2bz * q1) * fm_x + (-_2bx * q0 + _2bz * q2) * fm_y +
+             _2bx * q1 * fm_z;
+  float s_norm = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+  if (s_norm > 0.0f) {
+    recip_norm = inv_sqrt(s_norm);
+    q_dot1 -= this->beta_ * s0 * recip_norm;
+    q_dot2 -= this->beta_ * s1 * recip_norm;
+    q_dot3 -= this->beta_ * s2 * recip_norm;
+    q_dot4 -= this->beta_ * s3 * recip_norm;
+  }
+
+  this->q0_ = q0 + q_dot1 * dt;
+  this->q1_ = q1 + q_dot2 * dt;
+  this->q2_ = q2 + q_dot3 * dt;
+  this->q3_ = q3 + q_dot4 * dt;
+  this->normalize_();
+}
+
+void MadgwickFilter::get_euler(float *roll, float *pitch, float *yaw) const {
+  float q0 = this->q0_, q1 = this->q1_, q2 = this->q2_, q3 = this->q3_;
+  float sin_pitch = -2.0f * (q1 * q3 - q0 * q2);
+  if (sin_pitch > 1.0f)
+    sin_pitch = 1.0f;
+  if (sin_pitch < -1.0f)
+    sin_pitch = -1.0f;
+  *roll = atan2f(q0 * q1 + q2 * q3, 0.5f - q1 * q1 - q2 * q2) * RAD_TO_DEG_F;
+  *pitch = asinf(sin_pitch) * RAD_TO_DEG_F;
+  *yaw = atan2f(q1 * q2 + q0 * q3, 0.5f - q2 * q2 - q3 * q3) * RAD_TO_DEG_F;
+}
+
+}  // namespace bmi270
+}  // namespace esphome
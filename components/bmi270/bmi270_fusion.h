@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+
+// Madgwick orientation filter. Runs once per IMU sample at the native ODR;
+// kept free of ESPHome dependencies so it can be benchmarked on the host.
+
+namespace esphome {
+namespace bmi270 {
+
+// Yaw in radians of a tilt-compensated compass, in the filter's convention
+// (counterclockwise about +Z from magnetic north)
+float tilt_compensated_yaw(float ax, float ay, float az, float mx, float my, float mz);
+
+class MadgwickFilter {
+ public:
+  void set_beta(float beta) { this->beta_ = beta; }
+  float get_beta() const { return this->beta_; }
+
+  // Forget the current orientation; the next update re-seeds it from gravity
+  void reset();
+
+  // Gyro in rad/s, accel in any unit (only its direction is used), dt in s
+  void update_imu(float gx, float gy, float gz, float ax, float ay, float az, float dt);
+  // As update_imu, with a magnetometer (any unit) correcting yaw. A zero
+  // magnetometer vector falls back to update_imu.
+  void update_marg(float gx, float gy, float gz, float ax, float ay, float az, float mx, float my, float mz,
+                   float dt);
+
+  bool is_initialized() const { return this->initialized_; }
+  float get_w() const { return this->q0_; }
+  float get_x() const { return this->q1_; }
+  float get_y() const { return this->q2_; }
+  float get_z() const { return this->q3_; }
+
+  // Roll, pitch and yaw in degrees
+  void get_euler(float *roll, float *pitch, float *yaw) const;
+
+ protected:
+  void seed_from_gravity_(float ax, float ay, float az, float yaw = 0.0f);
+  void normalize_();
+
+  float beta_{0.1f};
+  float q0_{1.0f};
+  float q1_{0.0f};
+  float q2_{0.0f};
+  float q3_{0.0f};
+  bool initialized_{false};
+};
+
+}  // namespace bmi270
+}  // namespace esphome
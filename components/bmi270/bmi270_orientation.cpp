@@ -0,0 +1,118 @@
+#include "bmi270_orientation.h"
+
+#include <math.h>
+
+namespace esphome {
+namespace bmi270 {
+
+static const float DEG_TO_RAD_F = 0.01745329252f;
+
+const char *orientation_to_string(Orientation orientation) {
+  switch (orientation) {
+    case ORIENTATION_PORTRAIT:
+      return "Portrait";
+    case ORIENTATION_LANDSCAPE:
+      return "Landscape";
+    case ORIENTATION_PORTRAIT_INVERTED:
+      return "Portrait Inverted";
+    case ORIENTATION_LANDSCAPE_INVERTED:
+      return "Landscape Inverted";
+    case ORIENTATION_FACE_UP:
+      return "Face Up";
+    case ORIENTATION_FACE_DOWN:
+      return "Face Down";
+    default:
+      return "Unknown";
+  }
+}
+
+int16_t orientation_rotation(Orientation orientation) {
+  switch (orientation) {
+    case ORIENTATION_PORTRAIT:
+      return 0;
+    case ORIENTATION_LANDSCAPE:
+      return 90;
+    case ORIENTATION_PORTRAIT_INVERTED:
+      return 180;
+    case ORIENTATION_LANDSCAPE_INVERTED:
+      return 270;
+    default:
+      return -1;
+  }
+}
+
+static float tan_sq(float deg) {
+  float t = tanf(deg * DEG_TO_RAD_F);
+  return t * t;
+}
+
+void OrientationDetector::configure(float flat_angle_deg, float hysteresis_deg, uint32_t hold_ms) {
+  this->flat_angle_deg_ = flat_angle_deg;
+  this->hysteresis_deg_ = hysteresis_deg;
+  this->hold_ms_ = hold_ms;
+  this->flat_enter_ = tan_sq(flat_angle_deg);
+  this->flat_exit_ = tan_sq(flat_angle_deg + hysteresis_deg);
+  // Half the band on either side of the 45° diagonal
+  this->edge_switch_ = tan_sq(45.0f + hysteresis_deg * 0.5f);
+}
+
+Orientation OrientationDetector::classify_(float x, float y, float z) const {
+  float x2 = x * x, y2 = y * y, z2 = z * z;
+  if (x2 + y2 + z2 == 0.0f)
+    return this->current_;
+
+  // Flat while the in-plane component stays within the flat angle of the
+  // horizontal; leaving takes the hysteresis on top
+  bool flat = this->current_ == ORIENTATION_FACE_UP || this->current_ == ORIENTATION_FACE_DOWN;
+  if (x2 + y2 <= z2 * (flat ? this->flat_exit_ : this->flat_enter_))
+    return z > 0.0f ? ORIENTATION_FACE_UP : ORIENTATION_FACE_DOWN;
+
+  // Edge-on: the axis closest to vertical wins, but the current one is kept
+  // until the other leads by half the hysteresis past the diagonal
+  bool portrait;
+  switch (this->current_) {
+    case ORIENTATION_PORTRAIT:
+    case ORIENTATION_PORTRAIT_INVERTED:
+      portrait = x2 <= y2 * this->edge_switch_;
+      break;
+    case ORIENTATION_LANDSCAPE:
+    case ORIENTATION_LANDSCAPE_INVERTED:
+      portrait = y2 > x2 * this->edge_switch_;
+      break;
+    default:
+      portrait = y2 >= x2;
+      break;
+  }
+  if (portrait)
+    return y > 0.0f ? ORIENTATION_PORTRAIT : ORIENTATION_PORTRAIT_INVERTED;
+  return x < 0.0f ? ORIENTATION_LANDSCAPE : ORIENTATION_LANDSCAPE_INVERTED;
+}
+
+bool OrientationDetector::update(float x, float y, float z, uint32_t now_ms) {
+  Orientation orientation = this->classify_(x, y, z);
+  if (orientation == this->current_) {
+    this->candidate_ = orientation;
+    return false;
+  }
+  if (orientation != this->candidate_) {
+    this->candidate_ = orientation;
+    this->candidate_since_ms_ = now_ms;
+  }
+  // The first classification is reported at once
+  if (this->current_ != ORIENTATION_UNKNOWN && now_ms - this->candidate_since_ms_ < this->hold_ms_)
+    return false;
+  this->current_ = orientation;
+  return true;
+}
+
+bool OrientationDetector::settle(float x, float y, float z) {
+  Orientation orientation = this->classify_(x, y, z);
+  this->candidate_ = orientation;
+  if (orientation == this->current_)
+    return false;
+  this->current_ = orientation;
+  return true;
+}
+
+}  // namespace bmi270
+}  // namespace esphome
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdint.h>
+
+// Screen orientation from the gravity vector, with angular hysteresis and a
+// hold time so a device held near a boundary does not flip back and forth.
+// Kept free of ESPHome dependencies so it can be exercised on the host.
+
+namespace esphome {
+namespace bmi270 {
+
+// Named for a screen in the X/Y plane facing +Z: portrait is +Y up, and
+// each step turns the device a further 90° clockwise
+enum Orientation : uint8_t {
+  ORIENTATION_UNKNOWN = 0,
+  ORIENTATION_PORTRAIT,            // +Y up
+  ORIENTATION_LANDSCAPE,           // -X up
+  ORIENTATION_PORTRAIT_INVERTED,   // -Y up
+  ORIENTATION_LANDSCAPE_INVERTED,  // +X up
+  ORIENTATION_FACE_UP,             // flat, +Z up
+  ORIENTATION_FACE_DOWN,           // flat, +Z down
+};
+
+const char *orientation_to_string(Orientation orientation);
+// Clockwise turn from portrait in degrees (0, 90, 180, 270), or -1 when the
+// device lies flat or the orientation is not known yet
+int16_t orientation_rotation(Orientation orientation);
+
+class OrientationDetector {
+ public:
+  // flat_angle: tilt from horizontal still counted as face up/down.
+  // hysteresis: extra angle needed to leave the current orientation.
+  // hold_ms: how long a new orientation must persist before it is reported.
+  void configure(float flat_angle_deg, float hysteresis_deg, uint32_t hold_ms);
+
+  // Feeds one gravity estimate (any unit, only the direction is used).
+  // Returns true when the reported orientation changed.
+  bool update(float x, float y, float z, uint32_t now_ms);
+  // As update, but skips the hold time; for a reading taken once the
+  // device is known to be at rest
+  bool settle(float x, float y, float z);
+
+  Orientation get_orientation() const { return this->current_; }
+  float get_flat_angle() const { return this->flat_angle_deg_; }
+  float get_hysteresis() const { return this->hysteresis_deg_; }
+  uint32_t get_hold_time() const { return this->hold_ms_; }
+
+ protected:
+  Orientation classify_(float x, float y, float z) const;
+
+  float flat_angle_deg_{20.0f};
+  float hysteresis_deg_{10.0f};
+  uint32_t hold_ms_{500};
+  // Squared tangents of the thresholds, so classification needs no trig
+  float flat_enter_{0.1325f};   // tan²(20°)
+  float flat_exit_{0.3333f};    // tan²(30°)
+  float edge_switch_{1.4203f};  // tan²(50°)
+  Orientation current_{ORIENTATION_UNKNOWN};
+  Orientation candidate_{ORIENTATION_UNKNOWN};
+  uint32_t candidate_since_ms_{0};
+};
+
+}  // namespace bmi270
+}  // namespace esphome
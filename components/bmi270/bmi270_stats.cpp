@@ -0,0 +1,47 @@
+#include "bmi270_stats.h"
+
+#include <float.h>
+#include <math.h>
+
+namespace esphome {
+namespace bmi270 {
+
+void AxisStatistics::reset() {
+  this->count_ = 0;
+  this->mean_ = 0.0f;
+  this->m2_ = 0.0f;
+  this->sum_sq_ = 0.0f;
+  this->min_ = FLT_MAX;
+  this->max_ = -FLT_MAX;
+}
+
+float AxisStatistics::get(WindowStatistic statistic) const {
+  if (this->count_ == 0)
+    return NAN;
+  switch (statistic) {
+    case STATISTIC_MEAN:
+      return this->mean_;
+    case STATISTIC_RMS:
+      return sqrtf(this->sum_sq_ / this->count_);
+    case STATISTIC_PEAK_TO_PEAK:
+      return this->max_ - this->min_;
+    case STATISTIC_MIN:
+      return this->min_;
+    case STATISTIC_MAX:
+      return this->max_;
+    case STATISTIC_CREST_FACTOR: {
+      // Peak magnitude over RMS; 1.41 for a pure sine
+      float rms = sqrtf(this->sum_sq_ / this->count_);
+      float peak = fabsf(this->min_) > fabsf(this->max_) ? fabsf(this->min_) : fabsf(this->max_);
+      return rms > 0.0f ? peak / rms : NAN;
+    }
+    case STATISTIC_VARIANCE:
+      // Population variance over the window
+      return this->m2_ / this->count_;
+    default:
+      return NAN;
+  }
+}
+
+}  // namespace bmi270
+}  // namespace esphome
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <float.h>
+#include <stdint.h>
+
+// Windowed per-axis statistics, updated incrementally (Welford) per sample
+// with no allocation. Kept free of ESPHome dependencies so the kernels can
+// be benchmarked on the host.
+
+namespace esphome {
+namespace bmi270 {
+
+enum WindowStatistic : uint8_t {
+  STATISTIC_MEAN = 0,
+  STATISTIC_RMS,
+  STATISTIC_PEAK_TO_PEAK,
+  STATISTIC_MIN,
+  STATISTIC_MAX,
+  STATISTIC_CREST_FACTOR,
+  STATISTIC_VARIANCE,
+  STATISTIC_COUNT,
+};
+
+class AxisStatistics {
+ public:
+  void reset();
+  void add(float x) {
+    this->count_++;
+    float delta = x - this->mean_;
+    this->mean_ += delta / this->count_;
+    this->m2_ += delta * (x - this->mean_);
+    this->sum_sq_ += x * x;
+    if (x < this->min_)
+      this->min_ = x;
+    if (x > this->max_)
+      this->max_ = x;
+  }
+
+  uint32_t get_count() const { return this->count_; }
+  float get(WindowStatistic statistic) const;
+
+ protected:
+  uint32_t count_{0};
+  float mean_{0.0f};
+  float m2_{0.0f};
+  float sum_sq_{0.0f};
+  float min_{FLT_MAX};
+  float max_{-FLT_MAX};
+};
+
+}  // namespace bmi270
+}  // namespace esphome
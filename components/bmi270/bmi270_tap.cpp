@@ -0,0 +1,104 @@
+#include "bmi270_tap.h"
+
+namespace esphome {
+namespace bmi270 {
+
+// Baseline time constant: 2^BASELINE_SHIFT samples
+static const uint8_t BASELINE_SHIFT = 4;
+
+void TapDetector::configure(uint16_t threshold, uint16_t max_shock, uint16_t quiet, uint16_t double_tap_window) {
+  this->threshold_ = threshold;
+  this->max_shock_ = max_shock < 1 ? 1 : max_shock;
+  this->quiet_ = quiet;
+  this->double_tap_window_ = double_tap_window;
+  this->reset();
+}
+
+void TapDetector::reset() {
+  this->state_ = STATE_IDLE;
+  this->baseline_valid_ = false;
+  this->count_ = 0;
+  this->pending_ = 0;
+}
+
+TapEvent TapDetector::update(const int16_t *acc) {
+  if (!this->baseline_valid_) {
+    for (uint8_t i = 0; i < 3; i++)
+      this->baseline_[i] = (int32_t) acc[i] << BASELINE_SHIFT;
+    this->baseline_valid_ = true;
+    return TAP_EVENT_NONE;
+  }
+
+  // Largest deviation of any axis from the baseline (L-infinity, no sqrt)
+  int32_t peak = 0;
+  for (uint8_t i = 0; i < 3; i++) {
+    int32_t d = acc[i] - (this->baseline_[i] >> BASELINE_SHIFT);
+    if (d < 0)
+      d = -d;
+    if (d > peak)
+      peak = d;
+  }
+  bool above = peak > this->threshold_;
+
+  TapEvent event = TAP_EVENT_NONE;
+  if (this->pending_ != 0 && ++this->pending_ > this->double_tap_window_) {
+    // The window closed without a second tap
+    this->pending_ = 0;
+    event = TAP_EVENT_SINGLE;
+  }
+
+  switch (this->state_) {
+    case STATE_IDLE:
+      if (above) {
+        this->state_ = STATE_SHOCK;
+        this->count_ = 1;
+      }
+      break;
+    case STATE_SHOCK:
+      if (above) {
+        if (++this->count_ > this->max_shock_) {
+          // Too long for a tap: the device is being moved or shaken
+          this->state_ = STATE_SETTLE;
+          this->pending_ = 0;
+          this->rejected_++;
+        }
+        break;
+      }
+      this->taps_++;
+      this->state_ = STATE_QUIET;
+      if (this->pending_ != 0) {
+        this->pending_ = 0;
+        event = TAP_EVENT_DOUBLE;
+      } else if (this->double_tap_window_ != 0) {
+        this->pending_ = this->count_;
+      } else {
+        event = TAP_EVENT_SINGLE;
+      }
+      this->count_ = 0;
+      break;
+    case STATE_QUIET:
+      if (++this->count_ >= this->quiet_) {
+        this->state_ = STATE_IDLE;
+        this->count_ = 0;
+      }
+      break;
+    case STATE_SETTLE:
+      // Back below for a full quiet period before arming again
+      this->count_ = above ? 0 : this->count_ + 1;
+      if (this->count_ >= this->quiet_) {
+        this->state_ = STATE_IDLE;
+        this->count_ = 0;
+      }
+      break;
+  }
+
+  // Gravity is only tracked between events so a spike does not drag it
+  if (this->state_ == STATE_IDLE || this->state_ == STATE_SETTLE) {
+    for (uint8_t i = 0; i < 3; i++)
+      this->baseline_[i] += acc[i] - (this->baseline_[i] >> BASELINE_SHIFT);
+  }
+  return event;
+}
+
+}  // namespace bmi270
+}  // namespace esphome
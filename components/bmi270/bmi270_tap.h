@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+
+// Single/double tap detection on the accel stream, one call per sample in
+// integer arithmetic. A tap is a short spike away from the slowly tracked
+// gravity baseline: above the threshold for at most the shock length, then
+// followed by a quiet period in which the ringing is ignored. Kept free of
+// ESPHome dependencies so it can be replayed against recorded FIFO traces.
+
+namespace esphome {
+namespace bmi270 {
+
+enum TapEvent : uint8_t {
+  TAP_EVENT_NONE = 0,
+  TAP_EVENT_SINGLE,
+  TAP_EVENT_DOUBLE,
+};
+
+class TapDetector {
+ public:
+  // Threshold in raw accel LSB, durations in samples at the accel ODR. With
+  // a double-tap window a single tap is only reported once the window has
+  // passed without a second one; without one it is reported at once.
+  void configure(uint16_t threshold, uint16_t max_shock, uint16_t quiet, uint16_t double_tap_window);
+
+  TapEvent update(const int16_t *acc);
+  void reset();
+
+  uint32_t get_taps() const { return this->taps_; }
+  uint32_t get_rejected() const { return this->rejected_; }
+
+ protected:
+  enum State : uint8_t {
+    STATE_IDLE = 0,
+    STATE_SHOCK,
+    STATE_QUIET,
+    // Sustained motion: wait for the signal to drop before arming again
+    STATE_SETTLE,
+  };
+
+  uint16_t threshold_{1024};
+  uint16_t max_shock_{5};
+  uint16_t quiet_{5};
+  uint16_t double_tap_window_{0};
+
+  State state_{STATE_IDLE};
+  bool baseline_valid_{false};
+  int32_t baseline_[3]{};  // gravity, Q4
+  uint16_t count_{0};
+  // Samples since the first tap of a possible double tap, 0 when none
+  uint16_t pending_{0};
+  uint32_t taps_{0};
+  uint32_t rejected_{0};
+};
+
+}  // namespace bmi270
+}  // namespace esphome
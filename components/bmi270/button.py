@@ -0,0 +1,30 @@
+import esphome.codegen as cg
+from esphome.components import button
+import esphome.config_validation as cv
+from esphome.const import ENTITY_CATEGORY_CONFIG
+
+from . import BMI270Component, CONF_BMI270_ID, bmi270_ns
+
+CONF_RECALIBRATE = "recalibrate"
+
+BMI270RecalibrateButton = bmi270_ns.class_("BMI270RecalibrateButton", button.Button)
+
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(CONF_BMI270_ID): cv.use_id(BMI270Component),
+        # Re-runs FOC (and CRT when enabled) and stores the new offsets
+        cv.Optional(CONF_RECALIBRATE): button.button_schema(
+            BMI270RecalibrateButton,
+            entity_category=ENTITY_CATEGORY_CONFIG,
+            icon="mdi:axis-arrow",
+        ),
+    }
+)
+
+
+async def to_code(config):
+    hub = await cg.get_variable(config[CONF_BMI270_ID])
+
+    if CONF_RECALIBRATE in config:
+        btn = await button.new_button(config[CONF_RECALIBRATE])
+        await cg.register_parented(btn, hub)
@@ -1,100 +1,822 @@
-import esphome.codegen as cg
-from esphome.components import i2c, sensor
-import esphome.config_validation as cv
-from esphome.const import (
-    CONF_ID,
-    CONF_ADDRESS,
-    CONF_TEMPERATURE,
-    DEVICE_CLASS_TEMPERATURE,
-    ICON_BRIEFCASE_DOWNLOAD,
-    ICON_SCREEN_ROTATION,
-    STATE_CLASS_MEASUREMENT,
-    UNIT_CELSIUS,
-    UNIT_DEGREE_PER_SECOND,
-    UNIT_METER_PER_SECOND_SQUARED,
-)
-
-DEPENDENCIES = ["i2c"]
-
-CONF_ACCEL_X = "accel_x"
-CONF_ACCEL_Y = "accel_y"
-CONF_ACCEL_Z = "accel_z"
-CONF_GYRO_X = "gyro_x"
-CONF_GYRO_Y = "gyro_y"
-CONF_GYRO_Z = "gyro_z"
-CONF_POWER_SAVE_MODE = "power_save_mode" # 新增
-
-bmi270_ns = cg.esphome_ns.namespace("bmi270")
-BMI270Component = bmi270_ns.class_(
-    "BMI270Component", cg.PollingComponent, i2c.I2CDevice
-)
-
-PowerSaveMode = bmi270_ns.enum("PowerSaveMode")
-POWER_SAVE_MODES = {
-    "NORMAL": PowerSaveMode.POWER_SAVE_MODE_NORMAL,
-    "LOW_POWER": PowerSaveMode.POWER_SAVE_MODE_LOW_POWER,
-    # "PERFORMANCE": PowerSaveMode.POWER_SAVE_MODE_PERFORMANCE, # 可以考慮添加
-}
-
-accel_schema = sensor.sensor_schema(
-    unit_of_measurement=UNIT_METER_PER_SECOND_SQUARED,
-    icon=ICON_BRIEFCASE_DOWNLOAD,
-    accuracy_decimals=2,
-    state_class=STATE_CLASS_MEASUREMENT,
-)
-gyro_schema = sensor.sensor_schema(
-    unit_of_measurement=UNIT_DEGREE_PER_SECOND,
-    icon=ICON_SCREEN_ROTATION,
-    accuracy_decimals=2,
-    state_class=STATE_CLASS_MEASUREMENT,
-)
-temperature_schema = sensor.sensor_schema(
-    unit_of_measurement=UNIT_CELSIUS,
-    accuracy_decimals=2,
-    device_class=DEVICE_CLASS_TEMPERATURE,
-    state_class=STATE_CLASS_MEASUREMENT,
-)
-
-CONFIG_SCHEMA = (
-    cv.Schema(
-        {
-            cv.GenerateID(): cv.declare_id(BMI270Component),
-            cv.Optional(CONF_ACCEL_X): accel_schema,
-            cv.Optional(CONF_ACCEL_Y): accel_schema,
-            cv.Optional(CONF_ACCEL_Z): accel_schema,
-            cv.Optional(CONF_GYRO_X): gyro_schema,
-            cv.Optional(CONF_GYRO_Y): gyro_schema,
-            cv.Optional(CONF_GYRO_Z): gyro_schema,
-            cv.Optional(CONF_TEMPERATURE): temperature_schema,
-            cv.Optional(CONF_POWER_SAVE_MODE, default="NORMAL"): cv.enum(
-                POWER_SAVE_MODES, upper=True
-            ),
-        }
-    )
-    .extend(cv.polling_component_schema("60s"))
-    .extend(i2c.i2c_device_schema(0x69))
-)
-
-
-async def to_code(config):
-    var = cg.new_Pvariable(config[CONF_ID])
-    await cg.register_component(var, config)
-    await i2c.register_i2c_device(var, config)
-
-    if CONF_POWER_SAVE_MODE in config:
-        cg.add(var.set_power_save_mode(config[CONF_POWER_SAVE_MODE]))
-
-    for d in ["x", "y", "z"]:
-        accel_key = f"accel_{d}"
-        if accel_key in config:
-            sens = await sensor.new_sensor(config[accel_key])
-            cg.add(getattr(var, f"set_accel_{d}_sensor")(sens))
-        
-        gyro_key = f"gyro_{d}"
-        if gyro_key in config:
-            sens = await sensor.new_sensor(config[gyro_key])
-            cg.add(getattr(var, f"set_gyro_{d}_sensor")(sens))
-
-    if CONF_TEMPERATURE in config:
-        sens = await sensor.new_sensor(config[CONF_TEMPERATURE])
-        cg.add(var.set_temperature_sensor(sens))
\ No newline at end of file
+import esphome.codegen as cg
+from esphome import automation, pins
+from esphome.components import i2c, sensor
+import esphome.config_validation as cv
+import esphome.final_validate as fv
+from . import BMI270Component, BMI270I2CComponent, bmi270_ns
+from esphome.const import (
+    CONF_ID,
+    CONF_ADDRESS,
+    CONF_DURATION,
+    CONF_FROM,
+    CONF_TO,
+    CONF_TRIGGER_ID,
+    CONF_TEMPERATURE,
+    CONF_THRESHOLD,
+    DEVICE_CLASS_TEMPERATURE,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    ICON_BRIEFCASE_DOWNLOAD,
+    ICON_SCREEN_ROTATION,
+    STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
+    UNIT_CELSIUS,
+    UNIT_DEGREES,
+    UNIT_DEGREE_PER_SECOND,
+    UNIT_EMPTY,
+    UNIT_HERTZ,
+    UNIT_METER_PER_SECOND_SQUARED,
+    UNIT_MICROTESLA,
+    UNIT_MILLISECOND,
+    UNIT_PARTS_PER_MILLION,
+)
+
+DEPENDENCIES = ["i2c"]
+
+CONF_ACCEL_X = "accel_x"
+CONF_ACCEL_Y = "accel_y"
+CONF_ACCEL_Z = "accel_z"
+CONF_GYRO_X = "gyro_x"
+CONF_GYRO_Y = "gyro_y"
+CONF_GYRO_Z = "gyro_z"
+CONF_POWER_SAVE_MODE = "power_save_mode" # 新增
+CONF_FIFO_MODE = "fifo_mode"
+CONF_FIFO_WATERMARK = "fifo_watermark"
+CONF_CONFIG_BURST_SIZE = "config_burst_size"
+CONF_ACCEL_ODR = "accel_odr"
+CONF_ACCEL_RANGE = "accel_range"
+CONF_ACCEL_BANDWIDTH = "accel_bandwidth"
+CONF_ACCEL_AVERAGING = "accel_averaging"
+CONF_GYRO_ODR = "gyro_odr"
+CONF_GYRO_RANGE = "gyro_range"
+CONF_GYRO_BANDWIDTH = "gyro_bandwidth"
+CONF_PERFORMANCE_MODE = "performance_mode"
+CONF_INT1_PIN = "int1_pin"
+CONF_INT2_PIN = "int2_pin"
+CONF_ROLL = "roll"
+CONF_PITCH = "pitch"
+CONF_YAW = "yaw"
+CONF_QUATERNION_W = "quaternion_w"
+CONF_QUATERNION_X = "quaternion_x"
+CONF_QUATERNION_Y = "quaternion_y"
+CONF_QUATERNION_Z = "quaternion_z"
+CONF_FUSION_BETA = "fusion_beta"
+CONF_STEP_COUNT = "step_count"
+CONF_ACCEL_CALIBRATION = "accel_calibration"
+CONF_GYRO_CRT = "gyro_crt"
+CONF_GYRO_BIAS_MODEL = "gyro_bias_model"
+CONF_STATISTICS = "statistics"
+CONF_WINDOW = "window"
+CONF_SPECTRUM = "spectrum"
+CONF_AXIS = "axis"
+CONF_FFT_SIZE = "fft_size"
+CONF_DOMINANT_FREQUENCY = "dominant_frequency"
+CONF_PEAK_AMPLITUDE = "peak_amplitude"
+CONF_BANDS = "bands"
+CONF_DEADBAND = "deadband"
+CONF_MIN_PUBLISH_INTERVAL = "min_publish_interval"
+CONF_MAX_PUBLISH_INTERVAL = "max_publish_interval"
+CONF_PUBLISHES_EMITTED = "publishes_emitted"
+CONF_TIMESTAMP_JITTER = "timestamp_jitter"
+CONF_CLOCK_DRIFT = "clock_drift"
+CONF_SAMPLE_LATENCY = "sample_latency"
+CONF_SYNC_WITH = "sync_with"
+CONF_SYNC_SKEW = "sync_skew"
+CONF_SETUP_TIME = "setup_time"
+CONF_SETUP_ERROR = "setup_error"
+CONF_RECOVERIES = "recoveries"
+CONF_MAGNETOMETER = "magnetometer"
+CONF_MAG_X = "mag_x"
+CONF_MAG_Y = "mag_y"
+CONF_MAG_Z = "mag_z"
+CONF_HEADING = "heading"
+CONF_AXES = "axes"
+CONF_ODR = "odr"
+CONF_PUBLISHES_SUPPRESSED = "publishes_suppressed"
+CONF_ORIENTATION = "orientation"
+CONF_ON_ORIENTATION = "on_orientation"
+CONF_FLAT_ANGLE = "flat_angle"
+CONF_HYSTERESIS = "hysteresis"
+CONF_HOLD_TIME = "hold_time"
+CONF_TAP = "tap"
+CONF_ON_TAP = "on_tap"
+CONF_ON_DOUBLE_TAP = "on_double_tap"
+CONF_QUIET = "quiet"
+CONF_DOUBLE_TAP_WINDOW = "double_tap_window"
+
+FUSION_SENSORS = [
+    CONF_ROLL,
+    CONF_PITCH,
+    CONF_YAW,
+    CONF_QUATERNION_W,
+    CONF_QUATERNION_X,
+    CONF_QUATERNION_Y,
+    CONF_QUATERNION_Z,
+]
+
+Orientation = bmi270_ns.enum("Orientation")
+OrientationTrigger = bmi270_ns.class_(
+    "OrientationTrigger", automation.Trigger.template(Orientation)
+)
+TapTrigger = bmi270_ns.class_("TapTrigger", automation.Trigger.template())
+DoubleTapTrigger = bmi270_ns.class_("DoubleTapTrigger", automation.Trigger.template())
+
+PowerSaveMode = bmi270_ns.enum("PowerSaveMode")
+POWER_SAVE_MODES = {
+    "NORMAL": PowerSaveMode.POWER_SAVE_MODE_NORMAL,
+    "LOW_POWER": PowerSaveMode.POWER_SAVE_MODE_LOW_POWER,
+    "GYRO_FAST_START": PowerSaveMode.POWER_SAVE_MODE_GYRO_FAST_START,
+    "SUSPEND": PowerSaveMode.POWER_SAVE_MODE_SUSPEND,
+}
+
+WindowStatistic = bmi270_ns.enum("WindowStatistic")
+STATISTICS = {
+    "mean": WindowStatistic.STATISTIC_MEAN,
+    "rms": WindowStatistic.STATISTIC_RMS,
+    "peak_to_peak": WindowStatistic.STATISTIC_PEAK_TO_PEAK,
+    "min": WindowStatistic.STATISTIC_MIN,
+    "max": WindowStatistic.STATISTIC_MAX,
+    "crest_factor": WindowStatistic.STATISTIC_CREST_FACTOR,
+    "variance": WindowStatistic.STATISTIC_VARIANCE,
+}
+SpectrumAxis = bmi270_ns.enum("SpectrumAxis")
+SPECTRUM_AXES = {
+    "X": SpectrumAxis.SPECTRUM_AXIS_X,
+    "Y": SpectrumAxis.SPECTRUM_AXIS_Y,
+    "Z": SpectrumAxis.SPECTRUM_AXIS_Z,
+    "MAGNITUDE": SpectrumAxis.SPECTRUM_AXIS_MAGNITUDE,
+}
+PublishChannel = bmi270_ns.enum("PublishChannel")
+# Raw outputs and their channel in BMI270Component::set_publish_limits
+PUBLISH_CHANNELS = {
+    CONF_ACCEL_X: PublishChannel.PUBLISH_CHANNEL_ACCEL_X,
+    CONF_ACCEL_Y: PublishChannel.PUBLISH_CHANNEL_ACCEL_Y,
+    CONF_ACCEL_Z: PublishChannel.PUBLISH_CHANNEL_ACCEL_Z,
+    CONF_GYRO_X: PublishChannel.PUBLISH_CHANNEL_GYRO_X,
+    CONF_GYRO_Y: PublishChannel.PUBLISH_CHANNEL_GYRO_Y,
+    CONF_GYRO_Z: PublishChannel.PUBLISH_CHANNEL_GYRO_Z,
+    CONF_TEMPERATURE: PublishChannel.PUBLISH_CHANNEL_TEMPERATURE,
+}
+# Aux interface ODR; the BMM150 runs in normal mode just above it
+MAG_ODRS = {
+    "12.5HZ": 0x05,
+    "25HZ": 0x06,
+}
+# BMM150 axis feeding each BMI270 axis, as +/-(index + 1)
+MAG_AXES = {"X": 1, "Y": 2, "Z": 3, "-X": -1, "-Y": -2, "-Z": -3}
+
+FFT_SIZES = [64, 128, 256, 512, 1024]
+MAX_SPECTRUM_BANDS = 8
+
+# Channel index in BMI270Component::set_statistics_sensor
+STATISTICS_CHANNELS = [CONF_ACCEL_X, CONF_ACCEL_Y, CONF_ACCEL_Z, CONF_GYRO_X, CONF_GYRO_Y, CONF_GYRO_Z]
+
+FifoMode = bmi270_ns.enum("FifoMode")
+FIFO_MODES = {
+    "DISABLED": FifoMode.FIFO_MODE_DISABLED,
+    "HEADER": FifoMode.FIFO_MODE_HEADER,
+    "HEADERLESS": FifoMode.FIFO_MODE_HEADERLESS,
+}
+
+# Register codes for ACC_CONF / ACC_RANGE / GYR_CONF / GYR_RANGE
+ACCEL_ODRS = {
+    "0.78HZ": 0x01,
+    "1.5HZ": 0x02,
+    "3.1HZ": 0x03,
+    "6.25HZ": 0x04,
+    "12.5HZ": 0x05,
+    "25HZ": 0x06,
+    "50HZ": 0x07,
+    "100HZ": 0x08,
+    "200HZ": 0x09,
+    "400HZ": 0x0A,
+    "800HZ": 0x0B,
+    "1600HZ": 0x0C,
+}
+ACCEL_RANGES = {
+    "2G": 0x00,
+    "4G": 0x01,
+    "8G": 0x02,
+    "16G": 0x03,
+}
+ACCEL_BANDWIDTHS = {
+    "OSR4": 0x00,
+    "OSR2": 0x01,
+    "NORMAL": 0x02,
+    "CIC": 0x03,
+}
+# ACC_CONF.acc_bwp in low-power (undersampling) mode
+ACCEL_AVERAGING = {
+    "AVG1": 0x00,
+    "AVG2": 0x01,
+    "AVG4": 0x02,
+    "AVG8": 0x03,
+    "AVG16": 0x04,
+    "AVG32": 0x05,
+    "AVG64": 0x06,
+    "AVG128": 0x07,
+}
+GYRO_ODRS = {
+    "25HZ": 0x06,
+    "50HZ": 0x07,
+    "100HZ": 0x08,
+    "200HZ": 0x09,
+    "400HZ": 0x0A,
+    "800HZ": 0x0B,
+    "1600HZ": 0x0C,
+    "3200HZ": 0x0D,
+}
+GYRO_RANGES = {
+    "2000DPS": 0x00,
+    "1000DPS": 0x01,
+    "500DPS": 0x02,
+    "250DPS": 0x03,
+    "125DPS": 0x04,
+}
+GYRO_BANDWIDTHS = {
+    "OSR4": 0x00,
+    "OSR2": 0x01,
+    "NORMAL": 0x02,
+}
+PERFORMANCE_MODES = {
+    "PERFORMANCE": True,
+    "POWER_OPTIMIZED": False,
+}
+
+
+def validate_burst_size(value):
+    value = cv.int_range(min=32, max=8192)(value)
+    if value % 2:
+        raise cv.Invalid("config_burst_size must be even")
+    return value
+
+
+def validate_fifo_odr(config):
+    # FIFO sample timestamps assume one accel and one gyro frame per period
+    if config[CONF_FIFO_MODE] != "DISABLED" and (
+        ACCEL_ODRS[config[CONF_ACCEL_ODR]] != GYRO_ODRS.get(config[CONF_GYRO_ODR])
+    ):
+        raise cv.Invalid("fifo_mode requires accel_odr and gyro_odr to match")
+    return config
+
+
+def validate_sync(config):
+    if CONF_SYNC_SKEW in config and CONF_SYNC_WITH not in config:
+        raise cv.Invalid("sync_skew requires sync_with")
+    # A per-poll wake-up delay would shift one instance against the other
+    if CONF_SYNC_WITH in config and config[CONF_POWER_SAVE_MODE] != "NORMAL":
+        raise cv.Invalid("sync_with requires power_save_mode NORMAL")
+    return config
+
+
+# Settings a follower has to share with its sync_with leader
+SYNC_SHARED_KEYS = (CONF_ACCEL_ODR, CONF_GYRO_ODR, CONF_FIFO_MODE, CONF_POWER_SAVE_MODE)
+
+
+def final_validate_sync(config):
+    if CONF_SYNC_WITH not in config:
+        return config
+    full_config = fv.full_config.get()
+    leader_path = full_config.get_path_for_id(config[CONF_SYNC_WITH])[:-1]
+    leader = full_config.get_config_for_path(leader_path)
+    if CONF_SYNC_WITH in leader:
+        raise cv.Invalid("sync_with must name an instance that does not use sync_with itself")
+    for key in SYNC_SHARED_KEYS:
+        if leader.get(key) != config.get(key):
+            raise cv.Invalid(f"{key} must match the instance named in sync_with")
+    return config
+
+
+def validate_power_save(config):
+    # The power save profiles power the sensors per poll, so nothing fills
+    # the FIFO between reads
+    if config[CONF_POWER_SAVE_MODE] != "NORMAL" and config[CONF_FIFO_MODE] != "DISABLED":
+        raise cv.Invalid("power_save_mode other than NORMAL requires fifo_mode DISABLED")
+    return config
+
+
+def validate_magnetometer(config):
+    # Headerless frames have a fixed layout that cannot carry the slower aux
+    if CONF_MAGNETOMETER in config and config[CONF_FIFO_MODE] == "HEADERLESS":
+        raise cv.Invalid("magnetometer requires fifo_mode HEADER or DISABLED")
+    return config
+
+
+def validate_mag_axes(value):
+    value = cv.ensure_list(cv.one_of(*MAG_AXES, upper=True))(value)
+    if len(value) != 3:
+        raise cv.Invalid("axes needs exactly three entries")
+    if len({axis.lstrip("-") for axis in value}) != 3:
+        raise cv.Invalid("axes must use each of X, Y and Z once")
+    return value
+
+
+def validate_spectrum(config):
+    # Blocks need every sample at a fixed rate
+    if CONF_SPECTRUM in config and config[CONF_FIFO_MODE] == "DISABLED":
+        raise cv.Invalid("spectrum requires fifo_mode HEADER or HEADERLESS")
+    return config
+
+
+def validate_tap(config):
+    if CONF_TAP in config and not (CONF_ON_TAP in config or CONF_ON_DOUBLE_TAP in config):
+        raise cv.Invalid("tap requires on_tap or on_double_tap")
+    if not (CONF_ON_TAP in config or CONF_ON_DOUBLE_TAP in config):
+        return config
+    # A tap lasts a few tens of milliseconds; it is only seen in the full
+    # sample stream
+    if config[CONF_FIFO_MODE] == "DISABLED":
+        raise cv.Invalid("on_tap and on_double_tap require fifo_mode HEADER or HEADERLESS")
+    if float(config[CONF_ACCEL_ODR][:-2]) < 100:
+        raise cv.Invalid("on_tap and on_double_tap require accel_odr of at least 100Hz")
+    tap_config = config.get(CONF_TAP, {})
+    if tap_config.get(CONF_THRESHOLD, 0) >= int(config[CONF_ACCEL_RANGE][:-1]):
+        raise cv.Invalid("tap threshold must be below the accel_range")
+    return config
+
+
+def validate_publish_limits(config):
+    if (
+        config[CONF_MAX_PUBLISH_INTERVAL].total_milliseconds != 0
+        and config[CONF_MAX_PUBLISH_INTERVAL] < config[CONF_MIN_PUBLISH_INTERVAL]
+    ):
+        raise cv.Invalid("max_publish_interval must not be below min_publish_interval")
+    return config
+
+
+def validate_band(config):
+    if config[CONF_FROM] >= config[CONF_TO]:
+        raise cv.Invalid("Band 'from' must be below 'to'")
+    return config
+
+
+accel_schema = sensor.sensor_schema(
+    unit_of_measurement=UNIT_METER_PER_SECOND_SQUARED,
+    icon=ICON_BRIEFCASE_DOWNLOAD,
+    accuracy_decimals=2,
+    state_class=STATE_CLASS_MEASUREMENT,
+)
+gyro_schema = sensor.sensor_schema(
+    unit_of_measurement=UNIT_DEGREE_PER_SECOND,
+    icon=ICON_SCREEN_ROTATION,
+    accuracy_decimals=2,
+    state_class=STATE_CLASS_MEASUREMENT,
+)
+angle_schema = sensor.sensor_schema(
+    unit_of_measurement=UNIT_DEGREES,
+    icon=ICON_SCREEN_ROTATION,
+    accuracy_decimals=1,
+    state_class=STATE_CLASS_MEASUREMENT,
+)
+mag_schema = sensor.sensor_schema(
+    unit_of_measurement=UNIT_MICROTESLA,
+    icon="mdi:magnet",
+    accuracy_decimals=1,
+    state_class=STATE_CLASS_MEASUREMENT,
+)
+quaternion_schema = sensor.sensor_schema(
+    unit_of_measurement=UNIT_EMPTY,
+    icon=ICON_SCREEN_ROTATION,
+    accuracy_decimals=4,
+    state_class=STATE_CLASS_MEASUREMENT,
+)
+step_count_schema = sensor.sensor_schema(
+    unit_of_measurement="steps",
+    icon="mdi:walk",
+    accuracy_decimals=0,
+    state_class=STATE_CLASS_TOTAL_INCREASING,
+)
+temperature_schema = sensor.sensor_schema(
+    unit_of_measurement=UNIT_CELSIUS,
+    accuracy_decimals=2,
+    device_class=DEVICE_CLASS_TEMPERATURE,
+    state_class=STATE_CLASS_MEASUREMENT,
+)
+
+# Applied before publish_state(), so suppressed values skip the filter
+# chain, logging and the API/MQTT send entirely
+PUBLISH_LIMITS_SCHEMA = {
+    # Publish only when the value moved by more than this (0: every value)
+    cv.Optional(CONF_DEADBAND, default=0.0): cv.positive_float,
+    cv.Optional(CONF_MIN_PUBLISH_INTERVAL, default="0ms"): cv.positive_time_period_milliseconds,
+    # Republish an unchanged value after this long (0: never)
+    cv.Optional(CONF_MAX_PUBLISH_INTERVAL, default="0ms"): cv.positive_time_period_milliseconds,
+}
+
+
+def with_publish_limits(base_schema):
+    return cv.All(base_schema.extend(PUBLISH_LIMITS_SCHEMA), validate_publish_limits)
+
+
+publish_counter_schema = sensor.sensor_schema(
+    unit_of_measurement=UNIT_EMPTY,
+    icon="mdi:counter",
+    accuracy_decimals=0,
+    state_class=STATE_CLASS_TOTAL_INCREASING,
+    entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+)
+
+
+setup_time_schema = sensor.sensor_schema(
+    unit_of_measurement=UNIT_MILLISECOND,
+    icon="mdi:timer-play-outline",
+    accuracy_decimals=0,
+    entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+)
+
+# BMI2_* result of the failed setup step, 0 once the sensor is ready
+setup_error_schema = sensor.sensor_schema(
+    icon="mdi:alert-circle-outline",
+    accuracy_decimals=0,
+    entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+)
+
+sync_skew_schema = sensor.sensor_schema(
+    unit_of_measurement="µs",
+    icon="mdi:sine-wave",
+    accuracy_decimals=0,
+    state_class=STATE_CLASS_MEASUREMENT,
+    entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+)
+
+timestamp_jitter_schema = sensor.sensor_schema(
+    unit_of_measurement="µs",
+    icon="mdi:timer-outline",
+    accuracy_decimals=0,
+    state_class=STATE_CLASS_MEASUREMENT,
+    entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+)
+clock_drift_schema = sensor.sensor_schema(
+    unit_of_measurement=UNIT_PARTS_PER_MILLION,
+    icon="mdi:clock-fast",
+    accuracy_decimals=0,
+    state_class=STATE_CLASS_MEASUREMENT,
+    entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+)
+sample_latency_schema = sensor.sensor_schema(
+    unit_of_measurement=UNIT_MILLISECOND,
+    icon="mdi:timer-sand",
+    accuracy_decimals=1,
+    state_class=STATE_CLASS_MEASUREMENT,
+    entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+)
+
+
+def statistics_channel_schema(base_schema):
+    # Variance and crest factor do not share the channel unit
+    return cv.Schema(
+        {
+            cv.Optional(stat): (
+                sensor.sensor_schema(accuracy_decimals=3, state_class=STATE_CLASS_MEASUREMENT)
+                if stat in ("variance", "crest_factor")
+                else base_schema
+            )
+            for stat in STATISTICS
+        }
+    )
+
+
+statistics_schema = cv.Schema(
+    {
+        cv.Optional(CONF_WINDOW, default="1s"): cv.All(
+            cv.positive_time_period_milliseconds,
+            cv.Range(min=cv.TimePeriod(milliseconds=10)),
+        ),
+        **{
+            cv.Optional(channel): statistics_channel_schema(
+                accel_schema if channel.startswith("accel") else gyro_schema
+            )
+            for channel in STATISTICS_CHANNELS
+        },
+    }
+)
+
+spectrum_schema = cv.Schema(
+    {
+        cv.Optional(CONF_AXIS, default="Z"): cv.enum(SPECTRUM_AXES, upper=True),
+        cv.Optional(CONF_FFT_SIZE, default=256): cv.one_of(*FFT_SIZES, int=True),
+        cv.Optional(CONF_DOMINANT_FREQUENCY): sensor.sensor_schema(
+            unit_of_measurement=UNIT_HERTZ,
+            icon="mdi:sine-wave",
+            accuracy_decimals=1,
+            state_class=STATE_CLASS_MEASUREMENT,
+        ),
+        cv.Optional(CONF_PEAK_AMPLITUDE): accel_schema,
+        # Band energy, published as the RMS acceleration within the band
+        cv.Optional(CONF_BANDS): cv.All(
+            cv.ensure_list(
+                cv.All(
+                    accel_schema.extend(
+                        {
+                            cv.Required(CONF_FROM): cv.frequency,
+                            cv.Required(CONF_TO): cv.frequency,
+                        }
+                    ),
+                    validate_band,
+                )
+            ),
+            cv.Length(max=MAX_SPECTRUM_BANDS),
+        ),
+    }
+)
+
+magnetometer_schema = cv.Schema(
+    {
+        cv.Optional(CONF_ADDRESS, default=0x10): cv.i2c_address,
+        cv.Optional(CONF_ODR, default="25Hz"): cv.enum(MAG_ODRS, upper=True),
+        # BMM150 axis (optionally negated) for the BMI270 X, Y and Z axes
+        cv.Optional(CONF_AXES, default=["X", "Y", "Z"]): validate_mag_axes,
+        cv.Optional(CONF_MAG_X): mag_schema,
+        cv.Optional(CONF_MAG_Y): mag_schema,
+        cv.Optional(CONF_MAG_Z): mag_schema,
+        # Fusion yaw when orientation outputs are configured, otherwise a
+        # tilt-compensated compass
+        cv.Optional(CONF_HEADING): angle_schema,
+    }
+)
+
+# Screen orientation classifier, reported through on_orientation and the
+# orientation text sensor; angles in degrees
+orientation_schema = cv.Schema(
+    {
+        cv.Optional(CONF_FLAT_ANGLE, default=20.0): cv.float_range(min=0.0, max=45.0),
+        cv.Optional(CONF_HYSTERESIS, default=10.0): cv.float_range(min=0.0, max=30.0),
+        cv.Optional(CONF_HOLD_TIME, default="500ms"): cv.positive_time_period_milliseconds,
+    }
+)
+
+# Tap detector on the FIFO stream; a single tap waits out the double-tap
+# window only when on_double_tap is configured
+tap_schema = cv.Schema(
+    {
+        cv.Optional(CONF_THRESHOLD, default=1.0): cv.float_range(min=0.05),
+        # Longest time above the threshold that still counts as a tap
+        cv.Optional(CONF_DURATION, default="50ms"): cv.positive_time_period_milliseconds,
+        # Ringing after a tap that is ignored
+        cv.Optional(CONF_QUIET, default="50ms"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_DOUBLE_TAP_WINDOW, default="300ms"): cv.positive_time_period_milliseconds,
+    }
+)
+
+# Transport-independent options; the I2C platform below and the bmi270_spi
+# platform each add their own device schema and component class
+BMI270_SCHEMA = (
+    cv.Schema(
+        {
+            cv.Optional(CONF_ACCEL_X): with_publish_limits(accel_schema),
+            cv.Optional(CONF_ACCEL_Y): with_publish_limits(accel_schema),
+            cv.Optional(CONF_ACCEL_Z): with_publish_limits(accel_schema),
+            cv.Optional(CONF_GYRO_X): with_publish_limits(gyro_schema),
+            cv.Optional(CONF_GYRO_Y): with_publish_limits(gyro_schema),
+            cv.Optional(CONF_GYRO_Z): with_publish_limits(gyro_schema),
+            cv.Optional(CONF_TEMPERATURE): with_publish_limits(temperature_schema),
+            cv.Optional(CONF_PUBLISHES_EMITTED): publish_counter_schema,
+            # Sensortime mapping quality and sample-to-publish latency
+            cv.Optional(CONF_TIMESTAMP_JITTER): timestamp_jitter_schema,
+            cv.Optional(CONF_CLOCK_DRIFT): clock_drift_schema,
+            cv.Optional(CONF_SAMPLE_LATENCY): sample_latency_schema,
+            # Read on another instance's schedule, right after it
+            cv.Optional(CONF_SYNC_WITH): cv.use_id(BMI270Component),
+            cv.Optional(CONF_SYNC_SKEW): sync_skew_schema,
+            # Published once, when setup completes or fails
+            cv.Optional(CONF_SETUP_TIME): setup_time_schema,
+            cv.Optional(CONF_SETUP_ERROR): setup_error_schema,
+            # Re-initialization attempts after failures, read errors or a
+            # sensor reset
+            cv.Optional(CONF_RECOVERIES): publish_counter_schema,
+            cv.Optional(CONF_PUBLISHES_SUPPRESSED): publish_counter_schema,
+            cv.Optional(CONF_STEP_COUNT): step_count_schema,
+            # Aggregates over every sample, published once per window
+            cv.Optional(CONF_STATISTICS): statistics_schema,
+            # Windowed accel FFT, averaged between updates
+            cv.Optional(CONF_SPECTRUM): spectrum_schema,
+            cv.Optional(CONF_ROLL): angle_schema,
+            cv.Optional(CONF_PITCH): angle_schema,
+            cv.Optional(CONF_YAW): angle_schema,
+            cv.Optional(CONF_QUATERNION_W): quaternion_schema,
+            cv.Optional(CONF_QUATERNION_X): quaternion_schema,
+            cv.Optional(CONF_QUATERNION_Y): quaternion_schema,
+            cv.Optional(CONF_QUATERNION_Z): quaternion_schema,
+            cv.Optional(CONF_FUSION_BETA, default=0.1): cv.positive_float,
+            # BMM150 on the auxiliary interface; adds heading to the fusion
+            cv.Optional(CONF_MAGNETOMETER): magnetometer_schema,
+            cv.Optional(CONF_ORIENTATION): orientation_schema,
+            cv.Optional(CONF_ON_ORIENTATION): automation.validate_automation(
+                {cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(OrientationTrigger)}
+            ),
+            cv.Optional(CONF_TAP): tap_schema,
+            cv.Optional(CONF_ON_TAP): automation.validate_automation(
+                {cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(TapTrigger)}
+            ),
+            cv.Optional(CONF_ON_DOUBLE_TAP): automation.validate_automation(
+                {cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(DoubleTapTrigger)}
+            ),
+            cv.Optional(CONF_POWER_SAVE_MODE, default="NORMAL"): cv.enum(
+                POWER_SAVE_MODES, upper=True
+            ),
+            # Offset calibration runs once and is stored; accel calibration
+            # needs the device flat with +Z up
+            cv.Optional(CONF_ACCEL_CALIBRATION, default=False): cv.boolean,
+            cv.Optional(CONF_GYRO_CRT, default=False): cv.boolean,
+            # Learn residual gyro bias against temperature while still
+            cv.Optional(CONF_GYRO_BIAS_MODEL, default=False): cv.boolean,
+            cv.Optional(CONF_FIFO_MODE, default="DISABLED"): cv.enum(
+                FIFO_MODES, upper=True
+            ),
+            cv.Optional(CONF_FIFO_WATERMARK, default=16): cv.int_range(min=1, max=150),
+            cv.Optional(CONF_ACCEL_ODR, default="100Hz"): cv.enum(ACCEL_ODRS, upper=True),
+            cv.Optional(CONF_ACCEL_RANGE, default="2G"): cv.enum(ACCEL_RANGES, upper=True),
+            cv.Optional(CONF_ACCEL_BANDWIDTH, default="NORMAL"): cv.enum(
+                ACCEL_BANDWIDTHS, upper=True
+            ),
+            cv.Optional(CONF_ACCEL_AVERAGING, default="AVG4"): cv.enum(
+                ACCEL_AVERAGING, upper=True
+            ),
+            cv.Optional(CONF_GYRO_ODR, default="100Hz"): cv.enum(GYRO_ODRS, upper=True),
+            cv.Optional(CONF_GYRO_RANGE, default="2000DPS"): cv.enum(GYRO_RANGES, upper=True),
+            cv.Optional(CONF_GYRO_BANDWIDTH, default="NORMAL"): cv.enum(
+                GYRO_BANDWIDTHS, upper=True
+            ),
+            cv.Optional(CONF_PERFORMANCE_MODE, default="PERFORMANCE"): cv.enum(
+                PERFORMANCE_MODES, upper=True
+            ),
+            cv.Optional(CONF_CONFIG_BURST_SIZE, default=256): validate_burst_size,
+            cv.Optional(CONF_INT1_PIN): pins.internal_gpio_input_pin_schema,
+            cv.Optional(CONF_INT2_PIN): pins.internal_gpio_input_pin_schema,
+        }
+    )
+    .extend(cv.polling_component_schema("60s"))
+)
+
+BMI270_VALIDATORS = (
+    validate_fifo_odr,
+    validate_power_save,
+    validate_magnetometer,
+    validate_spectrum,
+    validate_sync,
+    validate_tap,
+)
+
+CONFIG_SCHEMA = cv.All(
+    BMI270_SCHEMA.extend(
+        {cv.GenerateID(): cv.declare_id(BMI270I2CComponent)}
+    ).extend(i2c.i2c_device_schema(0x69)),
+    *BMI270_VALIDATORS,
+)
+
+FINAL_VALIDATE_SCHEMA = final_validate_sync
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+    await i2c.register_i2c_device(var, config)
+    await setup_bmi270(var, config)
+
+
+async def setup_bmi270(var, config):
+    if CONF_POWER_SAVE_MODE in config:
+        cg.add(var.set_power_save_mode(config[CONF_POWER_SAVE_MODE]))
+
+    cg.add(var.set_accel_odr(config[CONF_ACCEL_ODR]))
+    cg.add(var.set_accel_range(config[CONF_ACCEL_RANGE]))
+    cg.add(var.set_accel_bandwidth(config[CONF_ACCEL_BANDWIDTH]))
+    cg.add(var.set_accel_averaging(config[CONF_ACCEL_AVERAGING]))
+    cg.add(var.set_gyro_odr(config[CONF_GYRO_ODR]))
+    cg.add(var.set_gyro_range(config[CONF_GYRO_RANGE]))
+    cg.add(var.set_gyro_bandwidth(config[CONF_GYRO_BANDWIDTH]))
+    cg.add(var.set_performance_mode(config[CONF_PERFORMANCE_MODE]))
+
+    cg.add(var.set_accel_calibration(config[CONF_ACCEL_CALIBRATION]))
+    cg.add(var.set_gyro_crt(config[CONF_GYRO_CRT]))
+    cg.add(var.set_gyro_bias_model(config[CONF_GYRO_BIAS_MODEL]))
+
+    cg.add(var.set_fifo_mode(config[CONF_FIFO_MODE]))
+    cg.add(var.set_fifo_watermark(config[CONF_FIFO_WATERMARK]))
+    cg.add(var.set_config_burst_size(config[CONF_CONFIG_BURST_SIZE]))
+
+    if CONF_INT1_PIN in config:
+        int1_pin = await cg.gpio_pin_expression(config[CONF_INT1_PIN])
+        cg.add(var.set_int1_pin(int1_pin))
+    if CONF_INT2_PIN in config:
+        int2_pin = await cg.gpio_pin_expression(config[CONF_INT2_PIN])
+        cg.add(var.set_int2_pin(int2_pin))
+
+    for d in ["x", "y", "z"]:
+        accel_key = f"accel_{d}"
+        if accel_key in config:
+            sens = await sensor.new_sensor(config[accel_key])
+            cg.add(getattr(var, f"set_accel_{d}_sensor")(sens))
+        
+        gyro_key = f"gyro_{d}"
+        if gyro_key in config:
+            sens = await sensor.new_sensor(config[gyro_key])
+            cg.add(getattr(var, f"set_gyro_{d}_sensor")(sens))
+
+    if CONF_TEMPERATURE in config:
+        sens = await sensor.new_sensor(config[CONF_TEMPERATURE])
+        cg.add(var.set_temperature_sensor(sens))
+
+    for key, channel in PUBLISH_CHANNELS.items():
+        if key in config:
+            cg.add(
+                var.set_publish_limits(
+                    channel,
+                    config[key][CONF_DEADBAND],
+                    config[key][CONF_MIN_PUBLISH_INTERVAL].total_milliseconds,
+                    config[key][CONF_MAX_PUBLISH_INTERVAL].total_milliseconds,
+                )
+            )
+    if CONF_TIMESTAMP_JITTER in config:
+        sens = await sensor.new_sensor(config[CONF_TIMESTAMP_JITTER])
+        cg.add(var.set_timestamp_jitter_sensor(sens))
+    if CONF_CLOCK_DRIFT in config:
+        sens = await sensor.new_sensor(config[CONF_CLOCK_DRIFT])
+        cg.add(var.set_clock_drift_sensor(sens))
+    if CONF_SAMPLE_LATENCY in config:
+        sens = await sensor.new_sensor(config[CONF_SAMPLE_LATENCY])
+        cg.add(var.set_sample_latency_sensor(sens))
+    if CONF_SYNC_WITH in config:
+        leader = await cg.get_variable(config[CONF_SYNC_WITH])
+        cg.add(var.set_sync_leader(leader))
+    if CONF_SYNC_SKEW in config:
+        sens = await sensor.new_sensor(config[CONF_SYNC_SKEW])
+        cg.add(var.set_sync_skew_sensor(sens))
+    if CONF_SETUP_TIME in config:
+        sens = await sensor.new_sensor(config[CONF_SETUP_TIME])
+        cg.add(var.set_setup_time_sensor(sens))
+    if CONF_SETUP_ERROR in config:
+        sens = await sensor.new_sensor(config[CONF_SETUP_ERROR])
+        cg.add(var.set_setup_error_sensor(sens))
+    if CONF_RECOVERIES in config:
+        sens = await sensor.new_sensor(config[CONF_RECOVERIES])
+        cg.add(var.set_recoveries_sensor(sens))
+    if CONF_PUBLISHES_EMITTED in config:
+        sens = await sensor.new_sensor(config[CONF_PUBLISHES_EMITTED])
+        cg.add(var.set_publishes_emitted_sensor(sens))
+    if CONF_PUBLISHES_SUPPRESSED in config:
+        sens = await sensor.new_sensor(config[CONF_PUBLISHES_SUPPRESSED])
+        cg.add(var.set_publishes_suppressed_sensor(sens))
+
+    if CONF_STEP_COUNT in config:
+        sens = await sensor.new_sensor(config[CONF_STEP_COUNT])
+        cg.add(var.set_step_count_sensor(sens))
+
+    if CONF_STATISTICS in config:
+        stats_config = config[CONF_STATISTICS]
+        cg.add(var.set_statistics_window(stats_config[CONF_WINDOW].total_milliseconds))
+        for channel_index, channel in enumerate(STATISTICS_CHANNELS):
+            for stat, stat_enum in STATISTICS.items():
+                if stat in stats_config.get(channel, {}):
+                    sens = await sensor.new_sensor(stats_config[channel][stat])
+                    cg.add(var.set_statistics_sensor(channel_index, stat_enum, sens))
+
+    if CONF_SPECTRUM in config:
+        spectrum_config = config[CONF_SPECTRUM]
+        cg.add_define("USE_BMI270_SPECTRUM")
+        cg.add_define("BMI270_FFT_SIZE", spectrum_config[CONF_FFT_SIZE])
+        cg.add(var.set_spectrum_axis(spectrum_config[CONF_AXIS]))
+        if CONF_DOMINANT_FREQUENCY in spectrum_config:
+            sens = await sensor.new_sensor(spectrum_config[CONF_DOMINANT_FREQUENCY])
+            cg.add(var.set_dominant_frequency_sensor(sens))
+        if CONF_PEAK_AMPLITUDE in spectrum_config:
+            sens = await sensor.new_sensor(spectrum_config[CONF_PEAK_AMPLITUDE])
+            cg.add(var.set_peak_amplitude_sensor(sens))
+        for band in spectrum_config.get(CONF_BANDS, []):
+            sens = await sensor.new_sensor(band)
+            cg.add(var.add_spectrum_band(band[CONF_FROM], band[CONF_TO], sens))
+
+    for key in FUSION_SENSORS:
+        if key in config:
+            sens = await sensor.new_sensor(config[key])
+            cg.add(getattr(var, f"set_{key}_sensor")(sens))
+    cg.add(var.set_fusion_beta(config[CONF_FUSION_BETA]))
+
+    if CONF_ORIENTATION in config:
+        orientation_config = config[CONF_ORIENTATION]
+        cg.add(
+            var.set_orientation_config(
+                orientation_config[CONF_FLAT_ANGLE],
+                orientation_config[CONF_HYSTERESIS],
+                orientation_config[CONF_HOLD_TIME].total_milliseconds,
+            )
+        )
+    for conf in config.get(CONF_ON_ORIENTATION, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(trigger, [(Orientation, "orientation")], conf)
+
+    if CONF_TAP in config:
+        tap_config = config[CONF_TAP]
+        cg.add(
+            var.set_tap_config(
+                tap_config[CONF_THRESHOLD],
+                tap_config[CONF_DURATION].total_milliseconds,
+                tap_config[CONF_QUIET].total_milliseconds,
+                tap_config[CONF_DOUBLE_TAP_WINDOW].total_milliseconds,
+            )
+        )
+    for conf in config.get(CONF_ON_TAP, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(trigger, [], conf)
+    for conf in config.get(CONF_ON_DOUBLE_TAP, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(trigger, [], conf)
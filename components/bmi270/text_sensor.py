@@ -0,0 +1,61 @@
+import esphome.codegen as cg
+from esphome.components import text_sensor
+import esphome.config_validation as cv
+
+from . import BMI270Component, CONF_BMI270_ID, bmi270_ns
+
+CONF_ACTIVITY = "activity"
+CONF_VECTOR = "vector"
+CONF_FIELDS = "fields"
+CONF_ENCODING = "encoding"
+CONF_ORIENTATION = "orientation"
+
+VectorFields = bmi270_ns.enum("VectorFields")
+VECTOR_FIELDS = {
+    "ACCEL": VectorFields.VECTOR_FIELDS_ACCEL,
+    "GYRO": VectorFields.VECTOR_FIELDS_GYRO,
+    "ACCEL_GYRO": VectorFields.VECTOR_FIELDS_ACCEL_GYRO,
+}
+VectorEncoding = bmi270_ns.enum("VectorEncoding")
+VECTOR_ENCODINGS = {
+    "CSV": VectorEncoding.VECTOR_ENCODING_CSV,
+    "BASE64": VectorEncoding.VECTOR_ENCODING_BASE64,
+}
+
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(CONF_BMI270_ID): cv.use_id(BMI270Component),
+        # Still, Walking, Running or Unknown, from the step activity detector
+        cv.Optional(CONF_ACTIVITY): text_sensor.text_sensor_schema(icon="mdi:run"),
+        # Portrait, Landscape, Portrait Inverted, Landscape Inverted, Face Up
+        # or Face Down; published only when it changes
+        cv.Optional(CONF_ORIENTATION): text_sensor.text_sensor_schema(
+            icon="mdi:screen-rotation"
+        ),
+        # Each sample as one packed record instead of one publish per axis
+        cv.Optional(CONF_VECTOR): text_sensor.text_sensor_schema(icon="mdi:axis-arrow").extend(
+            {
+                cv.Optional(CONF_FIELDS, default="ACCEL_GYRO"): cv.enum(VECTOR_FIELDS, upper=True),
+                cv.Optional(CONF_ENCODING, default="CSV"): cv.enum(VECTOR_ENCODINGS, upper=True),
+            }
+        ),
+    }
+)
+
+
+async def to_code(config):
+    hub = await cg.get_variable(config[CONF_BMI270_ID])
+
+    if CONF_ACTIVITY in config:
+        sens = await text_sensor.new_text_sensor(config[CONF_ACTIVITY])
+        cg.add(hub.set_activity_text_sensor(sens))
+
+    if CONF_VECTOR in config:
+        sens = await text_sensor.new_text_sensor(config[CONF_VECTOR])
+        cg.add(hub.set_vector_text_sensor(sens))
+        cg.add(hub.set_vector_fields(config[CONF_VECTOR][CONF_FIELDS]))
+        cg.add(hub.set_vector_encoding(config[CONF_VECTOR][CONF_ENCODING]))
+
+    if CONF_ORIENTATION in config:
+        sens = await text_sensor.new_text_sensor(config[CONF_ORIENTATION])
+        cg.add(hub.set_orientation_text_sensor(sens))
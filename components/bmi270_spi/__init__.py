@@ -0,0 +1,10 @@
+import esphome.codegen as cg
+from esphome.components import spi
+
+from ..bmi270 import BMI270Component, bmi270_ns
+
+AUTO_LOAD = ["bmi270"]
+
+BMI270SPIComponent = bmi270_ns.class_(
+    "BMI270SPIComponent", BMI270Component, spi.SPIDevice
+)
@@ -0,0 +1,45 @@
+#include "bmi270_spi.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace bmi270 {
+
+static const char *const TAG = "bmi270.spi";
+
+static const uint8_t SPI_READ_FLAG = 0x80;
+static const uint8_t SPI_CHIP_ID_ADDR = 0x00;
+
+void BMI270SPIComponent::setup() {
+  this->spi_setup();
+  // The BMI270 powers up in I2C mode and latches SPI on the first rising edge
+  // of CSB; this read only toggles CS, its result is undefined
+  uint8_t dummy;
+  this->bus_read_(SPI_CHIP_ID_ADDR, &dummy, 1);
+  delayMicroseconds(200);
+  BMI270Component::setup();
+}
+
+int8_t BMI270SPIComponent::bus_read_(uint8_t reg_addr, uint8_t *data, uint32_t len) {
+  this->enable();
+  this->write_byte(reg_addr | SPI_READ_FLAG);
+  this->read_byte();  // dummy byte, see datasheet section 6.1.2
+  this->read_array(data, len);
+  this->disable();
+  return BMI2_OK;
+}
+
+int8_t BMI270SPIComponent::bus_write_(uint8_t reg_addr, const uint8_t *data, uint32_t len) {
+  this->enable();
+  this->write_byte(reg_addr & ~SPI_READ_FLAG);
+  this->write_array(data, len);
+  this->disable();
+  return BMI2_OK;
+}
+
+void BMI270SPIComponent::dump_bus_config_() {
+  ESP_LOGCONFIG(TAG, "  Interface: SPI");
+  LOG_PIN("  CS Pin: ", this->cs_);
+}
+
+}  // namespace bmi270
+}  // namespace esphome
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "esphome/components/bmi270/bmi270.h"
+#include "esphome/components/spi/spi.h"
+
+namespace esphome {
+namespace bmi270 {
+
+// BMI270 in 4-wire SPI mode 0/3. Reads return one dummy byte before the data.
+class BMI270SPIComponent : public BMI270Component,
+                           public spi::SPIDevice<spi::BIT_ORDER_MSB_FIRST, spi::CLOCK_POLARITY_LOW,
+                                                 spi::CLOCK_PHASE_LEADING, spi::DATA_RATE_8MHZ> {
+ public:
+  void setup() override;
+  void set_preference_key(uint32_t key) { preference_key_ = key; }
+
+ protected:
+  int8_t bus_read_(uint8_t reg_addr, uint8_t *data, uint32_t len) override;
+  int8_t bus_write_(uint8_t reg_addr, const uint8_t *data, uint32_t len) override;
+  uint8_t bus_interface_() const override { return BMI2_SPI_INTF; }
+  uint32_t bus_preference_key_() const override { return this->preference_key_; }
+  void dump_bus_config_() override;
+
+  uint32_t preference_key_{0};
+};
+
+}  // namespace bmi270
+}  // namespace esphome
@@ -0,0 +1,33 @@
+import esphome.codegen as cg
+from esphome.components import spi
+import esphome.config_validation as cv
+from esphome.const import CONF_CS_PIN, CONF_ID, CONF_NUMBER
+
+from . import BMI270SPIComponent
+from ..bmi270.sensor import (
+    BMI270_SCHEMA,
+    BMI270_VALIDATORS,
+    final_validate_sync,
+    setup_bmi270,
+)
+
+DEPENDENCIES = ["spi"]
+
+CONFIG_SCHEMA = cv.All(
+    BMI270_SCHEMA.extend(
+        {cv.GenerateID(): cv.declare_id(BMI270SPIComponent)}
+    ).extend(spi.spi_device_schema(cs_pin_required=True, default_data_rate="8MHz")),
+    *BMI270_VALIDATORS,
+)
+
+FINAL_VALIDATE_SCHEMA = final_validate_sync
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+    await spi.register_spi_device(var, config)
+    # Calibration and bias tables are keyed by CS pin, the way the I2C
+    # platform keys them by address; the offset keeps the two ranges apart
+    cg.add(var.set_preference_key(0x100 | config[CONF_CS_PIN][CONF_NUMBER]))
+    await setup_bmi270(var, config)
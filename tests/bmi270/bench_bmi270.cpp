@@ -0,0 +1,253 @@
+// Per-sample host CPU cost of the BMI270 driver: setup runs against the
+// simulator, then update() is timed over many polls. Time spent inside the
+// simulated chip is measured separately and subtracted, so "driver" is the
+// component's own work per sample (decode, stamping, processing, publish).
+// A second table compares the bus traffic of separate register reads with
+// the burst read per polled sample, and the last ones the statistics and
+// attitude filter kernels on their own.
+//
+//   bmi270_bench [--quick]
+
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <functional>
+
+#include "bmi270_harness.h"
+
+using namespace esphome;
+using namespace esphome::bmi270;
+
+namespace {
+
+uint64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Accounts the time spent in the simulated chip
+class TimedBus : public SimI2CBus {
+ public:
+  i2c::ErrorCode read_register(uint8_t address, uint8_t a_register, uint8_t *data, size_t len) override {
+    uint64_t start = now_ns();
+    i2c::ErrorCode err = SimI2CBus::read_register(address, a_register, data, len);
+    this->bus_ns += now_ns() - start;
+    return err;
+  }
+  i2c::ErrorCode write_register(uint8_t address, uint8_t a_register, const uint8_t *data, size_t len) override {
+    uint64_t start = now_ns();
+    i2c::ErrorCode err = SimI2CBus::write_register(address, a_register, data, len);
+    this->bus_ns += now_ns() - start;
+    return err;
+  }
+  uint64_t bus_ns{0};
+};
+
+struct Scenario {
+  const char *name;
+  uint8_t odr;
+  FifoMode fifo;
+  std::function<void(TestBMI270 &)> configure;
+};
+
+sensor::Sensor sensors[16];
+
+void run(const Scenario &scenario, uint32_t polls) {
+  testing::set_now_us(0);
+  testing::clear_preferences();
+  BMI270Simulator sim;
+  // Some motion so fusion, statistics and the spectrum do real work
+  sim.set_signal([](uint32_t t, int16_t *acc, int16_t *gyr) {
+    acc[0] = (int16_t) (t * 7 % 401) - 200;
+    acc[1] = (int16_t) (t * 13 % 301) - 150;
+    acc[2] = 16384 + (int16_t) (t * 3 % 201) - 100;
+    gyr[0] = (int16_t) (t % 61) - 30;
+    gyr[1] = (int16_t) (t % 41) - 20;
+    gyr[2] = (int16_t) (t % 21) - 10;
+  });
+  TimedBus bus;
+  bus.add_device(0x68, &sim);
+  TestBMI270 imu;
+  imu.set_i2c_bus(&bus);
+  imu.set_i2c_address(0x68);
+  imu.set_accel_odr(scenario.odr);
+  imu.set_gyro_odr(scenario.odr);
+  imu.set_fifo_mode(scenario.fifo);
+  imu.set_fifo_watermark(16);
+  imu.set_accel_x_sensor(&sensors[0]);
+  imu.set_accel_y_sensor(&sensors[1]);
+  imu.set_accel_z_sensor(&sensors[2]);
+  imu.set_gyro_x_sensor(&sensors[3]);
+  imu.set_gyro_y_sensor(&sensors[4]);
+  imu.set_gyro_z_sensor(&sensors[5]);
+  if (scenario.configure)
+    scenario.configure(imu);
+
+  HostLoop loop;
+  loop.add(&imu);
+  loop.add_sim(&sim);
+  loop.setup();
+  if (!loop.run_until([&]() { return imu.is_ready(); })) {
+    printf("%-28s setup did not finish\n", scenario.name);
+    return;
+  }
+  sim.set_logging(false);
+
+  // One poll per 16 samples with the FIFO, one per sample otherwise
+  const uint32_t period_us = FifoParser::odr_to_ticks(scenario.odr) * 625 / 16;
+  const uint32_t poll_us = scenario.fifo == FIFO_MODE_DISABLED ? period_us : period_us * 16;
+  testing::advance_us(poll_us);
+  imu.update();
+
+  const uint32_t samples_before = sim.get_samples();
+  const uint32_t transactions_before = imu.bus_transactions_;
+  const uint32_t bytes_before = imu.bus_bytes_;
+  bus.bus_ns = 0;
+  uint64_t start = now_ns();
+  for (uint32_t i = 0; i < polls; i++) {
+    testing::advance_us(poll_us);
+    imu.update();
+  }
+  uint64_t total_ns = now_ns() - start;
+  double samples = sim.get_samples() - samples_before;
+  printf("%-28s %8.0f %10.1f %10.1f %8.2f %8.1f\n", scenario.name, samples, total_ns / samples,
+         (total_ns - bus.bus_ns) / samples, (imu.bus_transactions_ - transactions_before) / samples,
+         (imu.bus_bytes_ - bytes_before) / samples);
+}
+
+// The register reads behind one polled sample: STATUS, accel, gyro and
+// temperature as separate reads, against one burst from STATUS through
+// sensortime with temperature once a second
+void run_register_reads(uint32_t samples) {
+  testing::set_now_us(0);
+  BMI270Simulator sim;
+  bmi2_dev dev{};
+  sim.attach(&dev);
+  sim.set_logging(false);
+  if (bmi270_init(&dev) != BMI2_OK) {
+    printf("register reads: init failed\n");
+    return;
+  }
+  bmi2_set_pwr_ctrl(BMI2_PWR_CTRL_ACC_EN | BMI2_PWR_CTRL_GYR_EN | BMI2_PWR_CTRL_TEMP_EN, &dev);
+
+  printf("\n%-28s %8s %10s %8s %8s\n", "register reads, 100 Hz", "samples", "ns/sample", "txn/smp", "B/smp");
+  for (bool burst : {false, true}) {
+    uint32_t transactions = sim.get_transactions();
+    uint32_t bytes = sim.get_bytes();
+    uint64_t elapsed_ns = 0;
+    for (uint32_t i = 0; i < samples; i++) {
+      testing::advance_us(10000);
+      uint64_t start = now_ns();
+      int16_t temperature;
+      if (burst) {
+        bmi2_burst_data data;
+        bmi2_get_burst_data(&data, &dev);
+        if (i % 100 == 0)
+          bmi2_get_temperature(&temperature, &dev);
+      } else {
+        uint8_t status, acc[6], gyr[6];
+        bmi2_get_regs(BMI2_STATUS_ADDR, &status, 1, &dev);
+        bmi2_get_regs(BMI2_ACC_DATA_ADDR, acc, 6, &dev);
+        bmi2_get_regs(BMI2_GYR_DATA_ADDR, gyr, 6, &dev);
+        bmi2_get_temperature(&temperature, &dev);
+      }
+      elapsed_ns += now_ns() - start;
+    }
+    printf("%-28s %8u %10.1f %8.2f %8.1f\n", burst ? "one burst + temp at 1 Hz" : "status, accel, gyro, temp",
+           (unsigned) samples, (double) elapsed_ns / samples, (double) (sim.get_transactions() - transactions) / samples,
+           (double) (sim.get_bytes() - bytes) / samples);
+  }
+}
+
+// Welford window statistics over six axes, as the component feeds them;
+// reported per sample and axis
+void run_statistics_kernel(uint32_t samples) {
+  printf("\n%-28s %8s %10s %12s\n", "statistics kernel", "samples", "ns/smp/ax", "samples/s");
+  AxisStatistics stats[6];
+  for (auto &axis : stats)
+    axis.reset();
+  volatile float sink = 0.0f;
+  uint64_t start = now_ns();
+  for (uint32_t i = 0; i < samples; i++) {
+    float t = (float) (i % 401) * 0.01f;
+    for (uint8_t ch = 0; ch < 6; ch++)
+      stats[ch].add(t + ch);
+    // A 1 s window at 1600 Hz
+    if (stats[0].get_count() == 1600) {
+      for (auto &axis : stats) {
+        sink = axis.get(STATISTIC_RMS);
+        axis.reset();
+      }
+    }
+  }
+  uint64_t elapsed_ns = now_ns() - start;
+  (void) sink;
+  printf("%-28s %8u %10.2f %12.0f\n", "add() x 6 axes", (unsigned) samples, (double) elapsed_ns / samples / 6,
+         samples * 1e9 / (double) elapsed_ns);
+}
+
+// Madgwick updates per second on slowly varying input, without the driver
+// around it; the sink keeps the loop from being optimised away
+void run_fusion_kernel(uint32_t updates) {
+  printf("\n%-28s %8s %10s %12s\n", "fusion kernel", "updates", "ns/update", "updates/s");
+  for (bool marg : {false, true}) {
+    MadgwickFilter filter;
+    volatile float sink = 0.0f;
+    uint64_t start = now_ns();
+    for (uint32_t i = 0; i < updates; i++) {
+      float t = (float) (i % 1000) * 1e-3f;
+      float gx = 0.02f * t, gy = -0.01f * t, gz = 0.05f;
+      float ax = 0.05f * t, ay = -0.03f, az = 0.99f;
+      if (marg) {
+        filter.update_marg(gx, gy, gz, ax, ay, az, 20.0f, 5.0f * t, -40.0f, 0.000625f);
+      } else {
+        filter.update_imu(gx, gy, gz, ax, ay, az, 0.000625f);
+      }
+    }
+    uint64_t elapsed_ns = now_ns() - start;
+    sink = filter.get_w();
+    (void) sink;
+    printf("%-28s %8u %10.1f %12.0f\n", marg ? "update_marg (9 axes)" : "update_imu (6 axes)", (unsigned) updates,
+           (double) elapsed_ns / updates, updates * 1e9 / (double) elapsed_ns);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  const bool quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+  const uint32_t polls = quick ? 50 : 20000;
+
+  const Scenario scenarios[] = {
+      {"polled burst, 100 Hz", BMI2_ACC_ODR_100HZ, FIFO_MODE_DISABLED, nullptr},
+      {"FIFO header, 1600 Hz", BMI2_ACC_ODR_1600HZ, FIFO_MODE_HEADER, nullptr},
+      {"FIFO headerless, 1600 Hz", BMI2_ACC_ODR_1600HZ, FIFO_MODE_HEADERLESS, nullptr},
+      {"FIFO + fusion", BMI2_ACC_ODR_1600HZ, FIFO_MODE_HEADER,
+       [](TestBMI270 &imu) {
+         imu.set_roll_sensor(&sensors[6]);
+         imu.set_pitch_sensor(&sensors[7]);
+         imu.set_yaw_sensor(&sensors[8]);
+       }},
+      {"FIFO + statistics (6 axes)", BMI2_ACC_ODR_1600HZ, FIFO_MODE_HEADER,
+       [](TestBMI270 &imu) {
+         for (uint8_t ch = 0; ch < 6; ch++)
+           imu.set_statistics_sensor(ch, STATISTIC_RMS, &sensors[9]);
+       }},
+      {"FIFO + spectrum", BMI2_ACC_ODR_1600HZ, FIFO_MODE_HEADER,
+       [](TestBMI270 &imu) { imu.set_dominant_frequency_sensor(&sensors[10]); }},
+      {"FIFO + taps + orientation", BMI2_ACC_ODR_1600HZ, FIFO_MODE_HEADER,
+       [](TestBMI270 &imu) {
+         imu.add_on_tap_callback([]() {});
+         imu.add_on_orientation_callback([](Orientation) {});
+       }},
+  };
+
+  printf("%-28s %8s %10s %10s %8s %8s\n", "scenario", "samples", "ns/sample", "driver", "txn/smp", "B/smp");
+  for (const auto &scenario : scenarios)
+    run(scenario, polls);
+  run_register_reads(quick ? 100 : 10000);
+  run_statistics_kernel(quick ? 1000 : 1000000);
+  run_fusion_kernel(quick ? 1000 : 1000000);
+  return 0;
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "bmi270_sim.h"
+#include "esphome/core/hal.h"
+#include "esphome/components/bmi270/bmi270.h"
+#include "esphome/components/bmi270_spi/bmi270_spi.h"
+
+// Runs BMI270 components against simulated chips on the simulated clock:
+// interrupt lines as GPIO pins, the component internals the tests look at,
+// and a main loop that fires timeouts, loop() and update() like the
+// ESPHome application would.
+
+namespace esphome {
+namespace bmi270 {
+
+// One INT line of a simulated chip wired to an ESP GPIO
+class SimPin : public InternalGPIOPin {
+ public:
+  SimPin(BMI270Simulator *sim, uint8_t line, uint8_t pin) : sim_(sim), line_(line), pin_(pin) {}
+
+  void setup() override { this->setups_++; }
+  bool digital_read() override { return this->sim_->int_level(this->line_); }
+  void digital_write(bool value) override {}
+  std::string dump_summary() const override { return "GPIO" + std::to_string(this->pin_); }
+  void detach_interrupt() const override { this->isr_ = nullptr; }
+  uint8_t get_pin() const override { return this->pin_; }
+
+  // Samples the line and runs the handler on a rising edge, as the GPIO
+  // interrupt would
+  void poll() {
+    bool level = this->sim_->int_level(this->line_);
+    if (level && !this->level_ && this->isr_ != nullptr) {
+      this->edges_++;
+      this->isr_(this->arg_);
+    }
+    this->level_ = level;
+  }
+  bool is_attached() const { return this->isr_ != nullptr; }
+  uint32_t get_edges() const { return this->edges_; }
+  uint32_t get_setups() const { return this->setups_; }
+
+ protected:
+  void attach_interrupt(void (*func)(void *), void *arg, gpio::InterruptType type) const override {
+    this->isr_ = func;
+    this->arg_ = arg;
+  }
+
+  BMI270Simulator *sim_;
+  uint8_t line_;
+  uint8_t pin_;
+  bool level_{false};
+  mutable void (*isr_)(void *){nullptr};
+  mutable void *arg_{nullptr};
+  uint32_t edges_{0};
+  uint32_t setups_{0};
+};
+
+// Makes the protected state of a BMI270 component visible to the tests
+template<typename Base> class Exposed : public Base {
+ public:
+  using Base::bus_bytes_;
+  using Base::bus_transactions_;
+  using Base::calibration_;
+  using Base::data_int_pin_;
+  using Base::diagnostics_;
+  using Base::feature_int_pin_;
+  using Base::fifo_sample_count_;
+  using Base::gyro_bias_x_;
+  using Base::gyro_bias_y_;
+  using Base::has_sample_;
+  using Base::is_initialized_;
+  using Base::last_sample_;
+  using Base::publishes_emitted_;
+  using Base::publishes_suppressed_;
+  using Base::recoveries_;
+  using Base::recovering_;
+  using Base::sensor_;
+  using Base::setup_state_;
+  using Base::still_;
+  using Base::sync_max_skew_us_;
+  using Base::sync_skew_us_;
+  using Base::upload_chunk_size_;
+  using Base::upload_retries_;
+  using Base::upload_transactions_;
+
+  bool is_ready() const { return this->setup_state_ == SETUP_STATE_READY && this->is_initialized_; }
+};
+
+using TestBMI270 = Exposed<BMI270I2CComponent>;
+using TestBMI270SPI = Exposed<BMI270SPIComponent>;
+
+// The application main loop on the simulated clock
+class HostLoop {
+ public:
+  void add(PollingComponent *component) { this->components_.push_back({component, 0}); }
+  void add_sim(BMI270Simulator *sim) { this->sims_.push_back(sim); }
+  void add_pin(SimPin *pin) { this->pins_.push_back(pin); }
+
+  void setup() {
+    for (auto &entry : this->components_) {
+      entry.component->setup();
+      entry.next_update_ms = millis();
+    }
+  }
+
+  // One pass: chips sample up to now, edges reach their ISRs, then timeouts,
+  // loop() and any update() that is due
+  void step() {
+    for (auto *sim : this->sims_)
+      sim->advance();
+    for (auto *pin : this->pins_)
+      pin->poll();
+    for (auto &entry : this->components_) {
+      entry.component->run_timeouts();
+      entry.component->loop();
+      if ((int32_t) (millis() - entry.next_update_ms) >= 0) {
+        entry.next_update_ms += entry.component->get_update_interval();
+        entry.component->update();
+      }
+    }
+  }
+
+  void run_for(uint32_t ms, uint32_t step_us = 1000) {
+    uint64_t end = testing::now_us() + (uint64_t) ms * 1000;
+    while (testing::now_us() < end) {
+      testing::advance_us(step_us);
+      this->step();
+    }
+  }
+
+  // Runs until the predicate holds; false after the time limit
+  template<typename F> bool run_until(F done, uint32_t limit_ms = 10000, uint32_t step_us = 1000) {
+    uint64_t end = testing::now_us() + (uint64_t) limit_ms * 1000;
+    while (!done()) {
+      if (testing::now_us() >= end)
+        return false;
+      testing::advance_us(step_us);
+      this->step();
+    }
+    return true;
+  }
+
+ protected:
+  struct Entry {
+    PollingComponent *component;
+    uint32_t next_update_ms;
+  };
+  std::vector<Entry> components_;
+  std::vector<BMI270Simulator *> sims_;
+  std::vector<SimPin *> pins_;
+};
+
+}  // namespace bmi270
+}  // namespace esphome
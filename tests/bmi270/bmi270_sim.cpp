@@ -0,0 +1,426 @@
+#include "bmi270_sim.h"
+#include "esphome/core/hal.h"
+#include "esphome/components/bmi270/bmi270_config.h"
+
+#include <string.h>
+
+namespace esphome {
+namespace bmi270 {
+
+static const uint8_t BMM150_CHIP_ID_REG = 0x40;
+static const uint8_t BMM150_CHIP_ID_VALUE = 0x32;
+static const uint32_t CRT_DURATION_US = 200000;
+
+BMI270Simulator::BMI270Simulator() { this->power_on_reset(); }
+
+void BMI270Simulator::power_on_reset() {
+  memset(this->regs_, 0, sizeof(this->regs_));
+  memset(this->pages_, 0, sizeof(this->pages_));
+  memset(this->config_, 0, sizeof(this->config_));
+  memset(this->aux_regs_, 0, sizeof(this->aux_regs_));
+  this->regs_[BMI2_CHIP_ID_ADDR] = BMI2_CHIP_ID;
+  this->regs_[BMI2_ACC_CONF_ADDR] = 0xA8;
+  this->regs_[BMI2_ACC_RANGE_ADDR] = 0x02;
+  this->regs_[BMI2_GYR_CONF_ADDR] = 0xA9;
+  this->regs_[BMI2_FIFO_CONFIG_0_ADDR] = BMI2_FIFO_TIME_EN;
+  this->regs_[BMI2_FIFO_CONFIG_1_ADDR] = BMI2_FIFO_HEADER_EN;
+  this->regs_[BMI2_PWR_CONF_ADDR] = 0x03;
+  this->aux_regs_[BMM150_CHIP_ID_REG] = BMM150_CHIP_ID_VALUE;
+  this->config_bytes_written_ = 0;
+  this->init_pending_ = false;
+  this->crt_running_ = false;
+  this->spi_mode_ = false;
+  this->sampling_ = false;
+  this->fifo_.clear();
+  this->fifo_read_pos_ = 0;
+}
+
+void BMI270Simulator::attach(bmi2_dev *dev) {
+  dev->intf_ptr = this;
+  dev->intf = BMI2_I2C_INTF;
+  dev->read = [](uint8_t reg, uint8_t *data, uint32_t len, void *intf_ptr) -> int8_t {
+    return static_cast<BMI270Simulator *>(intf_ptr)->read(reg, data, len);
+  };
+  dev->write = [](uint8_t reg, const uint8_t *data, uint32_t len, void *intf_ptr) -> int8_t {
+    return static_cast<BMI270Simulator *>(intf_ptr)->write(reg, data, len);
+  };
+  dev->delay_us = [](uint32_t period, void *) { testing::advance_us(period); };
+}
+
+int8_t BMI270Simulator::read(uint8_t reg, uint8_t *data, uint32_t len) {
+  if (!this->responding_)
+    return BMI2_E_COM_FAIL;
+  this->advance();
+  this->fifo_tail_ = 0;
+  for (uint32_t i = 0; i < len; i++)
+    data[i] = this->read_byte_(reg, i);
+  this->end_read_();
+  this->record_(false, reg, nullptr, len);
+  return BMI2_OK;
+}
+
+int8_t BMI270Simulator::write(uint8_t reg, const uint8_t *data, uint32_t len) {
+  if (!this->responding_)
+    return BMI2_E_COM_FAIL;
+  this->advance();
+  for (uint32_t i = 0; i < len; i++)
+    this->write_byte_(reg, i, data[i]);
+  this->record_(true, reg, data, len);
+  return BMI2_OK;
+}
+
+void BMI270Simulator::record_(bool write, uint8_t reg, const uint8_t *data, uint32_t len) {
+  this->transactions_++;
+  this->bytes_ += len;
+  if (!this->logging_)
+    return;
+  Transaction t{write, reg, len, {}};
+  if (write)
+    t.data.assign(data, data + len);
+  this->log_.push_back(std::move(t));
+}
+
+void BMI270Simulator::clear_log() {
+  this->log_.clear();
+  this->transactions_ = 0;
+  this->bytes_ = 0;
+}
+
+std::vector<uint8_t> BMI270Simulator::writes_to(uint8_t reg) const {
+  std::vector<uint8_t> values;
+  for (const auto &t : this->log_) {
+    if (t.write && t.reg == reg && !t.data.empty())
+      values.push_back(t.data[0]);
+  }
+  return values;
+}
+
+void BMI270Simulator::set_temperature(int16_t raw) {
+  this->regs_[BMI2_TEMPERATURE_ADDR] = raw & 0xFF;
+  this->regs_[BMI2_TEMPERATURE_ADDR + 1] = (uint16_t) raw >> 8;
+}
+
+bool BMI270Simulator::config_loaded() const {
+  return this->config_bytes_written_ >= sizeof(bmi270_config_file) &&
+         memcmp(this->config_, bmi270_config_file, sizeof(bmi270_config_file)) == 0;
+}
+
+uint64_t BMI270Simulator::now_ticks_() const { return testing::now_us() * 16 / 625 + this->clock_offset_ticks_; }
+
+uint32_t BMI270Simulator::get_sensortime() const { return this->now_ticks_() & BMI2_SENSORTIME_MASK; }
+
+uint16_t BMI270Simulator::fifo_watermark_() const {
+  return this->regs_[BMI2_FIFO_WTM_0_ADDR] | (this->regs_[BMI2_FIFO_WTM_0_ADDR + 1] & 0x1F) << 8;
+}
+
+bool BMI270Simulator::int_level(uint8_t line) const {
+  if ((this->regs_[BMI2_INT1_IO_CTRL_ADDR + line] & BMI2_INT_IO_OUTPUT_EN) == 0)
+    return false;
+  uint8_t map = this->regs_[BMI2_INT_MAP_DATA_ADDR] >> (line * 4);
+  uint16_t level = this->get_fifo_length();
+  uint16_t watermark = this->fifo_watermark_();
+  if ((map & BMI2_FWM_INT) && watermark != 0 && level >= watermark)
+    return true;
+  if ((map & BMI2_FFULL_INT) && level >= BMI2_FIFO_SIZE - 32)
+    return true;
+  if ((map & BMI2_DRDY_INT) && (this->regs_[BMI2_STATUS_ADDR] & BMI2_DRDY_ACC))
+    return true;
+  return (this->regs_[BMI2_INT1_MAP_FEAT_ADDR + line] & this->regs_[BMI2_INT_STATUS_0_ADDR]) != 0;
+}
+
+void BMI270Simulator::advance() {
+  uint64_t now_us = testing::now_us();
+  if (this->init_pending_ && now_us >= this->init_done_us_) {
+    this->init_pending_ = false;
+    // INTERNAL_STATUS message: 1 init_ok, 2 init_err
+    this->regs_[BMI2_INTERNAL_STATUS_ADDR] = this->config_loaded() ? 0x01 : 0x02;
+  }
+  if (this->crt_running_ && now_us >= this->crt_done_us_) {
+    this->crt_running_ = false;
+    this->pages_[BMI2_CRT_PAGE][BMI2_CRT_OFFSET] &= ~BMI2_CRT_RUNNING;
+    this->pages_[BMI2_GYR_GAIN_STATUS_PAGE][BMI2_GYR_GAIN_STATUS_OFFSET] = this->crt_status_ << 3;
+  }
+
+  if ((this->regs_[BMI2_PWR_CTRL_ADDR] & BMI2_PWR_CTRL_ACC_EN) == 0) {
+    this->sampling_ = false;
+    return;
+  }
+  uint64_t ticks = this->now_ticks_();
+  uint32_t period = FifoParser::odr_to_ticks(this->regs_[BMI2_ACC_CONF_ADDR] & 0x0F);
+  if (!this->sampling_) {
+    // Samples fall on multiples of the ODR period on the sensortime clock
+    this->sampling_ = true;
+    this->last_sample_ticks_ = ticks / period * period;
+    return;
+  }
+  while (this->last_sample_ticks_ + period <= ticks) {
+    this->last_sample_ticks_ += period;
+    uint32_t sensortime = this->last_sample_ticks_ & BMI2_SENSORTIME_MASK;
+    int16_t acc[3] = {0, 0, (int16_t) (16384 >> (this->regs_[BMI2_ACC_RANGE_ADDR] & 0x03))};
+    int16_t gyr[3] = {0, 0, 0};
+    if (this->signal_)
+      this->signal_(sensortime, acc, gyr);
+    bool gyr_on = (this->regs_[BMI2_PWR_CTRL_ADDR] & BMI2_PWR_CTRL_GYR_EN) != 0;
+    for (uint8_t i = 0; i < 3; i++) {
+      this->regs_[BMI2_ACC_DATA_ADDR + 2 * i] = (uint16_t) acc[i] & 0xFF;
+      this->regs_[BMI2_ACC_DATA_ADDR + 2 * i + 1] = (uint16_t) acc[i] >> 8;
+      if (gyr_on) {
+        this->regs_[BMI2_GYR_DATA_ADDR + 2 * i] = (uint16_t) gyr[i] & 0xFF;
+        this->regs_[BMI2_GYR_DATA_ADDR + 2 * i + 1] = (uint16_t) gyr[i] >> 8;
+      }
+    }
+    this->regs_[BMI2_STATUS_ADDR] |= BMI2_DRDY_ACC | (gyr_on ? BMI2_DRDY_GYR : 0);
+    if (this->regs_[BMI2_PWR_CTRL_ADDR] & BMI2_PWR_CTRL_AUX_EN)
+      this->regs_[BMI2_STATUS_ADDR] |= BMI2_DRDY_AUX;
+    // Aux data only goes into the frames at the aux ODR
+    uint32_t aux_period = FifoParser::odr_to_ticks(this->regs_[BMI2_AUX_CONF_ADDR] & 0x0F);
+    this->push_frame_(acc, gyr, gyr_on, this->last_sample_ticks_ % aux_period == 0);
+    this->samples_++;
+  }
+}
+
+void BMI270Simulator::push_frame_(const int16_t *acc, const int16_t *gyr, bool gyr_on, bool aux_due) {
+  const uint8_t config = this->regs_[BMI2_FIFO_CONFIG_1_ADDR];
+  const bool acc_en = (config & BMI2_FIFO_ACC_EN) != 0;
+  const bool gyr_en = (config & BMI2_FIFO_GYR_EN) != 0 && gyr_on;
+  const bool header = (config & BMI2_FIFO_HEADER_EN) != 0;
+  const bool aux_en = (config & BMI2_FIFO_AUX_EN) != 0 && header && aux_due;
+  if (!acc_en && !gyr_en)
+    return;
+  if (!header && !(acc_en && gyr_en))
+    return;
+
+  uint8_t frame[1 + BMI2_FIFO_AUX_LENGTH + BMI2_FIFO_GYR_LENGTH + BMI2_FIFO_ACC_LENGTH];
+  uint8_t len = 0;
+  if (header) {
+    frame[len++] = BMI2_FIFO_HEADER_REG_FRM | (aux_en ? BMI2_FIFO_HEADER_AUX_BIT : 0) |
+                   (gyr_en ? BMI2_FIFO_HEADER_GYR_BIT : 0) | (acc_en ? BMI2_FIFO_HEADER_ACC_BIT : 0);
+    if (aux_en) {
+      memcpy(&frame[len], &this->regs_[BMI2_AUX_DATA_ADDR], BMI2_FIFO_AUX_LENGTH);
+      len += BMI2_FIFO_AUX_LENGTH;
+    }
+  }
+  for (uint8_t i = 0; gyr_en && i < 3; i++) {
+    frame[len++] = (uint16_t) gyr[i] & 0xFF;
+    frame[len++] = (uint16_t) gyr[i] >> 8;
+  }
+  for (uint8_t i = 0; acc_en && i < 3; i++) {
+    frame[len++] = (uint16_t) acc[i] & 0xFF;
+    frame[len++] = (uint16_t) acc[i] >> 8;
+  }
+  if (this->get_fifo_length() + len > BMI2_FIFO_SIZE) {
+    this->fifo_overflows_++;
+    return;
+  }
+  this->fifo_.insert(this->fifo_.end(), frame, frame + len);
+}
+
+uint8_t BMI270Simulator::read_byte_(uint8_t reg, uint32_t offset) {
+  if (reg == BMI2_FIFO_DATA_ADDR) {
+    // No auto-increment: every byte comes from the FIFO
+    if (this->fifo_read_pos_ < this->fifo_.size())
+      return this->fifo_[this->fifo_read_pos_++];
+    uint32_t tail = this->fifo_tail_++;
+    if ((this->regs_[BMI2_FIFO_CONFIG_1_ADDR] & BMI2_FIFO_HEADER_EN) == 0)
+      return tail & 1 ? 0x80 : 0x00;
+    if ((this->regs_[BMI2_FIFO_CONFIG_0_ADDR] & BMI2_FIFO_TIME_EN) == 0 || tail > BMI2_FIFO_SENS_TIME_LENGTH)
+      return BMI2_FIFO_HEADER_EMPTY;
+    // Reading past the last frame appends the sensortime frame
+    if (tail == 0) {
+      this->latched_sensortime_ = this->get_sensortime();
+      return BMI2_FIFO_HEADER_SENS_TIME_FRM;
+    }
+    return this->latched_sensortime_ >> (8 * (tail - 1)) & 0xFF;
+  }
+
+  uint8_t addr = (reg + offset) & 0x7F;
+  switch (addr) {
+    case BMI2_AUX_DATA_ADDR:
+      this->regs_[BMI2_STATUS_ADDR] &= ~BMI2_DRDY_AUX;
+      break;
+    case BMI2_ACC_DATA_ADDR:
+      this->regs_[BMI2_STATUS_ADDR] &= ~BMI2_DRDY_ACC;
+      break;
+    case BMI2_GYR_DATA_ADDR:
+      this->regs_[BMI2_STATUS_ADDR] &= ~BMI2_DRDY_GYR;
+      break;
+    case 0x18:
+      this->latched_sensortime_ = this->get_sensortime();
+      return this->latched_sensortime_ & 0xFF;
+    case 0x19:
+      return (this->latched_sensortime_ >> 8) & 0xFF;
+    case 0x1A:
+      return (this->latched_sensortime_ >> 16) & 0xFF;
+    case BMI2_INT_STATUS_0_ADDR: {
+      uint8_t status = this->regs_[addr];
+      this->regs_[addr] = 0;
+      return status;
+    }
+    case BMI2_FIFO_LENGTH_0_ADDR:
+      return this->get_fifo_length() & 0xFF;
+    case BMI2_FIFO_LENGTH_0_ADDR + 1:
+      return this->get_fifo_length() >> 8;
+    default:
+      break;
+  }
+  if (addr >= BMI2_FEATURES_REG_ADDR && addr < BMI2_FEATURES_REG_ADDR + BMI2_FEAT_PAGE_LEN)
+    return this->pages_[this->regs_[BMI2_FEAT_PAGE_ADDR] & 0x07][addr - BMI2_FEATURES_REG_ADDR];
+  return this->regs_[addr];
+}
+
+void BMI270Simulator::write_byte_(uint8_t reg, uint32_t offset, uint8_t value) {
+  if (reg == BMI2_INIT_DATA_ADDR) {
+    // Burst into the config RAM at the word address from INIT_ADDR_0/1
+    uint32_t word_addr = (this->regs_[BMI2_INIT_ADDR_0] & 0x0F) | this->regs_[BMI2_INIT_ADDR_1] << 4;
+    uint32_t index = word_addr * 2 + offset;
+    if (index < sizeof(this->config_)) {
+      this->config_[index] = value;
+      this->config_bytes_written_++;
+    }
+    return;
+  }
+
+  uint8_t addr = (reg + offset) & 0x7F;
+  if (addr >= BMI2_FEATURES_REG_ADDR && addr < BMI2_FEATURES_REG_ADDR + BMI2_FEAT_PAGE_LEN) {
+    this->pages_[this->regs_[BMI2_FEAT_PAGE_ADDR] & 0x07][addr - BMI2_FEATURES_REG_ADDR] = value;
+    return;
+  }
+  switch (addr) {
+    case BMI2_CHIP_ID_ADDR:
+    case BMI2_STATUS_ADDR:
+    case BMI2_INTERNAL_STATUS_ADDR:
+    case BMI2_FIFO_LENGTH_0_ADDR:
+    case BMI2_FIFO_LENGTH_0_ADDR + 1:
+    case BMI2_FIFO_DATA_ADDR:
+      return;
+    case BMI2_CMD_ADDR:
+      this->command_(value);
+      return;
+    case BMI2_INIT_CTRL_ADDR:
+      this->regs_[addr] = value;
+      if (value == 0x01) {
+        this->init_pending_ = true;
+        this->init_done_us_ = testing::now_us() + this->init_delay_us_;
+      }
+      return;
+    default:
+      break;
+  }
+  this->regs_[addr] = value;
+  if (addr == BMI2_AUX_WR_ADDR)
+    this->aux_transfer_(true);
+  else if (addr == BMI2_AUX_RD_ADDR && (this->regs_[BMI2_AUX_IF_CONF_ADDR] & BMI2_AUX_MANUAL_EN))
+    this->aux_transfer_(false);
+}
+
+void BMI270Simulator::aux_transfer_(bool write) {
+  if (write) {
+    this->aux_regs_[this->regs_[BMI2_AUX_WR_ADDR]] = this->regs_[BMI2_AUX_WR_DATA_ADDR];
+    return;
+  }
+  uint8_t start = this->regs_[BMI2_AUX_RD_ADDR];
+  for (uint8_t i = 0; i < BMI2_AUX_MAX_BURST; i++)
+    this->regs_[BMI2_AUX_DATA_ADDR + i] = this->aux_regs_[(uint8_t) (start + i)];
+}
+
+void BMI270Simulator::command_(uint8_t cmd) {
+  switch (cmd) {
+    case BMI2_FIFO_FLUSH_CMD:
+      this->fifo_.clear();
+      this->fifo_read_pos_ = 0;
+      break;
+    case 0xB6:  // soft reset
+      this->power_on_reset();
+      break;
+    case BMI2_G_TRIGGER_CMD: {
+      uint8_t &crt = this->pages_[BMI2_CRT_PAGE][BMI2_CRT_OFFSET];
+      if ((crt & BMI2_CRT_SELECT) == 0)
+        break;
+      if (this->regs_[BMI2_PWR_CTRL_ADDR] & BMI2_PWR_CTRL_GYR_EN) {
+        // Precondition: the gyro must be off
+        crt &= ~BMI2_CRT_RUNNING;
+        this->pages_[BMI2_GYR_GAIN_STATUS_PAGE][BMI2_GYR_GAIN_STATUS_OFFSET] = 1 << 3;
+        break;
+      }
+      this->crt_running_ = true;
+      this->crt_done_us_ = testing::now_us() + CRT_DURATION_US;
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+void BMI270Simulator::end_read_() {
+  if (this->fifo_read_pos_ == this->fifo_.size()) {
+    this->fifo_.clear();
+    this->fifo_read_pos_ = 0;
+  } else if (this->fifo_read_pos_ > BMI2_FIFO_SIZE) {
+    this->fifo_.erase(this->fifo_.begin(), this->fifo_.begin() + this->fifo_read_pos_);
+    this->fifo_read_pos_ = 0;
+  }
+}
+
+i2c::ErrorCode SimI2CBus::read_register(uint8_t address, uint8_t a_register, uint8_t *data, size_t len) {
+  auto it = this->devices_.find(address);
+  if (it == this->devices_.end() || !it->second->is_responding())
+    return i2c::ERROR_NOT_ACKNOWLEDGED;
+  return it->second->read(a_register, data, len) == BMI2_OK ? i2c::ERROR_OK : i2c::ERROR_UNKNOWN;
+}
+
+i2c::ErrorCode SimI2CBus::write_register(uint8_t address, uint8_t a_register, const uint8_t *data, size_t len) {
+  auto it = this->devices_.find(address);
+  if (it == this->devices_.end() || !it->second->is_responding())
+    return i2c::ERROR_NOT_ACKNOWLEDGED;
+  if (this->max_write_len_ != 0 && len > this->max_write_len_)
+    return i2c::ERROR_TOO_LARGE;
+  return it->second->write(a_register, data, len) == BMI2_OK ? i2c::ERROR_OK : i2c::ERROR_UNKNOWN;
+}
+
+void SimSPIBus::begin_transaction() {
+  this->state_ = STATE_ADDRESS;
+  this->count_ = 0;
+  this->written_.clear();
+}
+
+uint8_t SimSPIBus::transfer(uint8_t data) {
+  // Still in I2C mode, or not answering: MISO floats high
+  if (!this->sim_->spi_mode_ || !this->sim_->responding_)
+    return 0xFF;
+  switch (this->state_) {
+    case STATE_ADDRESS:
+      this->reg_ = data & 0x7F;
+      this->state_ = data & 0x80 ? STATE_DUMMY : STATE_WRITE;
+      this->sim_->advance();
+      this->sim_->fifo_tail_ = 0;
+      return 0xFF;
+    case STATE_DUMMY:
+      this->state_ = STATE_READ;
+      return DUMMY_BYTE;
+    case STATE_READ:
+      return this->sim_->read_byte_(this->reg_, this->count_++);
+    case STATE_WRITE:
+      this->sim_->write_byte_(this->reg_, this->count_++, data);
+      this->written_.push_back(data);
+      return 0xFF;
+    default:
+      return 0xFF;
+  }
+}
+
+void SimSPIBus::end_transaction() {
+  if (this->sim_->spi_mode_ && this->sim_->responding_) {
+    if (this->state_ == STATE_READ || this->state_ == STATE_DUMMY) {
+      this->sim_->end_read_();
+      this->sim_->record_(false, this->reg_, nullptr, this->count_);
+    } else if (this->state_ == STATE_WRITE) {
+      this->sim_->record_(true, this->reg_, this->written_.data(), this->count_);
+    }
+  }
+  // The first rising CSB edge switches the interface to SPI
+  this->sim_->spi_mode_ = true;
+  this->state_ = STATE_IDLE;
+}
+
+}  // namespace bmi270
+}  // namespace esphome
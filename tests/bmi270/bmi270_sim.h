@@ -0,0 +1,171 @@
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+#include <map>
+#include <vector>
+
+#include "esphome/components/i2c/i2c.h"
+#include "esphome/components/spi/spi.h"
+#include "esphome/components/bmi270/bmi270_api.h"
+
+// Register-level BMI270 model for host tests. It follows the simulated
+// clock of the ESPHome stand-ins: samples are generated at the configured
+// ODR into the data registers and the FIFO, INIT_OK rises a while after
+// INIT_CTRL, and every transaction is logged. It plugs into bmi2_dev
+// directly, or behind SimI2CBus / SimSPIBus for the component.
+
+namespace esphome {
+namespace bmi270 {
+
+class BMI270Simulator {
+ public:
+  struct Transaction {
+    bool write;
+    uint8_t reg;
+    uint32_t len;
+    std::vector<uint8_t> data;  // written bytes only
+  };
+  // Fills accel and gyro counts for the sample taken at the given sensortime
+  using Signal = std::function<void(uint32_t sensortime, int16_t *acc, int16_t *gyr)>;
+
+  BMI270Simulator();
+
+  // Power-on reset: registers at their reset values, no config, I2C mode
+  void power_on_reset();
+  // Pulls the chip's supply for a moment; the config blob and INIT_OK are lost
+  void brown_out() { this->power_on_reset(); }
+
+  // bmi2_dev transport, with intf_ptr pointing at the simulator
+  void attach(bmi2_dev *dev);
+  int8_t read(uint8_t reg, uint8_t *data, uint32_t len);
+  int8_t write(uint8_t reg, const uint8_t *data, uint32_t len);
+
+  // Sample source; the default is a device lying flat and still at ±2g
+  void set_signal(Signal signal) { this->signal_ = std::move(signal); }
+  // Generates every sample due up to the current simulated time
+  void advance();
+  // Runs this chip's oscillator ahead of the host clock, which moves its
+  // sensortime and its sampling instants by that much
+  void set_clock_offset_us(uint32_t us) { this->clock_offset_ticks_ = (uint64_t) us * 16 / 625; }
+
+  // Fault injection: a chip that stops answering fails every transfer
+  void set_responding(bool responding) { this->responding_ = responding; }
+  bool is_responding() const { return this->responding_; }
+  void set_init_delay_us(uint32_t us) { this->init_delay_us_ = us; }
+  void set_crt_status(uint8_t status) { this->crt_status_ = status; }
+
+  uint8_t get_reg(uint8_t reg) const { return this->regs_[reg & 0x7F]; }
+  void set_reg(uint8_t reg, uint8_t value) { this->regs_[reg & 0x7F] = value; }
+  uint8_t *feature_page(uint8_t page) { return this->pages_[page & 0x07]; }
+  // Feature engine event: sets INT_STATUS_0 bits (any/no-motion, step)
+  void raise_feature_event(uint8_t int_status) { this->regs_[BMI2_INT_STATUS_0_ADDR] |= int_status; }
+  void set_temperature(int16_t raw);
+
+  bool config_loaded() const;
+  uint32_t get_config_bytes_written() const { return this->config_bytes_written_; }
+  bool is_spi_mode() const { return this->spi_mode_; }
+
+  uint16_t get_fifo_length() const { return (uint16_t) (this->fifo_.size() - this->fifo_read_pos_); }
+  uint32_t get_fifo_overflows() const { return this->fifo_overflows_; }
+  uint32_t get_samples() const { return this->samples_; }
+  uint32_t get_sensortime() const;
+  // Level of INT1 (0) or INT2 (1) from the mapped data and feature sources
+  bool int_level(uint8_t line) const;
+
+  const std::vector<Transaction> &get_log() const { return this->log_; }
+  void clear_log();
+  uint32_t get_transactions() const { return this->transactions_; }
+  uint32_t get_bytes() const { return this->bytes_; }
+  // Every value written to a register, in order
+  std::vector<uint8_t> writes_to(uint8_t reg) const;
+  void set_logging(bool logging) { this->logging_ = logging; }
+
+ protected:
+  friend class SimI2CBus;
+  friend class SimSPIBus;
+
+  void record_(bool write, uint8_t reg, const uint8_t *data, uint32_t len);
+  // Single-byte accesses with the chip's addressing rules; offset counts
+  // the bytes since the start of the burst
+  uint8_t read_byte_(uint8_t reg, uint32_t offset);
+  void write_byte_(uint8_t reg, uint32_t offset, uint8_t value);
+  void end_read_();
+  uint64_t now_ticks_() const;
+  void command_(uint8_t cmd);
+  void aux_transfer_(bool write);
+  void push_frame_(const int16_t *acc, const int16_t *gyr, bool gyr_on, bool aux_due);
+  uint16_t fifo_watermark_() const;
+
+  uint8_t regs_[128];
+  uint8_t pages_[8][BMI2_FEAT_PAGE_LEN];
+  uint8_t config_[8192];
+  uint32_t config_bytes_written_{0};
+  bool init_pending_{false};
+  uint64_t init_done_us_{0};
+  uint32_t init_delay_us_{20000};
+  uint8_t crt_status_{0};
+  bool crt_running_{false};
+  uint64_t crt_done_us_{0};
+  bool spi_mode_{false};
+  bool responding_{true};
+
+  Signal signal_;
+  uint64_t clock_offset_ticks_{0};
+  uint64_t last_sample_ticks_{0};
+  bool sampling_{false};
+  uint32_t samples_{0};
+  std::vector<uint8_t> fifo_;
+  uint32_t fifo_read_pos_{0};
+  // Bytes read past the last frame in the current burst
+  uint32_t fifo_tail_{0};
+  uint32_t latched_sensortime_{0};
+  uint32_t fifo_overflows_{0};
+  uint8_t aux_regs_[256];
+
+  std::vector<Transaction> log_;
+  bool logging_{true};
+  uint32_t transactions_{0};
+  uint32_t bytes_{0};
+};
+
+// Chips addressed by I2C address on one bus
+class SimI2CBus : public i2c::I2CBus {
+ public:
+  void add_device(uint8_t address, BMI270Simulator *sim) { this->devices_[address] = sim; }
+  // Writes longer than this fail like an overflowing driver buffer
+  void set_max_write_len(size_t len) { this->max_write_len_ = len; }
+
+  i2c::ErrorCode read_register(uint8_t address, uint8_t a_register, uint8_t *data, size_t len) override;
+  i2c::ErrorCode write_register(uint8_t address, uint8_t a_register, const uint8_t *data, size_t len) override;
+
+ protected:
+  std::map<uint8_t, BMI270Simulator *> devices_;
+  size_t max_write_len_{0};
+};
+
+// The BMI270 SPI protocol: bit 7 of the first byte selects a read, and reads
+// return one byte of garbage before the register data. The chip answers
+// SPI only after a rising CSB edge has switched it out of I2C mode.
+class SimSPIBus : public spi::SPIBus {
+ public:
+  explicit SimSPIBus(BMI270Simulator *sim) : sim_(sim) {}
+
+  void begin_transaction() override;
+  uint8_t transfer(uint8_t data) override;
+  void end_transaction() override;
+
+  // Value clocked out in place of the dummy byte
+  static const uint8_t DUMMY_BYTE = 0xA5;
+
+ protected:
+  enum State : uint8_t { STATE_IDLE, STATE_ADDRESS, STATE_DUMMY, STATE_READ, STATE_WRITE };
+  BMI270Simulator *sim_;
+  State state_{STATE_IDLE};
+  uint8_t reg_{0};
+  uint32_t count_{0};
+  std::vector<uint8_t> written_;
+};
+
+}  // namespace bmi270
+}  // namespace esphome
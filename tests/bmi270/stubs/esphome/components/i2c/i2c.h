@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Host stand-in for the ESPHome I2C device API. Register accesses go to an
+// I2CBus implemented by the test, usually a simulated chip.
+
+namespace esphome {
+namespace i2c {
+
+enum ErrorCode {
+  ERROR_OK = 0,
+  ERROR_INVALID_ARGUMENT,
+  ERROR_NOT_ACKNOWLEDGED,
+  ERROR_TIMEOUT,
+  ERROR_NOT_INITIALIZED,
+  ERROR_TOO_LARGE,
+  ERROR_UNKNOWN,
+};
+
+class I2CBus {
+ public:
+  virtual ~I2CBus() = default;
+  virtual ErrorCode read_register(uint8_t address, uint8_t a_register, uint8_t *data, size_t len) = 0;
+  virtual ErrorCode write_register(uint8_t address, uint8_t a_register, const uint8_t *data, size_t len) = 0;
+};
+
+class I2CDevice {
+ public:
+  void set_i2c_address(uint8_t address) { this->address_ = address; }
+  void set_i2c_bus(I2CBus *bus) { this->bus_ = bus; }
+
+  ErrorCode read_register(uint8_t a_register, uint8_t *data, size_t len) {
+    if (this->bus_ == nullptr)
+      return ERROR_NOT_INITIALIZED;
+    return this->bus_->read_register(this->address_, a_register, data, len);
+  }
+  ErrorCode write_register(uint8_t a_register, const uint8_t *data, size_t len) {
+    if (this->bus_ == nullptr)
+      return ERROR_NOT_INITIALIZED;
+    return this->bus_->write_register(this->address_, a_register, data, len);
+  }
+
+ protected:
+  uint8_t address_{0};
+  I2CBus *bus_{nullptr};
+};
+
+}  // namespace i2c
+}  // namespace esphome
+
+#define LOG_I2C_DEVICE(this) (void) (this)
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "esphome/core/component.h"
+#include "esphome/core/entity_base.h"
+
+// Host stand-in for a sensor: remembers the last state and counts publishes
+
+namespace esphome {
+namespace sensor {
+
+class Sensor : public EntityBase {
+ public:
+  void publish_state(float state) {
+    this->state = state;
+    this->publishes++;
+  }
+  bool has_state() const { return this->publishes != 0; }
+
+  float state{0.0f};
+  uint32_t publishes{0};
+};
+
+}  // namespace sensor
+}  // namespace esphome
+
+#define LOG_SENSOR(prefix, type, obj) (void) (obj)
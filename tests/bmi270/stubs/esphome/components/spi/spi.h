@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "esphome/core/gpio.h"
+
+// Host stand-in for the ESPHome SPI device API. Every byte is clocked
+// through an SPIBus implemented by the test; enable() and disable() are the
+// CS edges.
+
+namespace esphome {
+namespace spi {
+
+enum SPIBitOrder { BIT_ORDER_LSB_FIRST, BIT_ORDER_MSB_FIRST };
+enum SPIClockPolarity { CLOCK_POLARITY_LOW, CLOCK_POLARITY_HIGH };
+enum SPIClockPhase { CLOCK_PHASE_LEADING, CLOCK_PHASE_TRAILING };
+enum SPIDataRate : uint32_t {
+  DATA_RATE_1MHZ = 1000000,
+  DATA_RATE_8MHZ = 8000000,
+  DATA_RATE_10MHZ = 10000000,
+};
+
+class SPIBus {
+ public:
+  virtual ~SPIBus() = default;
+  virtual void begin_transaction() = 0;
+  virtual uint8_t transfer(uint8_t data) = 0;
+  virtual void end_transaction() = 0;
+};
+
+class SPIClient {
+ public:
+  void set_spi_bus(SPIBus *bus) { this->bus_ = bus; }
+
+ protected:
+  SPIBus *bus_{nullptr};
+  GPIOPin *cs_{nullptr};
+};
+
+template<SPIBitOrder BIT_ORDER, SPIClockPolarity CLOCK_POLARITY, SPIClockPhase CLOCK_PHASE, SPIDataRate DATA_RATE>
+class SPIDevice : public SPIClient {
+ public:
+  void spi_setup() {}
+  void enable() { this->bus_->begin_transaction(); }
+  void disable() { this->bus_->end_transaction(); }
+  uint8_t transfer_byte(uint8_t data) { return this->bus_->transfer(data); }
+  void write_byte(uint8_t data) { this->bus_->transfer(data); }
+  uint8_t read_byte() { return this->bus_->transfer(0x00); }
+  void read_array(uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i++)
+      data[i] = this->bus_->transfer(0x00);
+  }
+  void write_array(const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i++)
+      this->bus_->transfer(data[i]);
+  }
+};
+
+}  // namespace spi
+}  // namespace esphome
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "esphome/core/component.h"
+#include "esphome/core/entity_base.h"
+
+// Host stand-in for a text sensor: keeps every published state
+
+namespace esphome {
+namespace text_sensor {
+
+class TextSensor : public EntityBase {
+ public:
+  void publish_state(const std::string &state) {
+    this->state = state;
+    this->history.push_back(state);
+  }
+
+  std::string state;
+  std::vector<std::string> history;
+};
+
+}  // namespace text_sensor
+}  // namespace esphome
+
+#define LOG_TEXT_SENSOR(prefix, type, obj) (void) (obj)
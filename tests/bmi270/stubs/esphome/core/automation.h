@@ -0,0 +1,18 @@
+#pragma once
+
+#include "esphome/core/helpers.h"
+
+// Host stand-in for esphome/core/automation.h; a trigger only counts its firings
+
+namespace esphome {
+
+template<typename... Ts> class Trigger {
+ public:
+  void trigger(Ts... x) { this->count_++; }
+  uint32_t get_count() const { return this->count_; }
+
+ protected:
+  uint32_t count_{0};
+};
+
+}  // namespace esphome
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "esphome/core/helpers.h"
+
+// Host stand-in for esphome/core/component.h. Timeouts are kept per
+// component and fired by the test loop through run_timeouts().
+
+namespace esphome {
+
+namespace setup_priority {
+extern const float BUS;
+extern const float IO;
+extern const float HARDWARE;
+extern const float DATA;
+extern const float PROCESSOR;
+extern const float LATE;
+}  // namespace setup_priority
+
+class Component {
+ public:
+  virtual ~Component() = default;
+  virtual void setup() {}
+  virtual void loop() {}
+  virtual void dump_config() {}
+  virtual void on_shutdown() {}
+  virtual float get_setup_priority() const { return 0.0f; }
+
+  bool status_has_warning() const { return this->warning_; }
+  bool status_has_error() const { return this->error_; }
+  void status_set_warning(const char *message = nullptr) { this->warning_ = true; }
+  void status_clear_warning() { this->warning_ = false; }
+  void status_set_error(const char *message = nullptr) { this->error_ = true; }
+  void status_clear_error() { this->error_ = false; }
+
+  void set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f);
+  bool cancel_timeout(const std::string &name);
+  // Fires every timeout that is due on the simulated clock
+  void run_timeouts();
+  bool has_timeout(const std::string &name) const;
+
+ protected:
+  struct Timeout {
+    std::string name;
+    uint32_t due_ms;
+    std::function<void()> f;
+  };
+  std::vector<Timeout> timeouts_;
+  bool warning_{false};
+  bool error_{false};
+};
+
+class PollingComponent : public Component {
+ public:
+  PollingComponent() = default;
+  explicit PollingComponent(uint32_t update_interval) : update_interval_(update_interval) {}
+  virtual void update() = 0;
+  void set_update_interval(uint32_t update_interval) { this->update_interval_ = update_interval; }
+  uint32_t get_update_interval() const { return this->update_interval_; }
+
+ protected:
+  uint32_t update_interval_{1000};
+};
+
+}  // namespace esphome
@@ -0,0 +1,7 @@
+#pragma once
+
+namespace esphome {
+
+class EntityBase {};
+
+}  // namespace esphome
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+// Host stand-in for esphome/core/gpio.h; tests provide the pin implementation
+
+namespace esphome {
+
+namespace gpio {
+enum InterruptType : uint8_t {
+  INTERRUPT_RISING_EDGE = 1,
+  INTERRUPT_FALLING_EDGE = 2,
+  INTERRUPT_ANY_EDGE = 3,
+};
+}  // namespace gpio
+
+class GPIOPin {
+ public:
+  virtual ~GPIOPin() = default;
+  virtual void setup() = 0;
+  virtual bool digital_read() = 0;
+  virtual void digital_write(bool value) = 0;
+  virtual std::string dump_summary() const = 0;
+};
+
+class InternalGPIOPin : public GPIOPin {
+ public:
+  template<typename T> void attach_interrupt(void (*func)(T *), T *arg, gpio::InterruptType type) const {
+    this->attach_interrupt(reinterpret_cast<void (*)(void *)>(func), arg, type);
+  }
+  virtual void detach_interrupt() const = 0;
+  virtual uint8_t get_pin() const = 0;
+
+ protected:
+  virtual void attach_interrupt(void (*func)(void *), void *arg, gpio::InterruptType type) const = 0;
+};
+
+}  // namespace esphome
+
+#define LOG_PIN(prefix, pin) (void) (pin)
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Host stand-in for esphome/core/hal.h. Time is simulated: it only moves
+// when a test advances it or the code under test busy-waits.
+
+#define IRAM_ATTR
+
+namespace esphome {
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void delay_microseconds_safe(uint32_t us);
+
+namespace testing {
+
+uint64_t now_us();
+void set_now_us(uint64_t us);
+void advance_us(uint64_t us);
+
+}  // namespace testing
+}  // namespace esphome
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Host stand-in for the parts of esphome/core/helpers.h the components use
+
+namespace esphome {
+
+template<typename... X> class CallbackManager;
+
+template<typename... Ts> class CallbackManager<void(Ts...)> {
+ public:
+  void add(std::function<void(Ts...)> &&callback) { this->callbacks_.push_back(std::move(callback)); }
+  void call(Ts... args) {
+    for (auto &cb : this->callbacks_)
+      cb(args...);
+  }
+  size_t size() const { return this->callbacks_.size(); }
+
+ protected:
+  std::vector<std::function<void(Ts...)>> callbacks_;
+};
+
+template<typename T> class Parented {
+ public:
+  Parented() {}
+  Parented(T *parent) : parent_(parent) {}
+  T *get_parent() const { return this->parent_; }
+  void set_parent(T *parent) { this->parent_ = parent; }
+
+ protected:
+  T *parent_{nullptr};
+};
+
+template<typename T> T clamp(T value, T min, T max) { return value < min ? min : (value > max ? max : value); }
+
+uint32_t fnv1_hash(const std::string &str);
+std::string base64_encode(const uint8_t *buf, size_t buf_len);
+std::vector<uint8_t> base64_decode(const std::string &encoded);
+
+}  // namespace esphome
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <inttypes.h>
+
+// Host stand-in for esphome/core/log.h. Messages are formatted (so bad
+// format strings still show up under the sanitizers) and printed only when
+// BMI270_TEST_LOG is set in the environment.
+
+#define ESPHOME_LOG_LEVEL_ERROR 1
+#define ESPHOME_LOG_LEVEL_WARN 2
+#define ESPHOME_LOG_LEVEL_INFO 3
+#define ESPHOME_LOG_LEVEL_CONFIG 4
+#define ESPHOME_LOG_LEVEL_DEBUG 5
+#define ESPHOME_LOG_LEVEL_VERBOSE 6
+
+#define ESP_LOGE(tag, ...) esphome::testing::log(ESPHOME_LOG_LEVEL_ERROR, tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) esphome::testing::log(ESPHOME_LOG_LEVEL_WARN, tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) esphome::testing::log(ESPHOME_LOG_LEVEL_INFO, tag, __VA_ARGS__)
+#define ESP_LOGCONFIG(tag, ...) esphome::testing::log(ESPHOME_LOG_LEVEL_CONFIG, tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) esphome::testing::log(ESPHOME_LOG_LEVEL_DEBUG, tag, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) esphome::testing::log(ESPHOME_LOG_LEVEL_VERBOSE, tag, __VA_ARGS__)
+
+namespace esphome {
+namespace testing {
+
+void log(int level, const char *tag, const char *format, ...) __attribute__((format(printf, 3, 4)));
+// Errors and warnings logged since the last reset
+uint32_t get_log_count(int level);
+void reset_log_counts();
+
+}  // namespace testing
+}  // namespace esphome
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Host stand-in for esphome/core/preferences.h, backed by an in-memory map
+// that survives component instances until testing::clear_preferences()
+
+namespace esphome {
+
+namespace testing {
+bool preference_save(uint32_t key, const void *data, size_t len);
+bool preference_load(uint32_t key, void *data, size_t len);
+void clear_preferences();
+}  // namespace testing
+
+class ESPPreferenceObject {
+ public:
+  ESPPreferenceObject() = default;
+  explicit ESPPreferenceObject(uint32_t key) : key_(key), valid_(true) {}
+
+  template<typename T> bool save(const T *src) {
+    return this->valid_ && testing::preference_save(this->key_, src, sizeof(T));
+  }
+  template<typename T> bool load(T *dest) {
+    return this->valid_ && testing::preference_load(this->key_, dest, sizeof(T));
+  }
+
+ protected:
+  uint32_t key_{0};
+  bool valid_{false};
+};
+
+class ESPPreferences {
+ public:
+  template<typename T> ESPPreferenceObject make_preference(uint32_t type, bool in_flash) {
+    return ESPPreferenceObject(type);
+  }
+  template<typename T> ESPPreferenceObject make_preference(uint32_t type) { return ESPPreferenceObject(type); }
+};
+
+extern ESPPreferences *global_preferences;
+
+}  // namespace esphome
@@ -0,0 +1,173 @@
+#include "esphome/core/component.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+#include "esphome/core/preferences.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+#include <vector>
+
+namespace esphome {
+
+namespace setup_priority {
+const float BUS = 1000.0f;
+const float IO = 900.0f;
+const float HARDWARE = 800.0f;
+const float DATA = 600.0f;
+const float PROCESSOR = 400.0f;
+const float LATE = -100.0f;
+}  // namespace setup_priority
+
+static uint64_t now_us_ = 0;
+
+uint32_t millis() { return (uint32_t) (now_us_ / 1000); }
+uint32_t micros() { return (uint32_t) now_us_; }
+void delay(uint32_t ms) { now_us_ += (uint64_t) ms * 1000; }
+void delayMicroseconds(uint32_t us) { now_us_ += us; }
+void delay_microseconds_safe(uint32_t us) { now_us_ += us; }
+
+namespace testing {
+
+uint64_t now_us() { return now_us_; }
+void set_now_us(uint64_t us) { now_us_ = us; }
+void advance_us(uint64_t us) { now_us_ += us; }
+
+static uint32_t log_counts[ESPHOME_LOG_LEVEL_VERBOSE + 1];
+
+void log(int level, const char *tag, const char *format, ...) {
+  char buf[512];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  if (level >= 0 && level <= ESPHOME_LOG_LEVEL_VERBOSE)
+    log_counts[level]++;
+  static const bool enabled = getenv("BMI270_TEST_LOG") != nullptr;
+  if (enabled)
+    printf("[%8.3f][%d][%s] %s\n", now_us_ / 1000.0, level, tag, buf);
+}
+
+uint32_t get_log_count(int level) { return log_counts[level]; }
+void reset_log_counts() { memset(log_counts, 0, sizeof(log_counts)); }
+
+static std::map<uint32_t, std::vector<uint8_t>> &preferences() {
+  static std::map<uint32_t, std::vector<uint8_t>> store;
+  return store;
+}
+
+bool preference_save(uint32_t key, const void *data, size_t len) {
+  const uint8_t *bytes = static_cast<const uint8_t *>(data);
+  preferences()[key].assign(bytes, bytes + len);
+  return true;
+}
+
+bool preference_load(uint32_t key, void *data, size_t len) {
+  auto it = preferences().find(key);
+  if (it == preferences().end() || it->second.size() != len)
+    return false;
+  memcpy(data, it->second.data(), len);
+  return true;
+}
+
+void clear_preferences() { preferences().clear(); }
+
+}  // namespace testing
+
+static ESPPreferences preferences_instance;
+ESPPreferences *global_preferences = &preferences_instance;
+
+void Component::set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f) {
+  this->cancel_timeout(name);
+  this->timeouts_.push_back({name, millis() + timeout, std::move(f)});
+}
+
+bool Component::cancel_timeout(const std::string &name) {
+  for (auto it = this->timeouts_.begin(); it != this->timeouts_.end(); ++it) {
+    if (it->name == name) {
+      this->timeouts_.erase(it);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Component::has_timeout(const std::string &name) const {
+  for (const auto &timeout : this->timeouts_) {
+    if (timeout.name == name)
+      return true;
+  }
+  return false;
+}
+
+void Component::run_timeouts() {
+  // A callback may add or cancel timeouts, so take one due entry at a time
+  bool fired = true;
+  while (fired) {
+    fired = false;
+    for (auto it = this->timeouts_.begin(); it != this->timeouts_.end(); ++it) {
+      if ((int32_t) (millis() - it->due_ms) < 0)
+        continue;
+      std::function<void()> f = std::move(it->f);
+      this->timeouts_.erase(it);
+      f();
+      fired = true;
+      break;
+    }
+  }
+}
+
+uint32_t fnv1_hash(const std::string &str) {
+  uint32_t hash = 2166136261UL;
+  for (char c : str) {
+    hash *= 16777619UL;
+    hash ^= (uint8_t) c;
+  }
+  return hash;
+}
+
+static const char *const BASE64_CHARS = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+std::string base64_encode(const uint8_t *buf, size_t buf_len) {
+  std::string out;
+  size_t i = 0;
+  for (; i + 2 < buf_len; i += 3) {
+    uint32_t v = buf[i] << 16 | buf[i + 1] << 8 | buf[i + 2];
+    out += BASE64_CHARS[(v >> 18) & 0x3F];
+    out += BASE64_CHARS[(v >> 12) & 0x3F];
+    out += BASE64_CHARS[(v >> 6) & 0x3F];
+    out += BASE64_CHARS[v & 0x3F];
+  }
+  if (i < buf_len) {
+    uint32_t v = buf[i] << 16 | (i + 1 < buf_len ? buf[i + 1] << 8 : 0);
+    out += BASE64_CHARS[(v >> 18) & 0x3F];
+    out += BASE64_CHARS[(v >> 12) & 0x3F];
+    out += i + 1 < buf_len ? BASE64_CHARS[(v >> 6) & 0x3F] : '=';
+    out += '=';
+  }
+  return out;
+}
+
+std::vector<uint8_t> base64_decode(const std::string &encoded) {
+  std::vector<uint8_t> out;
+  uint32_t v = 0;
+  int bits = 0;
+  for (char c : encoded) {
+    const char *p = strchr(BASE64_CHARS, c);
+    if (c == '=' || p == nullptr || c == '\0')
+      break;
+    v = v << 6 | (uint32_t) (p - BASE64_CHARS);
+    bits += 6;
+    if (bits >= 8) {
+      bits -= 8;
+      out.push_back((v >> bits) & 0xFF);
+    }
+  }
+  return out;
+}
+
+}  // namespace esphome
@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+
+#include <string.h>
+
+#include "bmi270_sim.h"
+#include "esphome/core/hal.h"
+#include "esphome/components/bmi270/bmi270_api.h"
+#include "esphome/components/bmi270/bmi270_config.h"
+
+// Register-level driver (bmi270_api) against the simulated register map
+
+namespace esphome {
+namespace bmi270 {
+
+class ApiTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    testing::set_now_us(0);
+    this->sim_.attach(&this->dev_);
+  }
+
+  // Accel and gyro powered at 100 Hz, the sample registers still empty
+  void start_sampling() {
+    bmi2_set_pwr_ctrl(BMI2_PWR_CTRL_ACC_EN | BMI2_PWR_CTRL_GYR_EN | BMI2_PWR_CTRL_TEMP_EN, &this->dev_);
+    this->sim_.advance();
+  }
+
+  BMI270Simulator sim_;
+  bmi2_dev dev_{};
+};
+
+TEST_F(ApiTest, InitUploadsConfigAndReportsInitOk) {
+  ASSERT_EQ(bmi270_init(&this->dev_), BMI2_OK);
+  EXPECT_EQ(this->dev_.chip_id, BMI2_CHIP_ID);
+  EXPECT_TRUE(this->sim_.config_loaded());
+  EXPECT_EQ(this->sim_.get_config_bytes_written(), sizeof(bmi270_config_file));
+  EXPECT_EQ(this->sim_.get_reg(BMI2_INTERNAL_STATUS_ADDR) & 0x0F, BMI2_INIT_OK);
+  // Advanced power save is off before the upload, and the load is started last
+  EXPECT_EQ(this->sim_.writes_to(BMI2_PWR_CONF_ADDR), std::vector<uint8_t>{0x00});
+  EXPECT_EQ(this->sim_.writes_to(BMI2_INIT_CTRL_ADDR), (std::vector<uint8_t>{0x00, 0x01}));
+}
+
+TEST_F(ApiTest, ConfigChunkSplitsWordAddress) {
+  // Byte 0x0ABC is word 0x055E: low nibble in INIT_ADDR_0, the rest in INIT_ADDR_1
+  ASSERT_EQ(bmi270_write_config_chunk(0x0ABC, 2, &this->dev_), BMI2_OK);
+  const auto &log = this->sim_.get_log();
+  ASSERT_EQ(log.size(), 2u);
+  EXPECT_EQ(log[0].reg, BMI2_INIT_ADDR_0);
+  EXPECT_EQ(log[0].data, (std::vector<uint8_t>{0x0E, 0x55}));
+  EXPECT_EQ(log[1].reg, BMI2_INIT_DATA_ADDR);
+  EXPECT_EQ(log[1].data, (std::vector<uint8_t>{bmi270_config_file[0x0ABC], bmi270_config_file[0x0ABD]}));
+}
+
+TEST_F(ApiTest, ConfigImageMatchesForAnyChunkSize) {
+  for (uint16_t chunk : {2, 32, 256, 1024}) {
+    this->sim_.power_on_reset();
+    ASSERT_EQ(bmi270_prepare_config_load(&this->dev_), BMI2_OK);
+    const uint16_t size = bmi270_get_config_size();
+    for (uint16_t index = 0; index < size; index += chunk) {
+      uint16_t len = size - index > chunk ? chunk : size - index;
+      ASSERT_EQ(bmi270_write_config_chunk(index, len, &this->dev_), BMI2_OK);
+    }
+    EXPECT_TRUE(this->sim_.config_loaded()) << "chunk size " << chunk;
+  }
+}
+
+TEST_F(ApiTest, InitFailsWithoutConfig) {
+  ASSERT_EQ(bmi270_prepare_config_load(&this->dev_), BMI2_OK);
+  ASSERT_EQ(bmi270_start_config_load(&this->dev_), BMI2_OK);
+  testing::advance_us(150000);
+  uint8_t status = 0;
+  ASSERT_EQ(bmi270_get_init_status(&status, &this->dev_), BMI2_OK);
+  EXPECT_NE(status & BMI2_INIT_OK, BMI2_INIT_OK);
+}
+
+TEST_F(ApiTest, InitFailsOnWrongChipIdOrDeadBus) {
+  this->sim_.set_reg(BMI2_CHIP_ID_ADDR, 0x26);
+  EXPECT_EQ(bmi270_init(&this->dev_), BMI2_E_COM_FAIL);
+  this->sim_.set_reg(BMI2_CHIP_ID_ADDR, BMI2_CHIP_ID);
+  this->sim_.set_responding(false);
+  EXPECT_EQ(bmi270_init(&this->dev_), BMI2_E_COM_FAIL);
+}
+
+TEST_F(ApiTest, SensorConfigRegisters) {
+  bmi2_sens_config accel{};
+  accel.type = BMI2_ACCEL;
+  accel.cfg.acc = {BMI2_ACC_ODR_1600HZ, BMI2_ACC_RANGE_16G, BMI2_ACC_NORMAL_AVG4, BMI2_PERF_OPT_MODE};
+  bmi2_sens_config gyro{};
+  gyro.type = BMI2_GYRO;
+  gyro.cfg.gyr = {BMI2_GYR_ODR_3200HZ, BMI2_GYR_RANGE_125, BMI2_GYR_NORMAL_MODE, BMI2_PERF_OPT_MODE,
+                  BMI2_POWER_OPT_MODE};
+  ASSERT_EQ(bmi270_set_sensor_config(&accel, 1, &this->dev_), BMI2_OK);
+  ASSERT_EQ(bmi270_set_sensor_config(&gyro, 1, &this->dev_), BMI2_OK);
+  EXPECT_EQ(this->sim_.get_reg(BMI2_ACC_CONF_ADDR), 0xAC);
+  EXPECT_EQ(this->sim_.get_reg(BMI2_ACC_RANGE_ADDR), 0x03);
+  EXPECT_EQ(this->sim_.get_reg(BMI2_GYR_CONF_ADDR), 0x6D);
+  EXPECT_EQ(this->sim_.get_reg(BMI2_GYR_RANGE_ADDR), 0x04);
+}
+
+TEST_F(ApiTest, BurstDecodesStatusDataAndSensortime) {
+  uint32_t taken_at = 0;
+  this->sim_.set_signal([&](uint32_t sensortime, int16_t *acc, int16_t *gyr) {
+    const int16_t a[3] = {-1234, 2345, -32768}, g[3] = {32767, -1, 300};
+    memcpy(acc, a, sizeof(a));
+    memcpy(gyr, g, sizeof(g));
+    taken_at = sensortime;
+  });
+  this->start_sampling();
+  testing::advance_us(10000);
+
+  bmi2_burst_data burst{};
+  ASSERT_EQ(bmi2_get_burst_data(&burst, &this->dev_), BMI2_OK);
+  EXPECT_EQ(burst.status & (BMI2_DRDY_ACC | BMI2_DRDY_GYR), BMI2_DRDY_ACC | BMI2_DRDY_GYR);
+  EXPECT_EQ(burst.acc.x, -1234);
+  EXPECT_EQ(burst.acc.y, 2345);
+  EXPECT_EQ(burst.acc.z, -32768);
+  EXPECT_EQ(burst.gyr.x, 32767);
+  EXPECT_EQ(burst.gyr.y, -1);
+  EXPECT_EQ(burst.gyr.z, 300);
+  // Sensortime is read at the end of the burst, after the sample was taken
+  EXPECT_GE(burst.sensortime, taken_at);
+  EXPECT_LT(burst.sensortime - taken_at, 256u);
+
+  // Reading the data clears data-ready until the next sample
+  ASSERT_EQ(bmi2_get_burst_data(&burst, &this->dev_), BMI2_OK);
+  EXPECT_EQ(burst.status & (BMI2_DRDY_ACC | BMI2_DRDY_GYR), 0);
+}
+
+TEST_F(ApiTest, TemperatureDecoding) {
+  this->sim_.set_temperature(-512);
+  int16_t raw = 0;
+  ASSERT_EQ(bmi2_get_temperature(&raw, &this->dev_), BMI2_OK);
+  EXPECT_EQ(raw, -512);
+}
+
+TEST_F(ApiTest, HeaderFifoDrainsFramesAndSensortime) {
+  ASSERT_EQ(bmi2_set_fifo_config(FIFO_MODE_HEADER, false, &this->dev_), BMI2_OK);
+  this->start_sampling();
+  ASSERT_EQ(bmi2_flush_fifo(&this->dev_), BMI2_OK);
+  testing::advance_us(100000);
+
+  uint16_t length = 0;
+  ASSERT_EQ(bmi2_get_fifo_length(&length, &this->dev_), BMI2_OK);
+  EXPECT_EQ(length, 10 * (1 + BMI2_FIFO_ACC_LENGTH + BMI2_FIFO_GYR_LENGTH));
+
+  uint8_t buffer[BMI2_FIFO_BUFFER_SIZE];
+  uint16_t read_len = length + 1 + BMI2_FIFO_SENS_TIME_LENGTH;
+  ASSERT_EQ(bmi2_read_fifo_data(buffer, read_len, &this->dev_), BMI2_OK);
+  FifoParser parser;
+  parser.set_mode(FIFO_MODE_HEADER);
+  ImuSample samples[16];
+  EXPECT_EQ(parser.parse(buffer, read_len, samples, 16), 10);
+  ASSERT_TRUE(parser.has_sensortime());
+  EXPECT_EQ(samples[9].acc[2], 16384 >> (this->sim_.get_reg(BMI2_ACC_RANGE_ADDR) & 0x03));
+
+  ASSERT_EQ(bmi2_get_fifo_length(&length, &this->dev_), BMI2_OK);
+  EXPECT_EQ(length, 0);
+}
+
+TEST_F(ApiTest, OffsetRegisters) {
+  bmi2_offsets offsets{{-3, 5, 127}, {-512, 511, 0x155}};
+  ASSERT_EQ(bmi2_set_offsets(&offsets, true, true, &this->dev_), BMI2_OK);
+  EXPECT_EQ(this->sim_.get_reg(BMI2_ACC_OFF_COMP_0_ADDR), 0xFD);
+  EXPECT_EQ(this->sim_.get_reg(BMI2_ACC_OFF_COMP_0_ADDR + 1), 0x05);
+  EXPECT_EQ(this->sim_.get_reg(BMI2_ACC_OFF_COMP_0_ADDR + 2), 0x7F);
+  EXPECT_EQ(this->sim_.get_reg(BMI2_GYR_OFF_COMP_3_ADDR), 0x00);
+  EXPECT_EQ(this->sim_.get_reg(BMI2_GYR_OFF_COMP_3_ADDR + 1), 0xFF);
+  EXPECT_EQ(this->sim_.get_reg(BMI2_GYR_OFF_COMP_3_ADDR + 2), 0x55);
+  // Upper gyro bits x [1:0], y [3:2], z [5:4], then the enable
+  EXPECT_EQ(this->sim_.get_reg(BMI2_GYR_OFF_COMP_6_ADDR) & 0x7F, BMI2_GYR_OFF_EN | 0x02 << 0 | 0x01 << 2 | 0x01 << 4);
+  EXPECT_TRUE(this->sim_.get_reg(BMI2_NV_CONF_ADDR) & BMI2_NV_ACC_OFF_EN);
+
+  ASSERT_EQ(bmi2_set_offsets(&offsets, false, false, &this->dev_), BMI2_OK);
+  EXPECT_FALSE(this->sim_.get_reg(BMI2_GYR_OFF_COMP_6_ADDR) & BMI2_GYR_OFF_EN);
+  EXPECT_FALSE(this->sim_.get_reg(BMI2_NV_CONF_ADDR) & BMI2_NV_ACC_OFF_EN);
+}
+
+TEST_F(ApiTest, OffsetsKeepGyroGainEnable) {
+  ASSERT_EQ(bmi2_set_gyro_gain_enable(true, &this->dev_), BMI2_OK);
+  EXPECT_EQ(this->sim_.get_reg(BMI2_GYR_OFF_COMP_6_ADDR), BMI2_GYR_GAIN_EN);
+
+  bmi2_offsets offsets{{0, 0, 0}, {-1, 0, 0}};
+  ASSERT_EQ(bmi2_set_offsets(&offsets, false, true, &this->dev_), BMI2_OK);
+  EXPECT_EQ(this->sim_.get_reg(BMI2_GYR_OFF_COMP_6_ADDR), BMI2_GYR_GAIN_EN | BMI2_GYR_OFF_EN | 0x03);
+
+  ASSERT_EQ(bmi2_set_gyro_gain_enable(false, &this->dev_), BMI2_OK);
+  EXPECT_EQ(this->sim_.get_reg(BMI2_GYR_OFF_COMP_6_ADDR), BMI2_GYR_OFF_EN | 0x03);
+}
+
+}  // namespace bmi270
+}  // namespace esphome
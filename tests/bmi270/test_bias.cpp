@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include "bmi270_harness.h"
+
+// BiasEstimator replayed over synthetic temperature traces with a known
+// gyro bias per bin
+
+namespace esphome {
+namespace bmi270 {
+
+static const int16_t ONE_G = 16384;
+
+// Centre of a table bin in °C
+static float bin_centre(int bin) { return BIAS_TABLE_MIN_C + (bin + 0.5f) * BIAS_TABLE_BIN_C; }
+
+class BiasTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Gyro std up to 3 LSB, accel norm within 5% of one g
+    this->estimator_.set_limits(3.0f, ONE_G, 0.05f * ONE_G);
+    this->estimator_.reset();
+  }
+
+  // One window lying flat at a temperature; the gyro alternates by
+  // +/-spread around the bias, so the window mean is exact
+  void window(float temperature, int16_t bias, int16_t spread = 1, int16_t acc_z = ONE_G) {
+    const int16_t acc[3] = {0, 0, acc_z};
+    for (uint8_t i = 0; i < BIAS_WINDOW_SAMPLES; i++) {
+      int16_t g = i & 1 ? bias + spread : bias - spread;
+      const int16_t gyr[3] = {g, (int16_t) -g, (int16_t) (g + 5)};
+      this->estimator_.add_sample(gyr, acc, temperature);
+    }
+  }
+
+  BiasEstimator estimator_;
+};
+
+TEST_F(BiasTest, LearnsEachBinOfARamp) {
+  float bias[3];
+  EXPECT_FALSE(this->estimator_.get_bias(20.0f, bias));
+  // Warming from 4 °C to 24 °C in 4 °C steps, 10 LSB more bias each step
+  for (int bin = 3; bin <= 8; bin++) {
+    for (int i = 0; i < 4; i++)
+      this->window(bin_centre(bin), 10 * bin);
+  }
+  EXPECT_EQ(this->estimator_.get_observations(), 24u);
+  EXPECT_EQ(this->estimator_.get_learned_bins(), 6);
+  EXPECT_TRUE(this->estimator_.is_dirty());
+  for (int bin = 3; bin <= 8; bin++) {
+    EXPECT_EQ(this->estimator_.get_table().weight[bin], 4) << bin;
+    EXPECT_FLOAT_EQ(this->estimator_.get_table().bias[bin][0], 10.0f * bin) << bin;
+    EXPECT_FLOAT_EQ(this->estimator_.get_table().bias[bin][1], -10.0f * bin) << bin;
+    EXPECT_FLOAT_EQ(this->estimator_.get_table().bias[bin][2], 10.0f * bin + 5.0f) << bin;
+  }
+  EXPECT_EQ(this->estimator_.get_table().weight[2], 0);
+  EXPECT_EQ(this->estimator_.get_table().weight[9], 0);
+}
+
+TEST_F(BiasTest, WeightIsCappedSoBinsKeepFollowing) {
+  for (int i = 0; i < BIAS_MAX_WEIGHT + 10; i++)
+    this->window(bin_centre(7), 100);
+  EXPECT_EQ(this->estimator_.get_table().weight[7], BIAS_MAX_WEIGHT);
+  EXPECT_EQ(this->estimator_.get_observations(), BIAS_MAX_WEIGHT + 10u);
+  // At the cap every window moves the bin by 1/64 of its error
+  this->window(bin_centre(7), 164);
+  EXPECT_FLOAT_EQ(this->estimator_.get_table().bias[7][0], 101.0f);
+  EXPECT_EQ(this->estimator_.get_table().weight[7], BIAS_MAX_WEIGHT);
+}
+
+TEST_F(BiasTest, InterpolatesBetweenLearnedBins) {
+  // Bins 3 and 6 learned, the two between them not
+  this->window(bin_centre(3), 20);
+  this->window(bin_centre(6), 80);
+  float bias[3];
+  ASSERT_TRUE(this->estimator_.get_bias(bin_centre(3), bias));
+  EXPECT_FLOAT_EQ(bias[0], 20.0f);
+  ASSERT_TRUE(this->estimator_.get_bias(bin_centre(6), bias));
+  EXPECT_FLOAT_EQ(bias[0], 80.0f);
+  // A third of the way is bin 4's centre
+  ASSERT_TRUE(this->estimator_.get_bias(bin_centre(4), bias));
+  EXPECT_NEAR(bias[0], 40.0f, 1e-4f);
+  EXPECT_NEAR(bias[1], -40.0f, 1e-4f);
+  EXPECT_NEAR(bias[2], 45.0f, 1e-4f);
+  ASSERT_TRUE(this->estimator_.get_bias((bin_centre(4) + bin_centre(5)) / 2.0f, bias));
+  EXPECT_NEAR(bias[0], 50.0f, 1e-4f);
+}
+
+TEST_F(BiasTest, HoldsTheEdgeBinOutsideTheLearnedRange) {
+  this->window(bin_centre(3), 20);
+  this->window(bin_centre(6), 80);
+  float bias[3];
+  // Within the edge bins but past their centres, and far outside the table
+  for (float t : {bin_centre(3) - 1.5f, -40.0f}) {
+    ASSERT_TRUE(this->estimator_.get_bias(t, bias)) << t;
+    EXPECT_FLOAT_EQ(bias[0], 20.0f) << t;
+  }
+  for (float t : {bin_centre(6) + 1.5f, 85.0f}) {
+    ASSERT_TRUE(this->estimator_.get_bias(t, bias)) << t;
+    EXPECT_FLOAT_EQ(bias[0], 80.0f) << t;
+  }
+}
+
+TEST_F(BiasTest, RejectsWindowsWithAccelOffOneG) {
+  // 10% heavy and 10% light: the device is being moved
+  this->window(bin_centre(5), 30, 1, ONE_G * 11 / 10);
+  this->window(bin_centre(5), 30, 1, ONE_G * 9 / 10);
+  EXPECT_EQ(this->estimator_.get_observations(), 0u);
+  // Just inside the limits
+  this->window(bin_centre(5), 30, 1, ONE_G * 104 / 100);
+  this->window(bin_centre(5), 30, 1, ONE_G * 96 / 100);
+  EXPECT_EQ(this->estimator_.get_observations(), 2u);
+}
+
+TEST_F(BiasTest, BadAccelSampleRestartsTheWindow) {
+  const int16_t gyr[3] = {30, 30, 30};
+  const int16_t still[3] = {0, 0, ONE_G};
+  const int16_t bump[3] = {ONE_G, 0, ONE_G};
+  for (uint8_t i = 0; i < BIAS_WINDOW_SAMPLES - 1; i++)
+    this->estimator_.add_sample(gyr, still, bin_centre(5));
+  this->estimator_.add_sample(gyr, bump, bin_centre(5));
+  for (uint8_t i = 0; i < BIAS_WINDOW_SAMPLES - 1; i++)
+    this->estimator_.add_sample(gyr, still, bin_centre(5));
+  EXPECT_EQ(this->estimator_.get_observations(), 0u);
+  this->estimator_.add_sample(gyr, still, bin_centre(5));
+  EXPECT_EQ(this->estimator_.get_observations(), 1u);
+}
+
+TEST_F(BiasTest, RejectsWindowsWithGyroVariance) {
+  // Std of 5 LSB is a slow turn, not a resting chip; 2 LSB is noise
+  this->window(bin_centre(5), 30, 5);
+  EXPECT_EQ(this->estimator_.get_observations(), 0u);
+  this->window(bin_centre(5), 30, 2);
+  EXPECT_EQ(this->estimator_.get_observations(), 1u);
+  EXPECT_FLOAT_EQ(this->estimator_.get_table().bias[5][0], 30.0f);
+}
+
+TEST_F(BiasTest, IgnoresTemperaturesOutsideTheTable) {
+  this->window(BIAS_TABLE_MIN_C - 1.0f, 30);
+  this->window(BIAS_TABLE_MIN_C + BIAS_TABLE_BINS * BIAS_TABLE_BIN_C + 1.0f, 30);
+  EXPECT_EQ(this->estimator_.get_observations(), 0u);
+  EXPECT_EQ(this->estimator_.get_learned_bins(), 0);
+}
+
+}  // namespace bmi270
+}  // namespace esphome
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include "bmi270_harness.h"
+
+// Bus traffic of the polled acquisition path
+
+namespace esphome {
+namespace bmi270 {
+
+class BurstTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    testing::set_now_us(0);
+    testing::clear_preferences();
+    this->bus_.add_device(0x68, &this->sim_);
+    this->imu_.set_i2c_bus(&this->bus_);
+    this->imu_.set_i2c_address(0x68);
+    this->imu_.set_update_interval(100);
+    this->imu_.set_accel_x_sensor(&this->accel_x_);
+    this->imu_.set_gyro_x_sensor(&this->gyro_x_);
+    this->imu_.set_temperature_sensor(&this->temperature_);
+    this->loop_.add(&this->imu_);
+    this->loop_.add_sim(&this->sim_);
+  }
+
+  BMI270Simulator sim_;
+  SimI2CBus bus_;
+  sensor::Sensor accel_x_, gyro_x_, temperature_;
+  TestBMI270 imu_;
+  HostLoop loop_;
+};
+
+TEST_F(BurstTest, OneTransactionPerSamplePlusTemperatureAtOneHertz) {
+  this->loop_.setup();
+  ASSERT_TRUE(this->loop_.run_until([this]() { return this->imu_.is_ready(); }));
+  this->loop_.run_for(1000);
+  this->sim_.clear_log();
+  const uint32_t publishes = this->accel_x_.publishes;
+  const uint32_t transactions = this->imu_.bus_transactions_;
+  const uint32_t bytes = this->imu_.bus_bytes_;
+
+  this->loop_.run_for(10000);
+  const uint32_t samples = this->accel_x_.publishes - publishes;
+  EXPECT_EQ(samples, 100u);
+  uint32_t bursts = 0, temperatures = 0, other = 0;
+  for (const auto &t : this->sim_.get_log()) {
+    if (!t.write && t.reg == BMI2_STATUS_ADDR && t.len == 24)
+      bursts++;
+    else if (!t.write && t.reg == BMI2_TEMPERATURE_ADDR && t.len == 2)
+      temperatures++;
+    else if (!t.write && t.reg == BMI2_INTERNAL_STATUS_ADDR)
+      other++;  // the 10 s health check
+    else
+      ADD_FAILURE() << "unexpected " << (t.write ? "write" : "read") << " of 0x" << std::hex << (int) t.reg;
+  }
+  EXPECT_EQ(bursts, samples);
+  EXPECT_EQ(temperatures, 10u);
+  EXPECT_LE(other, 1u);
+  // 24 bytes per sample and 2 per temperature read, as the component counts them
+  EXPECT_EQ(this->imu_.bus_transactions_ - transactions, bursts + temperatures + other);
+  EXPECT_EQ(this->imu_.bus_bytes_ - bytes, 24 * bursts + 2 * temperatures + other);
+}
+
+TEST_F(BurstTest, GyroAndAccelComeFromTheSameBurst) {
+  this->sim_.set_signal([](uint32_t sensortime, int16_t *acc, int16_t *gyr) {
+    // Both axes carry the sample's sensortime, so a mix of two samples shows
+    acc[0] = (int16_t) (sensortime >> 8);
+    gyr[0] = (int16_t) (sensortime >> 8);
+  });
+  this->loop_.setup();
+  ASSERT_TRUE(this->loop_.run_until([this]() { return this->imu_.is_ready(); }));
+  this->loop_.run_for(3000);
+  ASSERT_TRUE(this->imu_.has_sample_);
+  EXPECT_EQ(this->imu_.last_sample_.acc[0], this->imu_.last_sample_.gyr[0]);
+  EXPECT_EQ((uint32_t) this->imu_.last_sample_.acc[0], (this->imu_.last_sample_.sensortime >> 8) & 0x7FFF);
+}
+
+}  // namespace bmi270
+}  // namespace esphome
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include "bmi270_harness.h"
+
+// Offset calibration (FOC) and the gyro CRT during bring-up
+
+namespace esphome {
+namespace bmi270 {
+
+class CalibrationTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    testing::set_now_us(0);
+    testing::clear_preferences();
+    this->bus_.add_device(0x68, &this->sim_);
+    this->imu_.set_i2c_bus(&this->bus_);
+    this->imu_.set_i2c_address(0x68);
+    this->loop_.add(&this->imu_);
+    this->loop_.add_sim(&this->sim_);
+  }
+
+  void start() {
+    this->loop_.setup();
+    ASSERT_TRUE(this->loop_.run_until([this]() { return this->imu_.is_ready(); }));
+  }
+
+  BMI270Simulator sim_;
+  SimI2CBus bus_;
+  TestBMI270 imu_;
+  HostLoop loop_;
+};
+
+TEST_F(CalibrationTest, FocWritesOffsetsAndStoresThem) {
+  this->imu_.set_accel_calibration(true);
+  this->sim_.set_signal([](uint32_t, int16_t *acc, int16_t *gyr) {
+    acc[0] = 164;  // 0.01 g
+    acc[2] = 16384;
+    gyr[1] = -33;
+  });
+  this->start();
+  EXPECT_TRUE(this->imu_.calibration_.acc_valid);
+  EXPECT_EQ(this->imu_.calibration_.offsets.acc[0], -3);  // 3.9 mg per LSB
+  EXPECT_EQ(this->imu_.calibration_.offsets.gyr[1], 33);
+  EXPECT_TRUE(this->sim_.get_reg(BMI2_NV_CONF_ADDR) & BMI2_NV_ACC_OFF_EN);
+  EXPECT_EQ(this->sim_.get_reg(BMI2_GYR_OFF_COMP_6_ADDR) & ~BMI2_GYR_GAIN_EN, BMI2_GYR_OFF_EN);
+}
+
+TEST_F(CalibrationTest, CrtSuccessEnablesGain) {
+  this->imu_.set_gyro_crt(true);
+  this->sim_.set_signal([](uint32_t, int16_t *acc, int16_t *gyr) {
+    acc[2] = 16384;
+    gyr[0] = 20;
+  });
+  this->start();
+  EXPECT_EQ(this->sim_.writes_to(BMI2_CMD_ADDR).back(), BMI2_G_TRIGGER_CMD);
+  // FOC runs after the CRT and rewrites 0x77 without dropping the gain enable
+  uint8_t comp_6 = this->sim_.get_reg(BMI2_GYR_OFF_COMP_6_ADDR);
+  EXPECT_TRUE(comp_6 & BMI2_GYR_GAIN_EN);
+  EXPECT_TRUE(comp_6 & BMI2_GYR_OFF_EN);
+  EXPECT_EQ(this->imu_.calibration_.offsets.gyr[0], -20);
+}
+
+TEST_F(CalibrationTest, CrtFailureLeavesGainDisabled) {
+  this->imu_.set_gyro_crt(true);
+  this->sim_.set_crt_status(3);  // aborted
+  this->start();
+  EXPECT_FALSE(this->sim_.get_reg(BMI2_GYR_OFF_COMP_6_ADDR) & BMI2_GYR_GAIN_EN);
+  EXPECT_TRUE(this->imu_.calibration_.gyr_valid);
+}
+
+}  // namespace bmi270
+}  // namespace esphome
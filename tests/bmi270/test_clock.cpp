@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+
+#include <math.h>
+
+#include "bmi270_harness.h"
+
+// SensorClock fed with synthetic (sensortime, micros()) pairs: a sensor
+// oscillator off by a known ppm and a jittered read delay
+
+namespace esphome {
+namespace bmi270 {
+
+static const double NOMINAL_TICK_US = 39.0625;
+
+class ClockTest : public ::testing::Test {
+ protected:
+  // Sensor ticks run drift_ppm slower than nominal; the counter starts at
+  // start_ticks at local time 0
+  void chip(double drift_ppm, uint32_t start_ticks = 0) {
+    this->tick_us_ = NOMINAL_TICK_US * (1.0 + drift_ppm * 1e-6);
+    this->start_ticks_ = start_ticks;
+  }
+
+  uint32_t sensortime_at(double local_us) const {
+    return (uint32_t) ((uint64_t) floor(local_us / this->tick_us_) + this->start_ticks_) & BMI2_SENSORTIME_MASK;
+  }
+
+  // Deterministic read delay in [0, max_delay_us_)
+  uint32_t delay_us() {
+    this->seed_ = this->seed_ * 1664525u + 1013904223u;
+    return this->max_delay_us_ == 0 ? 0 : (this->seed_ >> 8) % this->max_delay_us_;
+  }
+
+  // One read per period: sensortime is latched, micros() taken after the
+  // delay
+  void poll(uint32_t count, uint32_t period_us = 100000) {
+    for (uint32_t i = 0; i < count; i++) {
+      this->now_us_ += period_us;
+      this->clock_.observe(this->sensortime_at(this->now_us_), (uint32_t) (this->now_us_ + this->delay_us()));
+    }
+  }
+
+  // Mapping error of a sensortime latched at the current instant
+  int32_t mapping_error_us() const {
+    return (int32_t) (this->clock_.to_local_us(this->sensortime_at(this->now_us_)) - (uint32_t) this->now_us_);
+  }
+
+  SensorClock clock_;
+  double tick_us_{NOMINAL_TICK_US};
+  uint32_t start_ticks_{0};
+  double now_us_{0.0};
+  uint32_t seed_{1};
+  uint32_t max_delay_us_{600};
+};
+
+TEST_F(ClockTest, DriftConvergesUnderReadJitter) {
+  // Mean read delay 300 us, up to 600 us
+  for (double ppm : {-15000.0, -800.0, 0.0, 2500.0, 12000.0}) {
+    this->clock_.reset();
+    this->chip(ppm);
+    this->now_us_ = 0.0;
+    this->poll(5 * 60 * 10);
+    EXPECT_TRUE(this->clock_.is_locked()) << ppm;
+    EXPECT_NEAR(this->clock_.get_drift_ppm(), ppm, 20.0) << ppm;
+    // Weighted towards the minimum-delay path: with delays spread evenly
+    // over 0-600 us the 8:1 gains settle about 150 us after the earliest
+    // reads, half the mean delay
+    int32_t error = 0;
+    for (int i = 0; i < 100; i++) {
+      this->poll(1);
+      error += this->mapping_error_us();
+    }
+    EXPECT_GT(error / 100, -40) << ppm;
+    EXPECT_LT(error / 100, 200) << ppm;
+    EXPECT_EQ(this->clock_.get_resyncs(), 0u) << ppm;
+  }
+}
+
+TEST_F(ClockTest, RateWaitsForABaseline) {
+  this->chip(1000.0);
+  this->max_delay_us_ = 0;
+  // Within the first second of sensortime the nominal rate stands
+  this->poll(11);
+  EXPECT_FALSE(this->clock_.is_locked());
+  EXPECT_EQ(this->clock_.get_drift_ppm(), 0.0f);
+  this->poll(1);
+  EXPECT_NEAR(this->clock_.get_drift_ppm(), 1000.0, 50.0);
+}
+
+TEST_F(ClockTest, RateIsClampedToTheTrimRange) {
+  // 5% is beyond what a trimmed oscillator does; the rate stops at 1/32
+  this->chip(50000.0);
+  this->max_delay_us_ = 0;
+  this->poll(100);
+  EXPECT_NEAR(this->clock_.get_drift_ppm(), 31250.0, 1.0);
+}
+
+TEST_F(ClockTest, MappingIsContinuousAcrossTheWrap) {
+  // The 24-bit counter wraps 3 s in, after the mapping has locked
+  const uint32_t wrap_in = 76800;
+  this->chip(300.0, BMI2_SENSORTIME_MASK + 1 - wrap_in);
+  this->max_delay_us_ = 0;
+  this->poll(40);
+  ASSERT_TRUE(this->clock_.is_locked());
+  EXPECT_LT(this->sensortime_at(this->now_us_), wrap_in);
+  EXPECT_EQ(this->clock_.get_resyncs(), 0u);
+  // One tick apart on either side of the wrap
+  int32_t step = (int32_t) (this->clock_.to_local_us(0) - this->clock_.to_local_us(BMI2_SENSORTIME_MASK));
+  EXPECT_NEAR(step, NOMINAL_TICK_US, 1);
+  // Samples from before the wrap still map to their local time
+  double before_us = (wrap_in - 2560) * this->tick_us_;
+  int32_t error = (int32_t) (this->clock_.to_local_us(this->sensortime_at(before_us)) - (uint32_t) before_us);
+  EXPECT_NEAR(error, 0, 60);
+  EXPECT_NEAR(this->mapping_error_us(), 0, 60);
+}
+
+TEST_F(ClockTest, StepErrorResyncsOnce) {
+  this->chip(-2000.0);
+  this->poll(200);
+  ASSERT_TRUE(this->clock_.is_locked());
+  // The sensor restarts its counter: a 50 ms jump in the mapping
+  this->start_ticks_ += 1280;
+  this->poll(1);
+  EXPECT_EQ(this->clock_.get_resyncs(), 1u);
+  this->poll(200);
+  EXPECT_EQ(this->clock_.get_resyncs(), 1u);
+  EXPECT_NEAR(this->mapping_error_us(), 0, 150);
+  EXPECT_NEAR(this->clock_.get_drift_ppm(), -2000.0, 100.0);
+}
+
+TEST_F(ClockTest, LongGapReseedsWithoutResync) {
+  this->chip(500.0);
+  this->poll(100);
+  ASSERT_TRUE(this->clock_.is_locked());
+  // Six minutes without a read, e.g. paused while still
+  this->poll(1, 360000000);
+  EXPECT_FALSE(this->clock_.is_locked());
+  EXPECT_TRUE(this->clock_.has_reference());
+  EXPECT_EQ(this->clock_.get_resyncs(), 0u);
+}
+
+}  // namespace bmi270
+}  // namespace esphome
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include "bmi270_harness.h"
+
+// Any-motion / no-motion: feature page bytes, interrupt routing and the
+// binary sensors
+
+namespace esphome {
+namespace bmi270 {
+
+TEST(FeaturePageTest, MotionBlockLayoutKeepsNeighbours) {
+  testing::set_now_us(0);
+  BMI270Simulator sim;
+  bmi2_dev dev{};
+  sim.attach(&dev);
+  // Bytes of other features on the page, and the reserved bits [14:11]
+  // of the threshold word
+  uint8_t *page = sim.feature_page(BMI2_ANY_MOT_PAGE);
+  for (uint8_t i = 0; i < BMI2_FEAT_PAGE_LEN; i++)
+    page[i] = 0x50 + i;
+  page[BMI2_ANY_MOT_OFFSET + 3] = 0x78;
+
+  // Out-of-range fields are masked to 13 and 11 bits
+  bmi2_motion_config config{0xE123, 0xF9A5, 0x0D, true};
+  ASSERT_EQ(bmi2_set_motion_config(BMI2_ANY_MOT_PAGE, BMI2_ANY_MOT_OFFSET, &config, &dev), BMI2_OK);
+  for (uint8_t i = 0; i < BMI2_ANY_MOT_OFFSET; i++)
+    EXPECT_EQ(page[i], 0x50 + i) << "byte " << (int) i;
+  // Word 0: duration 0x0123, axes x and z; word 1: threshold 0x1A5, enable
+  EXPECT_EQ(page[BMI2_ANY_MOT_OFFSET + 0], 0x23);
+  EXPECT_EQ(page[BMI2_ANY_MOT_OFFSET + 1], 0xA1);
+  EXPECT_EQ(page[BMI2_ANY_MOT_OFFSET + 2], 0xA5);
+  EXPECT_EQ(page[BMI2_ANY_MOT_OFFSET + 3], 0xF9);
+  EXPECT_EQ(sim.get_reg(BMI2_FEAT_PAGE_ADDR), BMI2_ANY_MOT_PAGE);
+
+  config.enable = false;
+  ASSERT_EQ(bmi2_set_motion_config(BMI2_ANY_MOT_PAGE, BMI2_ANY_MOT_OFFSET, &config, &dev), BMI2_OK);
+  EXPECT_EQ(page[BMI2_ANY_MOT_OFFSET + 3], 0x79);
+}
+
+class FeatureTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    testing::set_now_us(0);
+    testing::clear_preferences();
+    this->bus_.add_device(0x68, &this->sim_);
+    this->imu_.set_i2c_bus(&this->bus_);
+    this->imu_.set_i2c_address(0x68);
+    this->imu_.set_update_interval(100);
+    this->imu_.set_accel_x_sensor(&this->accel_x_);
+    // 0.08 g for 100 ms to wake, still for 1 s
+    this->imu_.set_any_motion_config(164, 5);
+    this->imu_.set_no_motion_config(164, 50);
+    this->imu_.set_any_motion_binary_sensor(&this->moving_);
+    this->imu_.set_no_motion_binary_sensor(&this->still_);
+    this->loop_.add(&this->imu_);
+    this->loop_.add_sim(&this->sim_);
+  }
+
+  void start() {
+    this->loop_.setup();
+    ASSERT_TRUE(this->loop_.run_until([this]() { return this->imu_.is_ready(); }));
+  }
+
+  // The block as the feature engine reads it: two little-endian words
+  std::vector<uint8_t> block(uint8_t page, uint8_t offset) {
+    const uint8_t *data = this->sim_.feature_page(page) + offset;
+    return std::vector<uint8_t>(data, data + 4);
+  }
+
+  BMI270Simulator sim_;
+  SimI2CBus bus_;
+  SimPin int1_{&sim_, 0, 4};
+  SimPin int2_{&sim_, 1, 5};
+  sensor::Sensor accel_x_;
+  binary_sensor::BinarySensor moving_, still_;
+  TestBMI270 imu_;
+  HostLoop loop_;
+};
+
+TEST_F(FeatureTest, ProgramsAnyAndNoMotionBlocks) {
+  this->start();
+  // duration | xyz << 13, then threshold | enable << 15
+  EXPECT_EQ(this->block(BMI2_ANY_MOT_PAGE, BMI2_ANY_MOT_OFFSET), (std::vector<uint8_t>{0x05, 0xE0, 0xA4, 0x80}));
+  EXPECT_EQ(this->block(BMI2_NO_MOT_PAGE, BMI2_NO_MOT_OFFSET), (std::vector<uint8_t>{0x32, 0xE0, 0xA4, 0x80}));
+  // Without a pin nothing is mapped, INT_STATUS_0 is polled
+  EXPECT_EQ(this->sim_.get_reg(BMI2_INT1_MAP_FEAT_ADDR), 0x00);
+  EXPECT_EQ(this->sim_.get_reg(BMI2_INT2_MAP_FEAT_ADDR), 0x00);
+}
+
+TEST_F(FeatureTest, PolledStatusDrivesBinarySensors) {
+  this->start();
+  this->sim_.raise_feature_event(BMI2_ANY_MOT_INT);
+  this->loop_.run_for(100);
+  EXPECT_TRUE(this->moving_.state);
+  EXPECT_FALSE(this->still_.state);
+  EXPECT_FALSE(this->imu_.still_);
+
+  // The engine repeats any-motion while the device moves; nothing changes
+  this->sim_.raise_feature_event(BMI2_ANY_MOT_INT);
+  this->loop_.run_for(100);
+  EXPECT_EQ(this->moving_.history.size(), 1u);
+
+  this->sim_.raise_feature_event(BMI2_NO_MOT_INT);
+  this->loop_.run_for(100);
+  EXPECT_EQ(this->moving_.history, (std::vector<bool>{true, false}));
+  EXPECT_EQ(this->still_.history, (std::vector<bool>{false, true}));
+  EXPECT_TRUE(this->imu_.still_);
+}
+
+TEST_F(FeatureTest, FeaturesOnInt2DataOnInt1) {
+  this->imu_.set_int1_pin(&this->int1_);
+  this->imu_.set_int2_pin(&this->int2_);
+  this->loop_.add_pin(&this->int1_);
+  this->loop_.add_pin(&this->int2_);
+  this->start();
+  EXPECT_EQ(this->imu_.feature_int_pin_, &this->int2_);
+  EXPECT_EQ(this->imu_.data_int_pin_, &this->int1_);
+  EXPECT_EQ(this->sim_.get_reg(BMI2_INT2_MAP_FEAT_ADDR), BMI2_ANY_MOT_INT | BMI2_NO_MOT_INT);
+  EXPECT_EQ(this->sim_.get_reg(BMI2_INT1_MAP_FEAT_ADDR), 0x00);
+
+  // The edge is serviced from loop(), well before the next poll
+  this->loop_.run_for(150);
+  this->sim_.raise_feature_event(BMI2_ANY_MOT_INT);
+  this->loop_.run_for(2);
+  EXPECT_GE(this->int2_.get_edges(), 1u);
+  EXPECT_TRUE(this->moving_.state);
+  EXPECT_EQ(this->sim_.get_reg(BMI2_INT_STATUS_0_ADDR), 0);
+}
+
+TEST_F(FeatureTest, PauseWhenStillOnlyPollsTheStatus) {
+  this->imu_.set_pause_when_still(true);
+  this->start();
+  this->loop_.run_for(500);
+  uint32_t publishes = this->accel_x_.publishes;
+  EXPECT_GT(publishes, 0u);
+
+  this->sim_.raise_feature_event(BMI2_NO_MOT_INT);
+  this->loop_.run_for(100);
+  ASSERT_TRUE(this->imu_.still_);
+  publishes = this->accel_x_.publishes;
+  this->sim_.clear_log();
+  this->loop_.run_for(1000);
+  // One INT_STATUS_0 read per poll, and nothing published
+  EXPECT_EQ(this->accel_x_.publishes, publishes);
+  ASSERT_FALSE(this->sim_.get_log().empty());
+  for (const auto &txn : this->sim_.get_log()) {
+    EXPECT_FALSE(txn.write);
+    EXPECT_EQ(txn.reg, BMI2_INT_STATUS_0_ADDR);
+  }
+
+  this->sim_.raise_feature_event(BMI2_ANY_MOT_INT);
+  this->loop_.run_for(300);
+  EXPECT_FALSE(this->imu_.still_);
+  EXPECT_GT(this->accel_x_.publishes, publishes);
+}
+
+}  // namespace bmi270
+}  // namespace esphome
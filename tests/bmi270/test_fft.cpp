@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <math.h>
+
+#include "esphome/components/bmi270/bmi270_fft.h"
+
+// SpectrumAnalyzer against known sines and a direct DFT
+
+namespace esphome {
+namespace bmi270 {
+
+static const float RATE = 1600.0f;
+static const double PI = 3.14159265358979323846;
+
+class FftTest : public ::testing::Test {
+ protected:
+  void SetUp() override { this->fft_.init(RATE); }
+
+  void add_sine(float freq, float amplitude, float offset = 0.0f, uint16_t blocks = 1) {
+    for (uint32_t n = 0; n < (uint32_t) blocks * SpectrumAnalyzer::SIZE; n++)
+      this->fft_.add_sample(offset + amplitude * (float) sin(2.0 * PI * freq * n / RATE));
+  }
+
+  float bin_energy(uint16_t k) {
+    float width = this->fft_.get_bin_width();
+    return this->fft_.get_band_energy((k - 0.5f) * width, (k + 0.5f) * width);
+  }
+
+  SpectrumAnalyzer fft_;
+};
+
+TEST_F(FftTest, DominantFrequencyOfKnownSines) {
+  // Below and above fs/4, on and between bins
+  for (float freq : {50.0f, 103.0f, 312.5f, 450.0f, 500.0f, 613.0f, 700.0f}) {
+    this->fft_.init(RATE);
+    this->add_sine(freq, 1.0f);
+    ASSERT_EQ(this->fft_.get_blocks(), 1);
+    EXPECT_NEAR(this->fft_.get_dominant_frequency(), freq, 0.5f * this->fft_.get_bin_width()) << freq << " Hz";
+  }
+}
+
+TEST_F(FftTest, EveryBinPeaksAtItself) {
+  // Next to DC and Nyquist the negative-frequency image leaks into the
+  // interpolation, so the sweep leaves out the outermost bin on each side
+  const float width = RATE / SpectrumAnalyzer::SIZE;
+  for (uint16_t k = 2; k < SpectrumAnalyzer::BINS - 2; k++) {
+    this->fft_.init(RATE);
+    this->add_sine(k * width, 1.0f);
+    EXPECT_NEAR(this->fft_.get_dominant_frequency(), k * width, 0.05f * width) << "bin " << k;
+    EXPECT_NEAR(this->fft_.get_peak_amplitude(), 1.0f, 0.01f) << "bin " << k;
+  }
+}
+
+TEST_F(FftTest, BandEnergyIsMeanSquare) {
+  // A sine of amplitude 2 has a mean square of 2, also with gravity on top
+  this->add_sine(100.0f, 2.0f, 9.81f, 4);
+  EXPECT_EQ(this->fft_.get_blocks(), 4);
+  EXPECT_NEAR(this->fft_.get_band_energy(50.0f, 150.0f), 2.0f, 0.02f);
+  EXPECT_NEAR(this->fft_.get_band_energy(550.0f, 650.0f), 0.0f, 1e-4f);
+  EXPECT_NEAR(this->fft_.get_peak_amplitude(), 2.0f, 0.02f);
+
+  this->fft_.reset_average();
+  this->add_sine(650.0f, 2.0f);
+  EXPECT_NEAR(this->fft_.get_band_energy(600.0f, 700.0f), 2.0f, 0.02f);
+  EXPECT_NEAR(this->fft_.get_band_energy(50.0f, 150.0f), 0.0f, 1e-4f);
+}
+
+TEST_F(FftTest, MatchesDirectDft) {
+  const uint16_t size = SpectrumAnalyzer::SIZE;
+  float x[size];
+  uint32_t seed = 1;
+  for (uint16_t n = 0; n < size; n++) {
+    seed = seed * 1664525u + 1013904223u;
+    x[n] = (float) (seed >> 8) / (1 << 24) - 0.5f;
+    this->fft_.add_sample(x[n]);
+  }
+
+  // Mean-removed, Hann-windowed block, one-sided power scaled as the analyzer does
+  double mean = 0.0, window_sq = 0.0;
+  for (uint16_t n = 0; n < size; n++)
+    mean += x[n] / size;
+  double xw[size];
+  for (uint16_t n = 0; n < size; n++) {
+    double w = 0.5 - 0.5 * cos(2.0 * PI * n / size);
+    xw[n] = (x[n] - mean) * w;
+    window_sq += w * w;
+  }
+  for (uint16_t k = 1; k < SpectrumAnalyzer::BINS; k++) {
+    double re = 0.0, im = 0.0;
+    for (uint16_t n = 0; n < size; n++) {
+      re += xw[n] * cos(2.0 * PI * k * n / size);
+      im -= xw[n] * sin(2.0 * PI * k * n / size);
+    }
+    double expected = 2.0 * (re * re + im * im) / (size * window_sq);
+    EXPECT_NEAR(this->bin_energy(k), expected, 1e-4 + 1e-3 * expected) << "bin " << k;
+  }
+}
+
+TEST_F(FftTest, EmptyAverageIsNan) {
+  this->add_sine(50.0f, 1.0f);
+  this->fft_.reset_average();
+  EXPECT_TRUE(isnan(this->fft_.get_dominant_frequency()));
+  EXPECT_TRUE(isnan(this->fft_.get_band_energy(0.0f, 800.0f)));
+}
+
+}  // namespace bmi270
+}  // namespace esphome
@@ -0,0 +1,295 @@
+#include <gtest/gtest.h>
+
+#include "bmi270_harness.h"
+
+// FifoParser against hand-built FIFO byte dumps, watermark sizing and
+// interrupt-driven batches
+
+namespace esphome {
+namespace bmi270 {
+
+// Builds a FIFO byte dump frame by frame
+class FifoDump {
+ public:
+  FifoDump &header(uint8_t header) {
+    this->bytes.push_back(header);
+    return *this;
+  }
+  FifoDump &word(int16_t value) {
+    this->bytes.push_back((uint16_t) value & 0xFF);
+    this->bytes.push_back((uint16_t) value >> 8);
+    return *this;
+  }
+  FifoDump &axes(int16_t x, int16_t y, int16_t z) { return this->word(x).word(y).word(z); }
+  // Header-mode data frame; the payload order is aux, gyr, acc
+  FifoDump &frame(int16_t acc, int16_t gyr) {
+    return this->header(BMI2_FIFO_HEADER_REG_FRM | BMI2_FIFO_HEADER_GYR_BIT | BMI2_FIFO_HEADER_ACC_BIT)
+        .axes(gyr, gyr + 1, gyr + 2)
+        .axes(acc, acc + 1, acc + 2);
+  }
+  FifoDump &aux_frame(uint8_t aux, int16_t acc, int16_t gyr) {
+    this->header(BMI2_FIFO_HEADER_REG_FRM | BMI2_FIFO_HEADER_AUX_BIT | BMI2_FIFO_HEADER_GYR_BIT |
+                 BMI2_FIFO_HEADER_ACC_BIT);
+    for (uint8_t i = 0; i < BMI2_FIFO_AUX_LENGTH; i++)
+      this->bytes.push_back(aux + i);
+    return this->axes(gyr, gyr + 1, gyr + 2).axes(acc, acc + 1, acc + 2);
+  }
+  FifoDump &sensortime(uint32_t ticks) {
+    return this->header(BMI2_FIFO_HEADER_SENS_TIME_FRM)
+        .raw({(uint8_t) ticks, (uint8_t) (ticks >> 8), (uint8_t) (ticks >> 16)});
+  }
+  // Headerless frame: gyr then acc
+  FifoDump &headerless(int16_t acc, int16_t gyr) {
+    return this->axes(gyr, gyr + 1, gyr + 2).axes(acc, acc + 1, acc + 2);
+  }
+  FifoDump &raw(std::initializer_list<uint8_t> data) {
+    this->bytes.insert(this->bytes.end(), data);
+    return *this;
+  }
+  // What the chip returns when more is read than the FIFO holds: 0x80
+  // bytes in header mode, 0x8000 words headerless
+  FifoDump &over_read(uint16_t len) {
+    this->bytes.insert(this->bytes.end(), len, BMI2_FIFO_HEADER_EMPTY);
+    return *this;
+  }
+  FifoDump &headerless_over_read(uint16_t words) {
+    for (uint16_t i = 0; i < words; i++)
+      this->word((int16_t) BMI2_FIFO_OVER_READ_WORD);
+    return *this;
+  }
+
+  std::vector<uint8_t> bytes;
+};
+
+class FifoParserTest : public ::testing::Test {
+ protected:
+  uint16_t parse(FifoMode mode, const FifoDump &dump, uint16_t max_samples = 16) {
+    this->parser_.set_mode(mode);
+    return this->parser_.parse(dump.bytes.data(), dump.bytes.size(), this->samples_, max_samples);
+  }
+
+  FifoParser parser_;
+  ImuSample samples_[16];
+};
+
+TEST_F(FifoParserTest, SkipConfigAndSensortimeFrames) {
+  FifoDump dump;
+  // Three frames lost to an overflow, then a config change between frames
+  dump.header(BMI2_FIFO_HEADER_SKIP_FRM).raw({3});
+  dump.frame(100, 10).frame(200, 20);
+  dump.header(BMI2_FIFO_HEADER_INPUT_CFG_FRM).raw({0xA8, 0x02, 0xA9, 0x00});
+  dump.frame(300, 30).sensortime(0x123456);
+  ASSERT_EQ(this->parse(FIFO_MODE_HEADER, dump), 3);
+  EXPECT_EQ(this->parser_.get_skipped_frames(), 3);
+  EXPECT_EQ(this->parser_.get_dropped_frames(), 0);
+  ASSERT_TRUE(this->parser_.has_sensortime());
+  EXPECT_EQ(this->parser_.get_sensortime(), 0x123456u);
+  EXPECT_FALSE(this->parser_.has_aux());
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(this->samples_[i].acc[0], 100 * (i + 1));
+    EXPECT_EQ(this->samples_[i].acc[2], 100 * (i + 1) + 2);
+    EXPECT_EQ(this->samples_[i].gyr[0], 10 * (i + 1));
+    EXPECT_EQ(this->samples_[i].gyr[1], 10 * (i + 1) + 1);
+    EXPECT_EQ(this->samples_[i].sensortime, 0u);
+  }
+}
+
+TEST_F(FifoParserTest, InterruptTagsAndSampleDropFrames) {
+  // fh_ext carries interrupt tags in the two low header bits
+  FifoDump dump;
+  dump.frame(100, 10);
+  dump.bytes[0] |= 0x03;
+  dump.header(BMI2_FIFO_HEADER_SAMPLE_DROP_FRM).raw({0x01});
+  dump.header(BMI2_FIFO_HEADER_SENS_TIME_FRM | 0x02).raw({0x00, 0x01, 0x00});
+  ASSERT_EQ(this->parse(FIFO_MODE_HEADER, dump), 1);
+  EXPECT_EQ(this->samples_[0].acc[0], 100);
+  EXPECT_EQ(this->parser_.get_sensortime(), 0x100u);
+}
+
+TEST_F(FifoParserTest, OverReadPaddingEndsTheDump) {
+  FifoDump dump;
+  dump.frame(100, 10).sensortime(0x000200).over_read(24);
+  // Anything after the padding is stale
+  dump.frame(999, 99);
+  ASSERT_EQ(this->parse(FIFO_MODE_HEADER, dump), 1);
+  EXPECT_EQ(this->samples_[0].acc[0], 100);
+  EXPECT_EQ(this->parser_.get_dropped_frames(), 0);
+  EXPECT_EQ(this->parser_.get_sensortime(), 0x200u);
+}
+
+TEST_F(FifoParserTest, TruncatedFinalFrameIsDropped) {
+  FifoDump dump;
+  dump.frame(100, 10).frame(200, 20);
+  dump.bytes.resize(dump.bytes.size() - 5);
+  ASSERT_EQ(this->parse(FIFO_MODE_HEADER, dump), 1);
+  EXPECT_EQ(this->parser_.get_dropped_frames(), 1);
+
+  // A cut sensortime frame leaves the batch without one
+  FifoDump cut;
+  cut.frame(100, 10).sensortime(0x123456);
+  cut.bytes.pop_back();
+  ASSERT_EQ(this->parse(FIFO_MODE_HEADER, cut), 1);
+  EXPECT_FALSE(this->parser_.has_sensortime());
+}
+
+TEST_F(FifoParserTest, UnknownHeaderStopsTheParse) {
+  FifoDump dump;
+  dump.frame(100, 10).header(0x64).frame(200, 20);
+  ASSERT_EQ(this->parse(FIFO_MODE_HEADER, dump), 1);
+  EXPECT_EQ(this->parser_.get_dropped_frames(), 1);
+}
+
+TEST_F(FifoParserTest, SingleSensorFramesHoldTheOther) {
+  FifoDump dump;
+  dump.frame(100, 10);
+  dump.header(BMI2_FIFO_HEADER_REG_FRM | BMI2_FIFO_HEADER_ACC_BIT).axes(500, 501, 502);
+  dump.header(BMI2_FIFO_HEADER_REG_FRM | BMI2_FIFO_HEADER_GYR_BIT).axes(70, 71, 72);
+  ASSERT_EQ(this->parse(FIFO_MODE_HEADER, dump), 3);
+  EXPECT_EQ(this->samples_[1].acc[0], 500);
+  EXPECT_EQ(this->samples_[1].gyr[0], 10);
+  EXPECT_EQ(this->samples_[2].acc[0], 500);
+  EXPECT_EQ(this->samples_[2].gyr[0], 70);
+}
+
+TEST_F(FifoParserTest, AuxFramesKeepTheNewestPayload) {
+  // Aux at a quarter of the accel rate
+  FifoDump dump;
+  dump.aux_frame(0x10, 100, 10).frame(200, 20).frame(300, 30).frame(400, 40);
+  dump.aux_frame(0x20, 500, 50).frame(600, 60);
+  ASSERT_EQ(this->parse(FIFO_MODE_HEADER, dump), 6);
+  ASSERT_TRUE(this->parser_.has_aux());
+  for (uint8_t i = 0; i < BMI2_FIFO_AUX_LENGTH; i++)
+    EXPECT_EQ(this->parser_.get_aux()[i], 0x20 + i);
+  // The aux bytes did not shift the accel/gyro payload
+  EXPECT_EQ(this->samples_[0].gyr[0], 10);
+  EXPECT_EQ(this->samples_[0].acc[0], 100);
+  EXPECT_EQ(this->samples_[4].gyr[2], 52);
+  EXPECT_EQ(this->samples_[4].acc[2], 502);
+
+  // The next parse starts without aux
+  FifoDump plain;
+  plain.frame(100, 10);
+  this->parse(FIFO_MODE_HEADER, plain);
+  EXPECT_FALSE(this->parser_.has_aux());
+}
+
+TEST_F(FifoParserTest, MaxSamplesDropsTheRest) {
+  FifoDump dump;
+  for (int i = 1; i <= 5; i++)
+    dump.frame(100 * i, 10 * i);
+  dump.sensortime(0x000500);
+  ASSERT_EQ(this->parse(FIFO_MODE_HEADER, dump, 3), 3);
+  EXPECT_EQ(this->parser_.get_dropped_frames(), 2);
+  EXPECT_EQ(this->samples_[2].acc[0], 300);
+  // The frames after the limit are still walked to the sensortime
+  EXPECT_TRUE(this->parser_.has_sensortime());
+}
+
+TEST_F(FifoParserTest, HeaderlessDummyFramesAreSkipped) {
+  FifoDump dump;
+  dump.headerless(100, 10);
+  // A sensor that is not running yet reports a dummy word in its place
+  dump.word(BMI2_FIFO_GYR_DUMMY_WORD).word(0).word(0).axes(200, 201, 202);
+  dump.axes(20, 21, 22).word(BMI2_FIFO_ACC_DUMMY_WORD).word(0).word(0);
+  dump.headerless(300, 30);
+  ASSERT_EQ(this->parse(FIFO_MODE_HEADERLESS, dump), 2);
+  EXPECT_EQ(this->parser_.get_skipped_frames(), 2);
+  EXPECT_EQ(this->samples_[0].acc[0], 100);
+  EXPECT_EQ(this->samples_[0].gyr[2], 12);
+  EXPECT_EQ(this->samples_[1].acc[1], 301);
+  EXPECT_EQ(this->samples_[1].gyr[0], 30);
+  EXPECT_FALSE(this->parser_.has_sensortime());
+}
+
+TEST_F(FifoParserTest, HeaderlessOverReadAndTruncation) {
+  FifoDump dump;
+  dump.headerless(100, 10).headerless(200, 20).headerless_over_read(6).headerless(999, 99);
+  ASSERT_EQ(this->parse(FIFO_MODE_HEADERLESS, dump), 2);
+
+  FifoDump cut;
+  cut.headerless(100, 10).headerless(200, 20);
+  cut.bytes.resize(cut.bytes.size() - 1);
+  ASSERT_EQ(this->parse(FIFO_MODE_HEADERLESS, cut), 1);
+
+  FifoDump full;
+  for (int i = 1; i <= 4; i++)
+    full.headerless(100 * i, 10 * i);
+  ASSERT_EQ(this->parse(FIFO_MODE_HEADERLESS, full, 3), 3);
+  EXPECT_EQ(this->parser_.get_dropped_frames(), 1);
+}
+
+TEST(FifoSensortimeTest, SpreadsBackAcrossTheWrap) {
+  ImuSample samples[3]{};
+  FifoParser::assign_sensortime(samples, 3, 0x000100, 256);
+  EXPECT_EQ(samples[0].sensortime, 0xFFFF00u);
+  EXPECT_EQ(samples[1].sensortime, 0x000000u);
+  EXPECT_EQ(samples[2].sensortime, 0x000100u);
+}
+
+class FifoTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    testing::set_now_us(0);
+    testing::clear_preferences();
+    this->bus_.add_device(0x68, &this->sim_);
+    this->imu_.set_i2c_bus(&this->bus_);
+    this->imu_.set_i2c_address(0x68);
+    this->imu_.set_fifo_mode(FIFO_MODE_HEADER);
+    this->imu_.set_fifo_watermark(16);
+    this->loop_.add(&this->imu_);
+    this->loop_.add_sim(&this->sim_);
+  }
+
+  void start() {
+    this->loop_.setup();
+    ASSERT_TRUE(this->loop_.run_until([this]() { return this->imu_.is_ready(); }));
+  }
+
+  uint16_t watermark() const {
+    return this->sim_.get_reg(BMI2_FIFO_WTM_0_ADDR) | (this->sim_.get_reg(BMI2_FIFO_WTM_0_ADDR + 1) & 0x1F) << 8;
+  }
+
+  BMI270Simulator sim_;
+  SimI2CBus bus_;
+  SimPin int1_{&sim_, 0, 4};
+  TestBMI270 imu_;
+  HostLoop loop_;
+};
+
+TEST_F(FifoTest, WatermarkCountsHeaderBytes) {
+  this->start();
+  EXPECT_EQ(this->watermark(), 16 * (1 + BMI2_FIFO_ACC_LENGTH + BMI2_FIFO_GYR_LENGTH));
+}
+
+TEST_F(FifoTest, HeaderlessWatermarkHasNoHeaders) {
+  this->imu_.set_fifo_mode(FIFO_MODE_HEADERLESS);
+  this->start();
+  EXPECT_EQ(this->watermark(), 16 * (BMI2_FIFO_ACC_LENGTH + BMI2_FIFO_GYR_LENGTH));
+}
+
+TEST_F(FifoTest, MagnetometerFramesAddAuxBytesAtAuxRate) {
+  // Aux at 25 Hz next to accel at 100 Hz: every fourth frame has 8 more bytes
+  this->imu_.set_magnetometer(0x10, BMI2_AUX_ODR_25HZ);
+  this->imu_.set_int1_pin(&this->int1_);
+  this->loop_.add_pin(&this->int1_);
+  this->start();
+  EXPECT_EQ(this->watermark(), 16 * (1 + BMI2_FIFO_ACC_LENGTH + BMI2_FIFO_GYR_LENGTH) + 4 * BMI2_FIFO_AUX_LENGTH);
+
+  // Each interrupt then drains the configured number of samples
+  this->loop_.run_for(2000);
+  EXPECT_GE(this->int1_.get_edges(), 11u);
+  EXPECT_LE(this->int1_.get_edges(), 13u);
+  EXPECT_GE(this->imu_.fifo_sample_count_, 16);
+  EXPECT_LE(this->imu_.fifo_sample_count_, 17);
+}
+
+TEST_F(FifoTest, WatermarkStaysBelowFifoSize) {
+  this->imu_.set_fifo_watermark(150);
+  this->imu_.set_magnetometer(0x10, BMI2_ACC_ODR_100HZ);  // aux ODR codes match the accel ones
+  this->start();
+  EXPECT_EQ(this->watermark(),
+            BMI2_FIFO_SIZE - (1 + BMI2_FIFO_AUX_LENGTH + BMI2_FIFO_GYR_LENGTH + BMI2_FIFO_ACC_LENGTH));
+}
+
+}  // namespace bmi270
+}  // namespace esphome
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include "bmi270_harness.h"
+
+// INT1/INT2 routing and the handoff from the GPIO interrupt to loop()
+
+namespace esphome {
+namespace bmi270 {
+
+class InterruptTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    testing::set_now_us(0);
+    testing::clear_preferences();
+    this->bus_.add_device(0x68, &this->sim_);
+    this->imu_.set_i2c_bus(&this->bus_);
+    this->imu_.set_i2c_address(0x68);
+    this->imu_.set_accel_x_sensor(&this->accel_x_);
+    this->imu_.set_int1_pin(&this->int1_);
+    this->loop_.add(&this->imu_);
+    this->loop_.add_sim(&this->sim_);
+    this->loop_.add_pin(&this->int1_);
+  }
+
+  void start() {
+    this->loop_.setup();
+    ASSERT_TRUE(this->loop_.run_until([this]() { return this->imu_.is_ready(); }));
+  }
+
+  BMI270Simulator sim_;
+  SimI2CBus bus_;
+  SimPin int1_{&sim_, 0, 4};
+  sensor::Sensor accel_x_;
+  TestBMI270 imu_;
+  HostLoop loop_;
+};
+
+TEST_F(InterruptTest, PolledModeRoutesDataReady) {
+  this->start();
+  EXPECT_EQ(this->sim_.get_reg(BMI2_INT_MAP_DATA_ADDR), BMI2_DRDY_INT);
+  EXPECT_TRUE(this->sim_.get_reg(BMI2_INT1_IO_CTRL_ADDR) & BMI2_INT_IO_OUTPUT_EN);
+  EXPECT_EQ(this->int1_.get_setups(), 1u);
+  EXPECT_TRUE(this->int1_.is_attached());
+  EXPECT_EQ(this->imu_.data_int_pin_, &this->int1_);
+}
+
+TEST_F(InterruptTest, UpdateWithoutDataReadyStaysOffTheBus) {
+  this->start();
+  this->loop_.run_for(1500);
+  ASSERT_GT(this->accel_x_.publishes, 0u);
+
+  // One edge, one read; a second poll before the next edge finds nothing
+  testing::advance_us(20000);
+  this->sim_.advance();
+  this->int1_.poll();
+  uint32_t transactions = this->sim_.get_transactions();
+  this->imu_.update();
+  EXPECT_GT(this->sim_.get_transactions(), transactions);
+  transactions = this->sim_.get_transactions();
+  this->imu_.update();
+  EXPECT_EQ(this->sim_.get_transactions(), transactions);
+}
+
+TEST_F(InterruptTest, WatermarkEdgeDrainsFifoFromLoop) {
+  this->imu_.set_fifo_mode(FIFO_MODE_HEADER);
+  this->imu_.set_fifo_watermark(10);
+  // update() only publishes; the reads must come from the interrupt
+  this->imu_.set_update_interval(60000);
+  this->start();
+  EXPECT_EQ(this->sim_.get_reg(BMI2_INT_MAP_DATA_ADDR), BMI2_FWM_INT | BMI2_FFULL_INT);
+
+  const uint32_t samples = this->sim_.get_samples();
+  const uint32_t edges = this->int1_.get_edges();
+  this->sim_.clear_log();
+  this->loop_.run_for(1000);
+  // 100 Hz with a 10-sample watermark: ten edges, each one drain
+  const uint32_t drains = this->int1_.get_edges() - edges;
+  EXPECT_GE(drains, 9u);
+  EXPECT_LE(drains, 11u);
+  uint32_t length_reads = 0;
+  for (const auto &t : this->sim_.get_log()) {
+    if (!t.write && t.reg == BMI2_FIFO_LENGTH_0_ADDR)
+      length_reads++;
+  }
+  EXPECT_EQ(length_reads, drains);
+  // Everything but the partial batch was read out
+  EXPECT_LT(this->sim_.get_fifo_length(), 10u * 13);
+  EXPECT_GE(this->sim_.get_samples() - samples, 100u);
+
+  // Between edges loop() does not touch the bus
+  this->loop_.run_until([this]() { return this->sim_.get_fifo_length() == 0; });
+  uint32_t transactions = this->sim_.get_transactions();
+  this->loop_.run_for(50);
+  EXPECT_EQ(this->sim_.get_transactions(), transactions);
+}
+
+TEST_F(InterruptTest, SharedLineServicesFeatureEvents) {
+  binary_sensor::BinarySensor moving;
+  this->imu_.set_fifo_mode(FIFO_MODE_HEADER);
+  this->imu_.set_any_motion_config(164, 5);
+  this->imu_.set_no_motion_config(164, 50);
+  this->imu_.set_any_motion_binary_sensor(&moving);
+  this->start();
+  // Data and features on INT1; a motion event raises the same line
+  EXPECT_EQ(this->imu_.feature_int_pin_, &this->int1_);
+  EXPECT_TRUE(this->sim_.get_reg(BMI2_INT1_MAP_FEAT_ADDR) & BMI2_ANY_MOT_INT);
+  this->loop_.run_until([this]() { return this->sim_.get_fifo_length() == 0; });
+  this->loop_.run_for(5);
+
+  this->sim_.raise_feature_event(BMI2_ANY_MOT_INT);
+  this->loop_.run_for(2);
+  EXPECT_TRUE(moving.state);
+  EXPECT_EQ(this->sim_.get_reg(BMI2_INT_STATUS_0_ADDR), 0);
+}
+
+}  // namespace bmi270
+}  // namespace esphome
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <math.h>
+
+#include "bmi270_harness.h"
+
+// OrientationDetector: the hysteresis bands around the diagonals and the
+// flat cone, the hold time, and the rotation handed to the display
+
+namespace esphome {
+namespace bmi270 {
+
+static const float DEG_TO_RAD_F = 0.01745329252f;
+
+class OrientationTest : public ::testing::Test {
+ protected:
+  // 20° flat cone, 10° hysteresis, 500 ms hold, as in m5stack-papers3.yaml
+  void SetUp() override { this->detector_.configure(20.0f, 10.0f, 500); }
+
+  // Accel reading of a device turned clockwise from portrait by turn_deg
+  // and tilted back from vertical by tilt_deg (90 is lying face up)
+  void gravity(float turn_deg, float tilt_deg, float *g) const {
+    float turn = turn_deg * DEG_TO_RAD_F, tilt = tilt_deg * DEG_TO_RAD_F;
+    g[0] = -sinf(turn) * cosf(tilt);
+    g[1] = cosf(turn) * cosf(tilt);
+    g[2] = sinf(tilt);
+  }
+
+  // Holds a pose for duration_ms, fed every 100 ms
+  Orientation hold(float turn_deg, float tilt_deg, uint32_t duration_ms) {
+    float g[3];
+    this->gravity(turn_deg, tilt_deg, g);
+    for (uint32_t end = this->now_ms_ + duration_ms; this->now_ms_ <= end; this->now_ms_ += 100)
+      this->detector_.update(g[0], g[1], g[2], this->now_ms_);
+    return this->detector_.get_orientation();
+  }
+
+  OrientationDetector detector_;
+  uint32_t now_ms_{0};
+};
+
+TEST_F(OrientationTest, FirstReadingIsReportedAtOnce) {
+  EXPECT_EQ(this->detector_.get_orientation(), ORIENTATION_UNKNOWN);
+  EXPECT_TRUE(this->detector_.update(0.0f, 1.0f, 0.0f, 0));
+  EXPECT_EQ(this->detector_.get_orientation(), ORIENTATION_PORTRAIT);
+}
+
+TEST_F(OrientationTest, DiagonalNeedsHalfTheHysteresis) {
+  ASSERT_EQ(this->hold(0.0f, 0.0f, 0), ORIENTATION_PORTRAIT);
+  // Past 45° but inside 45° + 5°: stays portrait however long it is held
+  EXPECT_EQ(this->hold(48.0f, 0.0f, 2000), ORIENTATION_PORTRAIT);
+  EXPECT_EQ(this->hold(51.0f, 0.0f, 1000), ORIENTATION_LANDSCAPE);
+  // And the same band on the way back
+  EXPECT_EQ(this->hold(42.0f, 0.0f, 2000), ORIENTATION_LANDSCAPE);
+  EXPECT_EQ(this->hold(39.0f, 0.0f, 1000), ORIENTATION_PORTRAIT);
+  // Towards the other neighbour
+  EXPECT_EQ(this->hold(-48.0f, 0.0f, 2000), ORIENTATION_PORTRAIT);
+  EXPECT_EQ(this->hold(-51.0f, 0.0f, 1000), ORIENTATION_LANDSCAPE_INVERTED);
+  EXPECT_EQ(this->hold(-132.0f, 0.0f, 2000), ORIENTATION_LANDSCAPE_INVERTED);
+  EXPECT_EQ(this->hold(-141.0f, 0.0f, 1000), ORIENTATION_PORTRAIT_INVERTED);
+}
+
+TEST_F(OrientationTest, FaceUpExitsPastFlatAngleAndHysteresis) {
+  ASSERT_EQ(this->hold(0.0f, 90.0f, 0), ORIENTATION_FACE_UP);
+  // Lifted 25° from horizontal: inside the 20° + 10° exit cone
+  EXPECT_EQ(this->hold(0.0f, 65.0f, 2000), ORIENTATION_FACE_UP);
+  EXPECT_EQ(this->hold(0.0f, 59.0f, 1000), ORIENTATION_PORTRAIT);
+  // Entering takes the plain flat angle
+  EXPECT_EQ(this->hold(0.0f, 65.0f, 2000), ORIENTATION_PORTRAIT);
+  EXPECT_EQ(this->hold(0.0f, 71.0f, 1000), ORIENTATION_FACE_UP);
+  EXPECT_EQ(this->hold(0.0f, -71.0f, 1000), ORIENTATION_FACE_DOWN);
+  EXPECT_EQ(this->hold(0.0f, -65.0f, 2000), ORIENTATION_FACE_DOWN);
+}
+
+TEST_F(OrientationTest, ShortCandidateIsNotReported) {
+  ASSERT_EQ(this->hold(0.0f, 0.0f, 0), ORIENTATION_PORTRAIT);
+  float g[3];
+  this->gravity(90.0f, 0.0f, g);
+  EXPECT_FALSE(this->detector_.update(g[0], g[1], g[2], 1000));
+  EXPECT_FALSE(this->detector_.update(g[0], g[1], g[2], 1499));
+  EXPECT_EQ(this->detector_.get_orientation(), ORIENTATION_PORTRAIT);
+  // Back to portrait in between: the hold starts over
+  EXPECT_FALSE(this->detector_.update(0.0f, 1.0f, 0.0f, 1500));
+  EXPECT_FALSE(this->detector_.update(g[0], g[1], g[2], 1600));
+  EXPECT_FALSE(this->detector_.update(g[0], g[1], g[2], 2099));
+  EXPECT_TRUE(this->detector_.update(g[0], g[1], g[2], 2100));
+  EXPECT_EQ(this->detector_.get_orientation(), ORIENTATION_LANDSCAPE);
+  EXPECT_FALSE(this->detector_.update(g[0], g[1], g[2], 2200));
+}
+
+TEST_F(OrientationTest, SettleSkipsTheHold) {
+  ASSERT_EQ(this->hold(0.0f, 0.0f, 0), ORIENTATION_PORTRAIT);
+  float g[3];
+  this->gravity(180.0f, 0.0f, g);
+  EXPECT_TRUE(this->detector_.settle(g[0], g[1], g[2]));
+  EXPECT_EQ(this->detector_.get_orientation(), ORIENTATION_PORTRAIT_INVERTED);
+  EXPECT_FALSE(this->detector_.settle(g[0], g[1], g[2]));
+}
+
+TEST_F(OrientationTest, RotationMatchesTheTurn) {
+  // The display lambda turns the panel by orientation_rotation() and keeps
+  // the last rotation while it is negative
+  const struct {
+    float turn_deg;
+    Orientation orientation;
+    int16_t rotation;
+  } poses[] = {{0.0f, ORIENTATION_PORTRAIT, 0},
+               {90.0f, ORIENTATION_LANDSCAPE, 90},
+               {180.0f, ORIENTATION_PORTRAIT_INVERTED, 180},
+               {270.0f, ORIENTATION_LANDSCAPE_INVERTED, 270}};
+  for (const auto &pose : poses) {
+    OrientationDetector detector;
+    float g[3];
+    this->gravity(pose.turn_deg, 0.0f, g);
+    detector.update(g[0], g[1], g[2], 0);
+    EXPECT_EQ(detector.get_orientation(), pose.orientation) << pose.turn_deg;
+    EXPECT_EQ(orientation_rotation(detector.get_orientation()), pose.rotation) << pose.turn_deg;
+  }
+  EXPECT_EQ(orientation_rotation(ORIENTATION_FACE_UP), -1);
+  EXPECT_EQ(orientation_rotation(ORIENTATION_FACE_DOWN), -1);
+  EXPECT_EQ(orientation_rotation(ORIENTATION_UNKNOWN), -1);
+}
+
+}  // namespace bmi270
+}  // namespace esphome
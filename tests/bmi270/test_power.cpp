@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+#include "bmi270_harness.h"
+
+// PWR_CONF / PWR_CTRL sequences of the power save profiles
+
+namespace esphome {
+namespace bmi270 {
+
+static const uint8_t ACC_TEMP = BMI2_PWR_CTRL_ACC_EN | BMI2_PWR_CTRL_TEMP_EN;
+static const uint8_t ALL_ON = ACC_TEMP | BMI2_PWR_CTRL_GYR_EN;
+
+class PowerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    testing::set_now_us(0);
+    testing::clear_preferences();
+    this->bus_.add_device(0x68, &this->sim_);
+    this->imu_.set_i2c_bus(&this->bus_);
+    this->imu_.set_i2c_address(0x68);
+    this->imu_.set_update_interval(1000);
+    this->imu_.set_accel_odr(BMI2_ACC_ODR_100HZ);
+    this->imu_.set_gyro_odr(BMI2_GYR_ODR_100HZ);
+    this->imu_.set_accel_x_sensor(&this->accel_x_);
+    this->loop_.add(&this->imu_);
+    this->loop_.add_sim(&this->sim_);
+  }
+
+  void start(PowerSaveMode mode) {
+    this->imu_.set_power_save_mode(mode);
+    this->loop_.setup();
+    ASSERT_TRUE(this->loop_.run_until([this]() { return this->imu_.is_ready(); }));
+    this->sim_.clear_log();
+  }
+
+  uint8_t pwr_ctrl() const { return this->sim_.get_reg(BMI2_PWR_CTRL_ADDR); }
+
+  // Time from the next poll powering the gyro up until it is dropped again
+  uint32_t gyro_wake_ms() {
+    EXPECT_TRUE(this->loop_.run_until([this]() { return (this->pwr_ctrl() & BMI2_PWR_CTRL_GYR_EN) != 0; }, 2000));
+    uint64_t start = testing::now_us();
+    EXPECT_TRUE(this->loop_.run_until([this]() { return (this->pwr_ctrl() & BMI2_PWR_CTRL_GYR_EN) == 0; }, 2000));
+    return (uint32_t) ((testing::now_us() - start) / 1000);
+  }
+
+  BMI270Simulator sim_;
+  SimI2CBus bus_;
+  sensor::Sensor accel_x_, gyro_x_, temperature_;
+  TestBMI270 imu_;
+  HostLoop loop_;
+};
+
+TEST_F(PowerTest, NormalKeepsEverythingOn) {
+  this->imu_.set_gyro_x_sensor(&this->gyro_x_);
+  this->start(POWER_SAVE_MODE_NORMAL);
+  EXPECT_EQ(this->sim_.get_reg(BMI2_PWR_CONF_ADDR), 0x00);
+  EXPECT_EQ(this->pwr_ctrl(), ALL_ON);
+  // Performance filter unless asked otherwise, no averaging
+  EXPECT_TRUE(this->sim_.get_reg(BMI2_ACC_CONF_ADDR) & 0x80);
+
+  this->loop_.run_for(5000);
+  EXPECT_TRUE(this->sim_.writes_to(BMI2_PWR_CTRL_ADDR).empty());
+  EXPECT_TRUE(this->sim_.writes_to(BMI2_PWR_CONF_ADDR).empty());
+  EXPECT_GE(this->gyro_x_.publishes, 4u);
+}
+
+TEST_F(PowerTest, LowPowerAccelOnlyNeverWakesGyro) {
+  // The PaperS3 profile: accel and temperature outputs, no gyro
+  this->imu_.set_temperature_sensor(&this->temperature_);
+  this->start(POWER_SAVE_MODE_LOW_POWER);
+  EXPECT_EQ(this->sim_.get_reg(BMI2_PWR_CONF_ADDR), BMI2_PWR_CONF_ADV_POWER_SAVE);
+  EXPECT_EQ(this->pwr_ctrl(), ACC_TEMP);
+  // Low-power accel: filter_perf clear, bwp selects the averaging
+  EXPECT_FALSE(this->sim_.get_reg(BMI2_ACC_CONF_ADDR) & 0x80);
+
+  this->loop_.run_for(10000);
+  // Everything a poll needs is already on: no power writes at all
+  EXPECT_TRUE(this->sim_.writes_to(BMI2_PWR_CTRL_ADDR).empty());
+  EXPECT_EQ(this->pwr_ctrl(), ACC_TEMP);
+  EXPECT_GE(this->accel_x_.publishes, 9u);
+  EXPECT_GE(this->temperature_.publishes, 1u);
+}
+
+TEST_F(PowerTest, LowPowerGyroPollWakesAndSuspends) {
+  this->imu_.set_gyro_x_sensor(&this->gyro_x_);
+  this->start(POWER_SAVE_MODE_LOW_POWER);
+  EXPECT_EQ(this->pwr_ctrl(), ACC_TEMP);
+
+  // 45 ms gyro start-up plus one 10 ms output period
+  EXPECT_EQ(this->gyro_wake_ms(), 55u);
+  EXPECT_EQ(this->gyro_x_.publishes, 1u);
+  EXPECT_EQ(this->gyro_wake_ms(), 55u);
+  EXPECT_EQ(this->gyro_x_.publishes, 2u);
+  // Two polls, each one wake and one return to the idle profile
+  const std::vector<uint8_t> expected{ALL_ON, ACC_TEMP, ALL_ON, ACC_TEMP};
+  EXPECT_EQ(this->sim_.writes_to(BMI2_PWR_CTRL_ADDR), expected);
+  EXPECT_TRUE(this->sim_.writes_to(BMI2_PWR_CONF_ADDR).empty());
+}
+
+TEST_F(PowerTest, GyroFastStartWakesInTwoMilliseconds) {
+  this->imu_.set_gyro_x_sensor(&this->gyro_x_);
+  this->start(POWER_SAVE_MODE_GYRO_FAST_START);
+  EXPECT_EQ(this->sim_.get_reg(BMI2_PWR_CONF_ADDR), BMI2_PWR_CONF_ADV_POWER_SAVE | BMI2_PWR_CONF_FUP_EN);
+  EXPECT_EQ(this->pwr_ctrl(), ACC_TEMP);
+
+  // 2 ms from fast start-up plus one 10 ms output period
+  EXPECT_EQ(this->gyro_wake_ms(), 12u);
+  EXPECT_EQ(this->gyro_x_.publishes, 1u);
+  EXPECT_EQ(this->pwr_ctrl(), ACC_TEMP);
+}
+
+TEST_F(PowerTest, SuspendPowersAccelOnlyForTheRead) {
+  this->start(POWER_SAVE_MODE_SUSPEND);
+  EXPECT_EQ(this->sim_.get_reg(BMI2_PWR_CONF_ADDR), BMI2_PWR_CONF_ADV_POWER_SAVE);
+  EXPECT_EQ(this->pwr_ctrl(), 0x00);
+
+  ASSERT_TRUE(this->loop_.run_until([this]() { return this->pwr_ctrl() != 0x00; }, 2000));
+  EXPECT_EQ(this->pwr_ctrl(), ACC_TEMP);
+  uint64_t start = testing::now_us();
+  ASSERT_TRUE(this->loop_.run_until([this]() { return this->pwr_ctrl() == 0x00; }, 2000));
+  // 2 ms accel start-up plus one output period
+  EXPECT_EQ((testing::now_us() - start) / 1000, 12u);
+  EXPECT_EQ(this->accel_x_.publishes, 1u);
+}
+
+TEST_F(PowerTest, SuspendKeepsAccelForTheFeatureEngine) {
+  binary_sensor::BinarySensor any_motion;
+  this->imu_.set_any_motion_config(164, 5);
+  this->imu_.set_no_motion_config(164, 50);
+  this->imu_.set_any_motion_binary_sensor(&any_motion);
+  this->start(POWER_SAVE_MODE_SUSPEND);
+  EXPECT_EQ(this->pwr_ctrl(), BMI2_PWR_CTRL_ACC_EN);
+
+  this->loop_.run_for(3000);
+  for (uint8_t value : this->sim_.writes_to(BMI2_PWR_CTRL_ADDR))
+    EXPECT_TRUE(value & BMI2_PWR_CTRL_ACC_EN);
+  EXPECT_EQ(this->pwr_ctrl(), BMI2_PWR_CTRL_ACC_EN);
+}
+
+}  // namespace bmi270
+}  // namespace esphome
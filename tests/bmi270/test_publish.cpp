@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include "bmi270_harness.h"
+
+// Publish gate and the publish counters
+
+namespace esphome {
+namespace bmi270 {
+
+class PublishTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    testing::set_now_us(0);
+    testing::clear_preferences();
+    this->bus_.add_device(0x68, &this->sim_);
+    this->imu_.set_i2c_bus(&this->bus_);
+    this->imu_.set_i2c_address(0x68);
+    this->imu_.set_update_interval(100);
+    this->imu_.set_accel_x_sensor(&this->accel_x_);
+    this->imu_.set_publishes_emitted_sensor(&this->emitted_);
+    this->imu_.set_publishes_suppressed_sensor(&this->suppressed_);
+    this->loop_.add(&this->imu_);
+    this->loop_.add_sim(&this->sim_);
+  }
+
+  void start() {
+    this->loop_.setup();
+    ASSERT_TRUE(this->loop_.run_until([this]() { return this->imu_.is_ready(); }));
+  }
+
+  BMI270Simulator sim_;
+  SimI2CBus bus_;
+  sensor::Sensor accel_x_, emitted_, suppressed_;
+  TestBMI270 imu_;
+  HostLoop loop_;
+};
+
+TEST_F(PublishTest, DeadbandSuppressesUnchangedValues) {
+  this->imu_.set_publish_limits(PUBLISH_CHANNEL_ACCEL_X, 0.5f, 0, 5000);
+  this->start();
+  this->loop_.run_for(2000);
+  // A flat device: the first value, then nothing until the maximum interval
+  EXPECT_EQ(this->accel_x_.publishes, 1u);
+  EXPECT_GE(this->imu_.publishes_suppressed_, 15u);
+  this->loop_.run_for(4000);
+  EXPECT_EQ(this->accel_x_.publishes, 2u);
+}
+
+TEST_F(PublishTest, CountersPublishOnTheirOwnInterval) {
+  this->imu_.set_publish_limits(PUBLISH_CHANNEL_ACCEL_X, 0.5f, 0, 0);
+  this->start();
+  // Ten polls a second all move the counters, which still publish once
+  this->loop_.run_for(30000);
+  EXPECT_GE(this->imu_.publishes_suppressed_, 250u);
+  EXPECT_EQ(this->emitted_.publishes, 1u);
+  EXPECT_EQ(this->suppressed_.publishes, 1u);
+
+  this->loop_.run_for(31000);
+  EXPECT_EQ(this->suppressed_.publishes, 2u);
+  // The reported value lags behind by at most one interval of polls
+  EXPECT_LE(this->suppressed_.state, (float) this->imu_.publishes_suppressed_);
+  EXPECT_GE(this->suppressed_.state, (float) this->imu_.publishes_suppressed_ - 600);
+}
+
+}  // namespace bmi270
+}  // namespace esphome
@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include <string.h>
+
+#include "bmi270_harness.h"
+#include "esphome/components/bmi270/bmi270_config.h"
+
+// Re-initialization after bus faults and chip resets
+
+namespace esphome {
+namespace bmi270 {
+
+class RecoveryTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    testing::set_now_us(0);
+    testing::clear_preferences();
+    this->bus_.add_device(0x68, &this->sim_);
+    this->imu_.set_i2c_bus(&this->bus_);
+    this->imu_.set_i2c_address(0x68);
+    this->imu_.set_accel_x_sensor(&this->accel_x_);
+    this->loop_.add(&this->imu_);
+    this->loop_.add_sim(&this->sim_);
+  }
+
+  void use_fifo_interrupt() {
+    this->imu_.set_fifo_mode(FIFO_MODE_HEADER);
+    this->imu_.set_fifo_watermark(8);
+    this->imu_.set_int1_pin(&this->int1_);
+    this->loop_.add_pin(&this->int1_);
+  }
+
+  void start() {
+    this->loop_.setup();
+    ASSERT_TRUE(this->loop_.run_until([this]() { return this->imu_.is_ready(); }));
+  }
+
+  // Fails every transaction from the given setup state on until the
+  // component has started a recovery
+  void fail_first_bring_up_at(SetupState state) {
+    this->loop_.setup();
+    ASSERT_TRUE(this->loop_.run_until([&]() { return this->imu_.setup_state_ == state; }));
+    this->sim_.set_responding(false);
+    ASSERT_TRUE(this->loop_.run_until([this]() { return this->imu_.recoveries_ != 0; }));
+    this->sim_.set_responding(true);
+    ASSERT_TRUE(this->loop_.run_until([this]() { return this->imu_.is_ready(); }, 60000));
+  }
+
+  BMI270Simulator sim_;
+  SimI2CBus bus_;
+  SimPin int1_{&sim_, 0, 4};
+  sensor::Sensor accel_x_;
+  TestBMI270 imu_;
+  HostLoop loop_;
+};
+
+TEST_F(RecoveryTest, FailedWatermarkReadDoesNotTouchDetachedPin) {
+  this->use_fifo_interrupt();
+  this->start();
+  this->loop_.run_for(200);
+  ASSERT_GT(this->int1_.get_edges(), 0u);
+
+  // The watermark line stays high while every read fails, so loop() keeps
+  // retrying until the fifth failure starts a recovery from inside loop()
+  this->sim_.set_responding(false);
+  this->loop_.run_for(500);
+  EXPECT_GE(this->imu_.recoveries_, 1u);
+  EXPECT_EQ(this->imu_.data_int_pin_, nullptr);
+  EXPECT_FALSE(this->int1_.is_attached());
+
+  this->sim_.set_responding(true);
+  ASSERT_TRUE(this->loop_.run_until([this]() { return this->imu_.is_ready(); }, 60000));
+  EXPECT_TRUE(this->int1_.is_attached());
+  uint32_t publishes = this->accel_x_.publishes;
+  this->loop_.run_for(2000);
+  EXPECT_GT(this->accel_x_.publishes, publishes);
+}
+
+TEST_F(RecoveryTest, FailureDuringFirstBringUpStillCalibrates) {
+  // INIT_OK survives the failure, so the recovery goes straight back to
+  // CONFIGURE; offsets must still come from FOC, not from empty RAM
+  this->sim_.set_signal([](uint32_t, int16_t *acc, int16_t *gyr) {
+    acc[2] = 16384;
+    gyr[0] = 40;
+    gyr[1] = -25;
+    gyr[2] = 10;
+  });
+  this->fail_first_bring_up_at(SETUP_STATE_CONFIGURE);
+  EXPECT_EQ(this->imu_.recoveries_, 1u);
+  EXPECT_TRUE(this->imu_.calibration_.gyr_valid);
+  EXPECT_EQ(this->imu_.calibration_.offsets.gyr[0], -40);
+  EXPECT_EQ(this->imu_.calibration_.offsets.gyr[1], 25);
+  EXPECT_EQ(this->imu_.calibration_.offsets.gyr[2], -10);
+  EXPECT_TRUE(this->sim_.get_reg(BMI2_GYR_OFF_COMP_6_ADDR) & BMI2_GYR_OFF_EN);
+}
+
+TEST_F(RecoveryTest, FailureDuringFirstBringUpLoadsStoredOffsets) {
+  BMI270Calibration stored{};
+  {
+    // An earlier boot ran FOC and stored its offsets
+    this->sim_.set_signal([](uint32_t, int16_t *acc, int16_t *gyr) {
+      acc[2] = 16384;
+      gyr[0] = -12;
+    });
+    TestBMI270 earlier;
+    earlier.set_i2c_bus(&this->bus_);
+    earlier.set_i2c_address(0x68);
+    HostLoop loop;
+    loop.add(&earlier);
+    loop.add_sim(&this->sim_);
+    loop.setup();
+    ASSERT_TRUE(loop.run_until([&]() { return earlier.is_ready(); }));
+    stored = earlier.calibration_;
+    ASSERT_EQ(stored.offsets.gyr[0], 12);
+  }
+  // This boot sees a different bias, which it must not calibrate against
+  this->sim_.power_on_reset();
+  this->sim_.set_signal([](uint32_t, int16_t *acc, int16_t *gyr) {
+    acc[2] = 16384;
+    gyr[0] = 30;
+  });
+  this->fail_first_bring_up_at(SETUP_STATE_CONFIGURE);
+  EXPECT_TRUE(this->imu_.calibration_.gyr_valid);
+  EXPECT_EQ(this->imu_.calibration_.offsets.gyr[0], stored.offsets.gyr[0]);
+  EXPECT_EQ(this->sim_.get_reg(BMI2_GYR_OFF_COMP_3_ADDR), (uint8_t) stored.offsets.gyr[0]);
+}
+
+TEST_F(RecoveryTest, RecoveryAfterReadyKeepsOffsetsInRam) {
+  this->start();
+  BMI270Calibration calibration = this->imu_.calibration_;
+  uint32_t uploads = this->sim_.writes_to(BMI2_INIT_CTRL_ADDR).size();
+
+  // A short bus fault: INIT_OK survives, so there is no upload and no FOC
+  this->sim_.set_responding(false);
+  ASSERT_TRUE(this->loop_.run_until([this]() { return this->imu_.recoveries_ != 0; }, 30000));
+  this->sim_.set_responding(true);
+  ASSERT_TRUE(this->loop_.run_until([this]() { return this->imu_.is_ready(); }, 60000));
+  EXPECT_EQ(this->sim_.writes_to(BMI2_INIT_CTRL_ADDR).size(), uploads);
+  EXPECT_EQ(memcmp(&this->imu_.calibration_, &calibration, sizeof(calibration)), 0);
+}
+
+TEST_F(RecoveryTest, OversizedConfigBurstFallsBackToHalfChunks) {
+  // A driver that takes at most 100 bytes per write: 256 and 128 byte
+  // bursts fail, 64 byte ones go through
+  this->imu_.set_config_burst_size(256);
+  this->bus_.set_max_write_len(100);
+  this->start();
+  EXPECT_TRUE(this->sim_.config_loaded());
+  EXPECT_EQ(this->imu_.recoveries_, 0u);
+  EXPECT_EQ(this->imu_.upload_retries_, 2);
+  EXPECT_EQ(this->imu_.upload_chunk_size_, 64);
+  // Every chunk the chip saw was 64 bytes, none was lost or repeated
+  const uint32_t chunks = sizeof(bmi270_config_file) / 64;
+  uint32_t data_writes = 0;
+  for (const auto &txn : this->sim_.get_log()) {
+    if (txn.write && txn.reg == BMI2_INIT_DATA_ADDR) {
+      EXPECT_EQ(txn.len, 64u);
+      data_writes++;
+    }
+  }
+  EXPECT_EQ(data_writes, chunks);
+  // An address and a data write per chunk, and per failed burst
+  EXPECT_EQ(this->imu_.upload_transactions_, 2 * (chunks + 2));
+}
+
+TEST_F(RecoveryTest, BurstLimitBelowMinimumChunkFailsSetup) {
+  this->bus_.set_max_write_len(16);
+  this->loop_.setup();
+  ASSERT_TRUE(this->loop_.run_until([this]() { return this->imu_.diagnostics_.failed_step != nullptr; }));
+  EXPECT_STREQ(this->imu_.diagnostics_.failed_step, "config upload");
+  EXPECT_EQ(this->imu_.upload_chunk_size_, 32);
+  EXPECT_FALSE(this->sim_.config_loaded());
+}
+
+}  // namespace bmi270
+}  // namespace esphome
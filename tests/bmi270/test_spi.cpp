@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include "bmi270_harness.h"
+#include "esphome/components/bmi270/bmi270_config.h"
+
+// BMI270SPIComponent: the switch out of I2C mode, the dummy byte and the
+// preference key
+
+namespace esphome {
+namespace bmi270 {
+
+class SpiTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    testing::set_now_us(0);
+    testing::clear_preferences();
+    this->imu_.set_spi_bus(&this->bus_);
+    this->imu_.set_preference_key(0x105);
+    this->imu_.set_update_interval(100);
+    this->imu_.set_accel_x_sensor(&this->accel_x_);
+    this->loop_.add(&this->imu_);
+    this->loop_.add_sim(&this->sim_);
+  }
+
+  void start() {
+    this->loop_.setup();
+    ASSERT_TRUE(this->loop_.run_until([this]() { return this->imu_.is_ready(); }));
+  }
+
+  BMI270Simulator sim_;
+  SimSPIBus bus_{&sim_};
+  sensor::Sensor accel_x_;
+  TestBMI270SPI imu_;
+  HostLoop loop_;
+};
+
+TEST_F(SpiTest, ThrowawayReadSwitchesToSpi) {
+  ASSERT_FALSE(this->sim_.is_spi_mode());
+  this->start();
+  EXPECT_TRUE(this->sim_.is_spi_mode());
+  // The throwaway read went out while the chip still spoke I2C, so the
+  // first transaction it saw is the real chip ID read
+  ASSERT_FALSE(this->sim_.get_log().empty());
+  EXPECT_FALSE(this->sim_.get_log().front().write);
+  EXPECT_EQ(this->sim_.get_log().front().reg, BMI2_CHIP_ID_ADDR);
+  EXPECT_EQ(this->imu_.sensor_.chip_id, BMI2_CHIP_ID);
+  EXPECT_TRUE(this->sim_.config_loaded());
+}
+
+TEST_F(SpiTest, ReadsSkipTheDummyByte) {
+  // Distinct bytes everywhere, so a one-byte shift shows in every axis
+  this->sim_.set_signal([](uint32_t, int16_t *acc, int16_t *gyr) {
+    acc[0] = 0x1234;
+    acc[1] = -0x0567;
+    acc[2] = 0x3A5C;
+    gyr[0] = 0x0102;
+    gyr[1] = -0x0304;
+    gyr[2] = 0x0506;
+  });
+  this->start();
+  uint8_t chip_id = 0;
+  ASSERT_EQ(bmi2_get_regs(BMI2_CHIP_ID_ADDR, &chip_id, 1, &this->imu_.sensor_), BMI2_OK);
+  EXPECT_EQ(chip_id, BMI2_CHIP_ID);
+
+  this->loop_.run_for(300);
+  ASSERT_TRUE(this->imu_.has_sample_);
+  // No accel offsets by default, so the counts arrive unchanged
+  EXPECT_EQ(this->imu_.last_sample_.acc[0], 0x1234);
+  EXPECT_EQ(this->imu_.last_sample_.acc[1], -0x0567);
+  EXPECT_EQ(this->imu_.last_sample_.acc[2], 0x3A5C);
+  EXPECT_GT(this->accel_x_.publishes, 0u);
+}
+
+TEST_F(SpiTest, ConfigUploadOverSpi) {
+  this->start();
+  EXPECT_EQ(this->sim_.get_config_bytes_written(), sizeof(bmi270_config_file));
+  EXPECT_EQ(this->sim_.get_reg(BMI2_INTERNAL_STATUS_ADDR) & 0x0F, BMI2_INIT_OK);
+  EXPECT_EQ(this->sim_.writes_to(BMI2_INIT_CTRL_ADDR), (std::vector<uint8_t>{0x00, 0x01}));
+}
+
+TEST_F(SpiTest, ResetChipReturnsToSpiOnRecovery) {
+  this->start();
+  // A brown-out puts the interface back into I2C mode; every SPI read
+  // floats high until the recovery's chip ID read toggles CS
+  this->sim_.brown_out();
+  ASSERT_FALSE(this->sim_.is_spi_mode());
+  ASSERT_TRUE(this->loop_.run_until([this]() { return this->imu_.recoveries_ != 0; }, 30000));
+  ASSERT_TRUE(this->loop_.run_until([this]() { return this->imu_.is_ready(); }, 60000));
+  EXPECT_TRUE(this->sim_.is_spi_mode());
+  EXPECT_TRUE(this->sim_.config_loaded());
+}
+
+TEST_F(SpiTest, PreferencesAreKeyedByCsPin) {
+  // Two chips with different gyro bias on CS pins 5 and 10
+  BMI270Simulator other;
+  SimSPIBus other_bus{&other};
+  TestBMI270SPI other_imu;
+  other_imu.set_spi_bus(&other_bus);
+  other_imu.set_preference_key(0x10A);
+  this->loop_.add(&other_imu);
+  this->loop_.add_sim(&other);
+  this->sim_.set_signal([](uint32_t, int16_t *acc, int16_t *gyr) {
+    acc[2] = 16384;
+    gyr[0] = 40;
+  });
+  other.set_signal([](uint32_t, int16_t *acc, int16_t *gyr) {
+    acc[2] = 16384;
+    gyr[0] = -25;
+  });
+  this->loop_.setup();
+  ASSERT_TRUE(this->loop_.run_until([&]() { return this->imu_.is_ready() && other_imu.is_ready(); }));
+  ASSERT_EQ(this->imu_.calibration_.offsets.gyr[0], -40);
+  ASSERT_EQ(other_imu.calibration_.offsets.gyr[0], 25);
+
+  // After a reboot the chip on pin 5 gets its own offsets back, no FOC
+  BMI270Simulator rebooted;
+  rebooted.set_signal([](uint32_t, int16_t *acc, int16_t *gyr) {
+    acc[2] = 16384;
+    gyr[0] = 7;
+  });
+  SimSPIBus rebooted_bus{&rebooted};
+  TestBMI270SPI imu;
+  imu.set_spi_bus(&rebooted_bus);
+  imu.set_preference_key(0x105);
+  HostLoop loop;
+  loop.add(&imu);
+  loop.add_sim(&rebooted);
+  loop.setup();
+  ASSERT_TRUE(loop.run_until([&]() { return imu.is_ready(); }));
+  EXPECT_EQ(imu.calibration_.offsets.gyr[0], -40);
+  EXPECT_EQ(rebooted.get_reg(BMI2_GYR_OFF_COMP_3_ADDR), (uint8_t) -40);
+}
+
+}  // namespace bmi270
+}  // namespace esphome
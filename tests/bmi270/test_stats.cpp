@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+
+#include <math.h>
+
+#include "bmi270_harness.h"
+
+// AxisStatistics against two-pass references, and the windowed outputs
+
+namespace esphome {
+namespace bmi270 {
+
+static const double PI = 3.14159265358979323846;
+static const float G = 9.80665f;
+
+// Deterministic noise in [-0.5, 0.5)
+static float noise(uint32_t *seed) {
+  *seed = *seed * 1664525u + 1013904223u;
+  return (float) (*seed >> 8) / (1 << 24) - 0.5f;
+}
+
+TEST(StatsTest, EmptyWindowIsNan) {
+  AxisStatistics stats;
+  stats.reset();
+  for (uint8_t stat = 0; stat < STATISTIC_COUNT; stat++)
+    EXPECT_TRUE(isnan(stats.get((WindowStatistic) stat))) << (int) stat;
+}
+
+TEST(StatsTest, MatchesTwoPassReference) {
+  // Gravity plus noise: the offset the single-pass variance must survive
+  const uint32_t n = 1600;
+  float x[n];
+  uint32_t seed = 7;
+  AxisStatistics stats;
+  stats.reset();
+  for (uint32_t i = 0; i < n; i++) {
+    x[i] = G + 0.2f * noise(&seed);
+    stats.add(x[i]);
+  }
+
+  double mean = 0.0, sum_sq = 0.0, lo = x[0], hi = x[0];
+  for (uint32_t i = 0; i < n; i++) {
+    mean += x[i];
+    sum_sq += (double) x[i] * x[i];
+    lo = fmin(lo, x[i]);
+    hi = fmax(hi, x[i]);
+  }
+  mean /= n;
+  double variance = 0.0;
+  for (uint32_t i = 0; i < n; i++)
+    variance += (x[i] - mean) * (x[i] - mean);
+  variance /= n;
+
+  EXPECT_EQ(stats.get_count(), n);
+  EXPECT_NEAR(stats.get(STATISTIC_MEAN), mean, 1e-5);
+  EXPECT_NEAR(stats.get(STATISTIC_VARIANCE), variance, 1e-3 * variance);
+  EXPECT_NEAR(stats.get(STATISTIC_RMS), sqrt(sum_sq / n), 1e-5);
+  EXPECT_EQ(stats.get(STATISTIC_MIN), (float) lo);
+  EXPECT_EQ(stats.get(STATISTIC_MAX), (float) hi);
+  EXPECT_NEAR(stats.get(STATISTIC_PEAK_TO_PEAK), hi - lo, 1e-6);
+  EXPECT_NEAR(stats.get(STATISTIC_CREST_FACTOR), hi / sqrt(sum_sq / n), 1e-5);
+}
+
+TEST(StatsTest, SineOverWholePeriods) {
+  AxisStatistics stats;
+  stats.reset();
+  for (uint32_t i = 0; i < 1000; i++)
+    stats.add(2.0f * (float) sin(2.0 * PI * i / 100.0 + 0.3));
+  EXPECT_NEAR(stats.get(STATISTIC_MEAN), 0.0f, 1e-5f);
+  EXPECT_NEAR(stats.get(STATISTIC_RMS), sqrtf(2.0f), 1e-4f);
+  EXPECT_NEAR(stats.get(STATISTIC_VARIANCE), 2.0f, 1e-3f);
+  EXPECT_NEAR(stats.get(STATISTIC_PEAK_TO_PEAK), 4.0f, 2e-3f);
+  EXPECT_NEAR(stats.get(STATISTIC_CREST_FACTOR), sqrtf(2.0f), 2e-3f);
+}
+
+TEST(StatsTest, CrestFactorOfSilenceIsNan) {
+  AxisStatistics stats;
+  stats.reset();
+  for (int i = 0; i < 10; i++)
+    stats.add(0.0f);
+  EXPECT_EQ(stats.get(STATISTIC_RMS), 0.0f);
+  EXPECT_TRUE(isnan(stats.get(STATISTIC_CREST_FACTOR)));
+}
+
+TEST(StatsTest, FreshAccumulatorNeedsNoReset) {
+  // A window of positive values must not report the zero it started from
+  AxisStatistics stats;
+  stats.add(3.0f);
+  stats.add(5.0f);
+  EXPECT_EQ(stats.get(STATISTIC_MIN), 3.0f);
+  EXPECT_EQ(stats.get(STATISTIC_MAX), 5.0f);
+  EXPECT_EQ(stats.get(STATISTIC_PEAK_TO_PEAK), 2.0f);
+
+  AxisStatistics negative;
+  negative.add(-4.0f);
+  EXPECT_EQ(negative.get(STATISTIC_MAX), -4.0f);
+}
+
+TEST(StatsTest, ResetStartsANewWindow) {
+  AxisStatistics stats;
+  stats.reset();
+  stats.add(100.0f);
+  stats.add(-100.0f);
+  stats.reset();
+  stats.add(1.0f);
+  EXPECT_EQ(stats.get_count(), 1u);
+  EXPECT_EQ(stats.get(STATISTIC_MEAN), 1.0f);
+  EXPECT_EQ(stats.get(STATISTIC_PEAK_TO_PEAK), 0.0f);
+  EXPECT_EQ(stats.get(STATISTIC_VARIANCE), 0.0f);
+}
+
+class StatsComponentTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    testing::set_now_us(0);
+    testing::clear_preferences();
+    this->bus_.add_device(0x68, &this->sim_);
+    this->imu_.set_i2c_bus(&this->bus_);
+    this->imu_.set_i2c_address(0x68);
+    this->imu_.set_accel_odr(BMI2_ACC_ODR_100HZ);
+    this->imu_.set_gyro_odr(BMI2_GYR_ODR_100HZ);
+    this->imu_.set_fifo_mode(FIFO_MODE_HEADER);
+    this->imu_.set_fifo_watermark(10);
+    this->imu_.set_update_interval(100);
+    this->loop_.add(&this->imu_);
+    this->loop_.add_sim(&this->sim_);
+  }
+
+  BMI270Simulator sim_;
+  SimI2CBus bus_;
+  sensor::Sensor x_mean_, x_rms_, x_p2p_, z_mean_;
+  TestBMI270 imu_;
+  HostLoop loop_;
+};
+
+TEST_F(StatsComponentTest, PublishesOncePerWindowOfFifoSamples) {
+  // A square wave of ±0.25 g on x, one sample each, on top of flat gravity
+  this->sim_.set_signal([](uint32_t sensortime, int16_t *acc, int16_t *) {
+    acc[0] = (sensortime / 256) & 1 ? 4096 : -4096;
+    acc[2] = 16384;
+  });
+  this->imu_.set_statistics_window(500);
+  this->imu_.set_statistics_sensor(0, STATISTIC_MEAN, &this->x_mean_);
+  this->imu_.set_statistics_sensor(0, STATISTIC_RMS, &this->x_rms_);
+  this->imu_.set_statistics_sensor(0, STATISTIC_PEAK_TO_PEAK, &this->x_p2p_);
+  this->imu_.set_statistics_sensor(2, STATISTIC_MEAN, &this->z_mean_);
+  this->loop_.setup();
+  ASSERT_TRUE(this->loop_.run_until([this]() { return this->imu_.is_ready(); }));
+
+  this->loop_.run_for(5050);
+  // 50 samples a window at 100 Hz
+  EXPECT_NEAR(this->x_mean_.publishes, 10u, 1u);
+  EXPECT_EQ(this->z_mean_.publishes, this->x_mean_.publishes);
+  EXPECT_NEAR(this->x_mean_.state, 0.0f, 1e-4f);
+  EXPECT_NEAR(this->x_rms_.state, 0.25f * G, 1e-4f);
+  EXPECT_NEAR(this->x_p2p_.state, 0.5f * G, 1e-4f);
+  EXPECT_NEAR(this->z_mean_.state, G, 1e-3f);
+}
+
+}  // namespace bmi270
+}  // namespace esphome
@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+
+#include "bmi270_harness.h"
+
+// sync_with groups: one read schedule for leader and follower, staggered
+// uploads and the reported sample skew
+
+namespace esphome {
+namespace bmi270 {
+
+// Keeps the order of transactions across both chips
+class OrderedBus : public SimI2CBus {
+ public:
+  struct Access {
+    uint8_t address;
+    bool write;
+    uint8_t reg;
+  };
+
+  i2c::ErrorCode read_register(uint8_t address, uint8_t a_register, uint8_t *data, size_t len) override {
+    this->accesses.push_back({address, false, a_register});
+    return SimI2CBus::read_register(address, a_register, data, len);
+  }
+  i2c::ErrorCode write_register(uint8_t address, uint8_t a_register, const uint8_t *data, size_t len) override {
+    this->accesses.push_back({address, true, a_register});
+    return SimI2CBus::write_register(address, a_register, data, len);
+  }
+
+  std::vector<Access> accesses;
+};
+
+class SyncTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    testing::set_now_us(0);
+    testing::clear_preferences();
+    this->bus_.add_device(0x68, &this->leader_sim_);
+    this->bus_.add_device(0x69, &this->follower_sim_);
+    this->leader_.set_i2c_bus(&this->bus_);
+    this->leader_.set_i2c_address(0x68);
+    this->follower_.set_i2c_bus(&this->bus_);
+    this->follower_.set_i2c_address(0x69);
+    for (TestBMI270 *imu : {&this->leader_, &this->follower_}) {
+      imu->set_update_interval(100);
+      imu->set_accel_odr(BMI2_ACC_ODR_100HZ);
+      imu->set_gyro_odr(BMI2_GYR_ODR_100HZ);
+    }
+    this->leader_.set_accel_x_sensor(&this->leader_x_);
+    this->follower_.set_accel_x_sensor(&this->follower_x_);
+    this->follower_.set_sync_skew_sensor(&this->skew_);
+    this->follower_.set_sync_leader(&this->leader_);
+    this->loop_.add(&this->leader_);
+    this->loop_.add(&this->follower_);
+    this->loop_.add_sim(&this->leader_sim_);
+    this->loop_.add_sim(&this->follower_sim_);
+  }
+
+  void start() {
+    this->loop_.setup();
+    ASSERT_TRUE(
+        this->loop_.run_until([this]() { return this->leader_.is_ready() && this->follower_.is_ready(); }, 20000));
+  }
+
+  // Indexes of the accesses matching address, direction and register
+  std::vector<size_t> find(uint8_t address, bool write, uint8_t reg) const {
+    std::vector<size_t> found;
+    for (size_t i = 0; i < this->bus_.accesses.size(); i++) {
+      const auto &access = this->bus_.accesses[i];
+      if (access.address == address && access.write == write && access.reg == reg)
+        found.push_back(i);
+    }
+    return found;
+  }
+
+  BMI270Simulator leader_sim_, follower_sim_;
+  OrderedBus bus_;
+  sensor::Sensor leader_x_, follower_x_, skew_;
+  TestBMI270 leader_, follower_;
+  HostLoop loop_;
+};
+
+TEST_F(SyncTest, FollowerWaitsForLeaderUpload) {
+  this->start();
+  std::vector<size_t> leader_data = this->find(0x68, true, BMI2_INIT_DATA_ADDR);
+  std::vector<size_t> follower_data = this->find(0x69, true, BMI2_INIT_DATA_ADDR);
+  ASSERT_FALSE(leader_data.empty());
+  ASSERT_FALSE(follower_data.empty());
+  // No interleaved bursts: the follower starts after the leader's last chunk
+  EXPECT_LT(leader_data.back(), follower_data.front());
+  EXPECT_TRUE(this->leader_sim_.config_loaded());
+  EXPECT_TRUE(this->follower_sim_.config_loaded());
+}
+
+TEST_F(SyncTest, FollowerIsReadRightAfterLeader) {
+  this->start();
+  this->bus_.accesses.clear();
+  const uint32_t leader_start = this->leader_x_.publishes;
+  const uint32_t follower_start = this->follower_x_.publishes;
+  this->loop_.run_for(2000);
+
+  std::vector<size_t> leader_reads = this->find(0x68, false, BMI2_STATUS_ADDR);
+  std::vector<size_t> follower_reads = this->find(0x69, false, BMI2_STATUS_ADDR);
+  // One round per leader poll; the follower's own update timer reads nothing
+  ASSERT_GE(leader_reads.size(), 19u);
+  EXPECT_EQ(follower_reads.size(), leader_reads.size());
+  for (size_t i = 0; i < leader_reads.size() && i < follower_reads.size(); i++)
+    EXPECT_EQ(follower_reads[i], leader_reads[i] + 1) << "round " << i;
+  // Both publish once per round
+  EXPECT_GE(this->follower_x_.publishes - follower_start, 19u);
+  EXPECT_EQ(this->follower_x_.publishes - follower_start, this->leader_x_.publishes - leader_start);
+}
+
+TEST_F(SyncTest, FifoFollowerIsDrainedWithLeader) {
+  for (TestBMI270 *imu : {&this->leader_, &this->follower_}) {
+    imu->set_fifo_mode(FIFO_MODE_HEADER);
+    imu->set_fifo_watermark(10);
+  }
+  this->start();
+  this->bus_.accesses.clear();
+  this->loop_.run_for(2000);
+
+  std::vector<size_t> leader_reads = this->find(0x68, false, BMI2_FIFO_DATA_ADDR);
+  std::vector<size_t> follower_reads = this->find(0x69, false, BMI2_FIFO_DATA_ADDR);
+  ASSERT_GE(leader_reads.size(), 19u);
+  EXPECT_EQ(follower_reads.size(), leader_reads.size());
+  // Between the two data reads only the follower's FIFO length read
+  for (size_t i = 0; i < leader_reads.size() && i < follower_reads.size(); i++)
+    EXPECT_EQ(follower_reads[i], leader_reads[i] + 2) << "round " << i;
+  EXPECT_EQ(this->follower_sim_.get_fifo_overflows(), 0u);
+}
+
+TEST_F(SyncTest, SkewFollowsOscillatorPhase) {
+  // Follower samples 2.5 ms early, 7.5 ms early (2.5 ms late of the
+  // previous leader sample), and in phase
+  const struct {
+    uint32_t clock_offset_us;
+    int32_t skew_us;
+  } cases[] = {{2500, -2500}, {7500, 2500}, {0, 0}};
+  for (const auto &c : cases) {
+    testing::set_now_us(0);
+    testing::clear_preferences();
+    BMI270Simulator leader_sim, follower_sim;
+    follower_sim.set_clock_offset_us(c.clock_offset_us);
+    SimI2CBus bus;
+    bus.add_device(0x68, &leader_sim);
+    bus.add_device(0x69, &follower_sim);
+    TestBMI270 leader, follower;
+    sensor::Sensor skew;
+    leader.set_i2c_bus(&bus);
+    leader.set_i2c_address(0x68);
+    follower.set_i2c_bus(&bus);
+    follower.set_i2c_address(0x69);
+    for (TestBMI270 *imu : {&leader, &follower}) {
+      imu->set_update_interval(100);
+      imu->set_accel_odr(BMI2_ACC_ODR_100HZ);
+    }
+    follower.set_sync_skew_sensor(&skew);
+    follower.set_sync_leader(&leader);
+    HostLoop loop;
+    loop.add(&leader);
+    loop.add(&follower);
+    loop.add_sim(&leader_sim);
+    loop.add_sim(&follower_sim);
+    loop.setup();
+    ASSERT_TRUE(loop.run_until([&]() { return leader.is_ready() && follower.is_ready(); }, 20000));
+
+    // Published once the leader's clock mapping has locked
+    loop.run_for(5000);
+    ASSERT_GT(skew.publishes, 0u) << c.clock_offset_us;
+    EXPECT_NEAR(follower.sync_skew_us_, c.skew_us, 50) << c.clock_offset_us;
+    EXPECT_NEAR(skew.state, c.skew_us, 50) << c.clock_offset_us;
+    EXPECT_LE(follower.sync_max_skew_us_, 5000u) << c.clock_offset_us;
+  }
+}
+
+}  // namespace bmi270
+}  // namespace esphome
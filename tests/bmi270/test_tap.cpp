@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+
+#include "bmi270_harness.h"
+
+// TapDetector over integer accel streams: shock length, quiet period,
+// settling after motion and the double-tap window
+
+namespace esphome {
+namespace bmi270 {
+
+static const int16_t REST_Z = 4096;
+static const int16_t SPIKE = 3000;
+
+class TapTest : public ::testing::Test {
+ protected:
+  struct Event {
+    uint32_t sample;
+    TapEvent event;
+    bool operator==(const Event &other) const { return this->sample == other.sample && this->event == other.event; }
+  };
+
+  void SetUp() override { this->configure(0); }
+
+  // 1000 LSB threshold, shocks up to 5 samples, 5 quiet samples
+  void configure(uint16_t double_tap_window) { this->tap_.configure(1000, 5, 5, double_tap_window); }
+
+  void feed(uint32_t samples, int16_t z, int16_t x = 0) {
+    const int16_t acc[3] = {x, 0, z};
+    for (uint32_t i = 0; i < samples; i++) {
+      TapEvent event = this->tap_.update(acc);
+      if (event != TAP_EVENT_NONE)
+        this->events_.push_back({this->sample_, event});
+      this->sample_++;
+    }
+  }
+  void rest(uint32_t samples) { this->feed(samples, REST_Z); }
+  void spike(uint32_t samples) { this->feed(samples, REST_Z + SPIKE); }
+
+  TapDetector tap_;
+  uint32_t sample_{0};
+  std::vector<Event> events_;
+};
+
+TEST_F(TapTest, SingleTapWithoutWindowIsImmediate) {
+  this->rest(20);
+  this->spike(3);
+  this->rest(40);
+  // Reported on the first sample back below the threshold
+  EXPECT_EQ(this->events_, (std::vector<Event>{{23, TAP_EVENT_SINGLE}}));
+  EXPECT_EQ(this->tap_.get_taps(), 1u);
+  EXPECT_EQ(this->tap_.get_rejected(), 0u);
+}
+
+TEST_F(TapTest, RingingInTheQuietPeriodIsIgnored) {
+  this->rest(20);
+  this->spike(3);
+  this->rest(1);
+  this->spike(2);
+  this->rest(10);
+  EXPECT_EQ(this->events_.size(), 1u);
+  // After the quiet period the next spike is a tap again
+  this->spike(2);
+  this->rest(5);
+  EXPECT_EQ(this->events_.size(), 2u);
+  EXPECT_EQ(this->tap_.get_taps(), 2u);
+}
+
+TEST_F(TapTest, SpikeBelowThresholdIsNoTap) {
+  this->rest(20);
+  this->feed(3, REST_Z + 900);
+  this->rest(20);
+  EXPECT_TRUE(this->events_.empty());
+}
+
+TEST_F(TapTest, SingleTapWaitsForTheWindow) {
+  this->configure(30);
+  this->rest(20);
+  this->spike(3);
+  this->rest(60);
+  // 30 samples after the tap began, without a second one
+  EXPECT_EQ(this->events_, (std::vector<Event>{{51, TAP_EVENT_SINGLE}}));
+}
+
+TEST_F(TapTest, DoubleTapInsideTheWindow) {
+  this->configure(30);
+  this->rest(20);
+  this->spike(3);
+  this->rest(12);
+  this->spike(3);
+  this->rest(60);
+  EXPECT_EQ(this->events_, (std::vector<Event>{{38, TAP_EVENT_DOUBLE}}));
+  EXPECT_EQ(this->tap_.get_taps(), 2u);
+}
+
+TEST_F(TapTest, SecondTapOutsideTheWindowIsAnotherSingle) {
+  this->configure(30);
+  this->rest(20);
+  this->spike(3);
+  this->rest(37);
+  this->spike(3);
+  this->rest(60);
+  EXPECT_EQ(this->events_, (std::vector<Event>{{51, TAP_EVENT_SINGLE}, {91, TAP_EVENT_SINGLE}}));
+}
+
+TEST_F(TapTest, LongShakeIsRejected) {
+  this->rest(20);
+  this->spike(12);
+  this->rest(40);
+  EXPECT_TRUE(this->events_.empty());
+  EXPECT_EQ(this->tap_.get_taps(), 0u);
+  EXPECT_EQ(this->tap_.get_rejected(), 1u);
+}
+
+TEST_F(TapTest, ShakeCancelsAPendingTap) {
+  // A first tap, then the device is picked up inside the window: neither
+  // a single nor a double tap
+  this->configure(30);
+  this->rest(20);
+  this->spike(3);
+  this->rest(10);
+  this->spike(12);
+  this->rest(60);
+  EXPECT_TRUE(this->events_.empty());
+  EXPECT_EQ(this->tap_.get_taps(), 1u);
+  EXPECT_EQ(this->tap_.get_rejected(), 1u);
+}
+
+TEST_F(TapTest, SettlesBeforeArmingAgain) {
+  this->rest(20);
+  this->spike(12);
+  // Back below for fewer than the quiet samples: still settling
+  this->rest(3);
+  this->spike(2);
+  this->rest(3);
+  EXPECT_TRUE(this->events_.empty());
+  this->rest(10);
+  this->spike(2);
+  this->rest(5);
+  EXPECT_EQ(this->events_.size(), 1u);
+}
+
+TEST_F(TapTest, BaselineFollowsANewOrientation) {
+  // Turned on its side: the step is motion, then gravity is tracked on x
+  this->rest(20);
+  this->feed(100, 0, REST_Z);
+  EXPECT_TRUE(this->events_.empty());
+  EXPECT_EQ(this->tap_.get_rejected(), 1u);
+  this->feed(3, 0, REST_Z + SPIKE);
+  this->feed(10, 0, REST_Z);
+  EXPECT_EQ(this->events_.size(), 1u);
+}
+
+}  // namespace bmi270
+}  // namespace esphome
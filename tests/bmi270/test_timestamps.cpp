@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include "bmi270_harness.h"
+
+// Per-sample timestamps against the simulated chip's sampling instants
+
+namespace esphome {
+namespace bmi270 {
+
+// The chip's oscillator runs 3 ms ahead of the host clock, so at 100 Hz it
+// samples at 7 ms past every 10 ms of local time
+static const uint32_t CLOCK_OFFSET_US = 3000;
+static const uint32_t PERIOD_US = 10000;
+
+class TimestampTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    testing::set_now_us(0);
+    testing::clear_preferences();
+    this->sim_.set_clock_offset_us(CLOCK_OFFSET_US);
+    this->bus_.add_device(0x68, &this->sim_);
+    this->imu_.set_i2c_bus(&this->bus_);
+    this->imu_.set_i2c_address(0x68);
+    this->imu_.set_update_interval(100);
+    this->imu_.set_accel_odr(BMI2_ACC_ODR_100HZ);
+    this->imu_.set_accel_x_sensor(&this->accel_x_);
+    this->loop_.add(&this->imu_);
+    this->loop_.add_sim(&this->sim_);
+  }
+
+  void start() {
+    this->loop_.setup();
+    ASSERT_TRUE(this->loop_.run_until([this]() { return this->imu_.is_ready(); }));
+    ASSERT_TRUE(this->loop_.run_until([this]() { return this->imu_.has_sample_; }));
+  }
+
+  // Distance of a local time from the nearest sampling instant
+  static int32_t phase_error_us(uint32_t timestamp_us) {
+    return sample_phase_offset_us(0, timestamp_us + CLOCK_OFFSET_US, PERIOD_US);
+  }
+
+  BMI270Simulator sim_;
+  SimI2CBus bus_;
+  sensor::Sensor accel_x_;
+  TestBMI270 imu_;
+  HostLoop loop_;
+};
+
+TEST_F(TimestampTest, PolledSampleDatesFromItsSamplingInstant) {
+  this->start();
+  // The polls land on whole milliseconds, 3 ms or more after the sample
+  for (int i = 0; i < 20; i++) {
+    this->loop_.run_for(100);
+    ASSERT_TRUE(this->imu_.has_sample_);
+    EXPECT_NEAR(phase_error_us(this->imu_.last_sample_.timestamp_us), 0, 40) << "poll " << i;
+    EXPECT_EQ(this->imu_.last_sample_.sensortime % 256, 0u);
+    EXPECT_LE(this->imu_.last_sample_.timestamp_us, micros());
+    EXPECT_GT(this->imu_.last_sample_.timestamp_us + PERIOD_US, micros() - 1000);
+  }
+}
+
+TEST_F(TimestampTest, FifoBatchDatesFromTheSampleGrid) {
+  this->imu_.set_fifo_mode(FIFO_MODE_HEADER);
+  this->imu_.set_fifo_watermark(10);
+  this->start();
+  for (int i = 0; i < 20; i++) {
+    this->loop_.run_for(100);
+    ASSERT_TRUE(this->imu_.has_sample_);
+    EXPECT_NEAR(phase_error_us(this->imu_.last_sample_.timestamp_us), 0, 40) << "batch " << i;
+    EXPECT_EQ(this->imu_.last_sample_.sensortime % 256, 0u);
+  }
+}
+
+}  // namespace bmi270
+}  // namespace esphome
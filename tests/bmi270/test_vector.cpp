@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+
+#include <sstream>
+
+#include "bmi270_harness.h"
+
+// Packed vector records on the text sensor
+
+namespace esphome {
+namespace bmi270 {
+
+class VectorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    testing::set_now_us(0);
+    testing::clear_preferences();
+    this->bus_.add_device(0x68, &this->sim_);
+    this->imu_.set_i2c_bus(&this->bus_);
+    this->imu_.set_i2c_address(0x68);
+    this->imu_.set_vector_text_sensor(&this->vector_);
+    this->loop_.add(&this->imu_);
+    this->loop_.add_sim(&this->sim_);
+  }
+
+  void start() {
+    this->loop_.setup();
+    ASSERT_TRUE(this->loop_.run_until([this]() { return this->imu_.is_ready(); }));
+    this->vector_.history.clear();
+  }
+
+  static std::vector<std::string> split(const std::string &text, char separator) {
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, separator))
+      parts.push_back(part);
+    return parts;
+  }
+
+  BMI270Simulator sim_;
+  SimI2CBus bus_;
+  text_sensor::TextSensor vector_;
+  TestBMI270 imu_;
+  HostLoop loop_;
+};
+
+TEST_F(VectorTest, Base64PublishesEveryFifoSample) {
+  this->imu_.set_fifo_mode(FIFO_MODE_HEADER);
+  this->imu_.set_vector_encoding(VECTOR_ENCODING_BASE64);
+  this->start();
+  const uint32_t first = this->sim_.get_samples();
+  this->loop_.run_for(3000);
+
+  // About 100 samples per 1 s poll, so several publishes per poll
+  EXPECT_GT(this->vector_.history.size(), 15u);
+  std::vector<uint32_t> times;
+  for (const auto &state : this->vector_.history) {
+    EXPECT_LE(state.size(), 255u);
+    std::vector<uint8_t> raw = base64_decode(state);
+    ASSERT_EQ(raw.size() % 15, 0u);
+    for (size_t i = 0; i < raw.size(); i += 15) {
+      times.push_back(raw[i] | raw[i + 1] << 8 | raw[i + 2] << 16);
+      int16_t acc_z = (int16_t) (raw[i + 7] | raw[i + 8] << 8);
+      EXPECT_EQ(acc_z, 16384 >> (this->sim_.get_reg(BMI2_ACC_RANGE_ADDR) & 0x03));
+    }
+  }
+  // No sample is dropped between records, publishes or polls
+  ASSERT_GE(times.size(), (size_t) (this->sim_.get_samples() - first - 100));
+  for (size_t i = 1; i < times.size(); i++)
+    ASSERT_EQ((times[i] - times[i - 1]) & 0xFFFFFF, 256u) << "record " << i;
+}
+
+TEST_F(VectorTest, CsvRecordsAreSplitAtStateLength) {
+  this->imu_.set_fifo_mode(FIFO_MODE_HEADER);
+  this->start();
+  this->loop_.run_for(2000);
+  size_t records = 0;
+  for (const auto &state : this->vector_.history) {
+    EXPECT_LE(state.size(), 255u);
+    for (const auto &record : split(state, ';')) {
+      std::vector<std::string> fields = split(record, ',');
+      ASSERT_EQ(fields.size(), 7u) << record;
+      EXPECT_NEAR(strtof(fields[3].c_str(), nullptr), 9.81f, 0.01f);
+      records++;
+    }
+  }
+  EXPECT_GT(records, 90u);
+}
+
+TEST_F(VectorTest, PolledModePublishesOneRecordPerPoll) {
+  this->imu_.set_vector_fields(VECTOR_FIELDS_ACCEL);
+  this->start();
+  this->loop_.run_for(3000);
+  ASSERT_EQ(this->vector_.history.size(), 3u);
+  EXPECT_EQ(split(this->vector_.history[0], ',').size(), 4u);
+}
+
+TEST_F(VectorTest, BiasCorrectedGyroSaturates) {
+  this->imu_.set_vector_fields(VECTOR_FIELDS_GYRO);
+  this->imu_.set_vector_encoding(VECTOR_ENCODING_BASE64);
+  this->sim_.set_signal([](uint32_t, int16_t *acc, int16_t *gyr) {
+    acc[2] = 16384;
+    gyr[0] = INT16_MIN;
+    gyr[1] = INT16_MAX;
+    gyr[2] = 1000;
+  });
+  this->start();
+  this->imu_.gyro_bias_x_ = 100;
+  this->imu_.gyro_bias_y_ = -100;
+  this->loop_.run_for(1000);
+  ASSERT_FALSE(this->vector_.history.empty());
+  std::vector<uint8_t> raw = base64_decode(this->vector_.history.back());
+  ASSERT_EQ(raw.size(), 9u);
+  EXPECT_EQ((int16_t) (raw[3] | raw[4] << 8), INT16_MIN);
+  EXPECT_EQ((int16_t) (raw[5] | raw[6] << 8), INT16_MAX);
+  // FOC took the constant rate out in hardware; the sim output is not compensated
+  EXPECT_EQ((int16_t) (raw[7] | raw[8] << 8), 1000);
+}
+
+}  // namespace bmi270
+}  // namespace esphome